@@ -0,0 +1,111 @@
+#include "Aerodynamics.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+const int LATTICE = 8;  // Coarse random lattice per tile for the first octave
+
+// Deterministic hash so a layer depends only on its period index
+float HashToUnit(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return (x & 0xFFFFFF) / (float)0x800000 - 1.0f;  // [-1, 1)
+}
+
+float Smooth(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+} // namespace
+
+TurbulenceField::TurbulenceField()
+    : layerA(GRID * GRID * 2), layerB(GRID * GRID * 2), current(GRID * GRID * 2, 0.0f),
+      layerIndex(-1), refreshIndex(-1) {}
+
+void TurbulenceField::Generate(std::vector<float>& layer, long long index) {
+    uint32_t seed = (uint32_t)(index * 0x9E3779B1LL);
+    for (int i = 0; i < GRID * GRID * 2; i++) layer[i] = 0.0f;
+
+    // Two octaves of periodic value noise; lattice indices wrap so the tile repeats seamlessly
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int octave = 0; octave < 2; octave++) {
+        int lattice = LATTICE << octave;
+        int cell = GRID / lattice;
+        uint32_t octaveSeed = seed + 0x68E31DA4U * (octave + 1);
+        for (int y = 0; y < GRID; y++) {
+            int ly = y / cell;
+            float ty = Smooth((y % cell) / (float)cell);
+            for (int x = 0; x < GRID; x++) {
+                int lx = x / cell;
+                float tx = Smooth((x % cell) / (float)cell);
+                for (int c = 0; c < 2; c++) {
+                    auto corner = [&](int cx, int cy) {
+                        uint32_t key = (uint32_t)(((cy % lattice) * lattice + (cx % lattice)) * 2 + c);
+                        return HashToUnit(key * 0x27D4EB2DU + octaveSeed);
+                    };
+                    float top = corner(lx, ly) + (corner(lx + 1, ly) - corner(lx, ly)) * tx;
+                    float bottom = corner(lx, ly + 1) + (corner(lx + 1, ly + 1) - corner(lx, ly + 1)) * tx;
+                    layer[(y * GRID + x) * 2 + c] += amplitude * (top + (bottom - top) * ty);
+                }
+            }
+        }
+        total += amplitude;
+        amplitude *= 0.5f;
+    }
+    for (int i = 0; i < GRID * GRID * 2; i++) layer[i] /= total;
+}
+
+void TurbulenceField::Update(float time, float period) {
+    if (period <= 0.0f) period = 1.0f;
+    double phase = time / period;
+    long long index = (long long)std::floor(phase);
+    int refresh = (int)((phase - index) * REFRESHES);
+
+    if (index != layerIndex) {
+        // Usually one period ahead, so the newer layer can be kept
+        if (index == layerIndex + 1) {
+            layerA.swap(layerB);
+        } else {
+            Generate(layerA, index);
+        }
+        Generate(layerB, index + 1);
+        layerIndex = index;
+        refreshIndex = -1;
+    }
+    if (refresh == refreshIndex) return;
+
+    float weight = Smooth(refresh / (float)REFRESHES);
+    for (int i = 0; i < GRID * GRID * 2; i++) {
+        current[i] = layerA[i] + (layerB[i] - layerA[i]) * weight;
+    }
+    refreshIndex = refresh;
+}
+
+void TurbulenceField::Sample(float u, float v, float& outX, float& outY) const {
+    float gx = (u - std::floor(u)) * GRID;
+    float gy = (v - std::floor(v)) * GRID;
+    int x0 = (int)gx;
+    int y0 = (int)gy;
+    float fx = gx - x0;
+    float fy = gy - y0;
+    x0 &= GRID - 1;
+    y0 &= GRID - 1;
+    int x1 = (x0 + 1) & (GRID - 1);
+    int y1 = (y0 + 1) & (GRID - 1);
+
+    const float* a = &current[(y0 * GRID + x0) * 2];
+    const float* b = &current[(y0 * GRID + x1) * 2];
+    const float* c = &current[(y1 * GRID + x0) * 2];
+    const float* d = &current[(y1 * GRID + x1) * 2];
+    float topX = a[0] + (b[0] - a[0]) * fx;
+    float topY = a[1] + (b[1] - a[1]) * fx;
+    float bottomX = c[0] + (d[0] - c[0]) * fx;
+    float bottomY = c[1] + (d[1] - c[1]) * fx;
+    outX = topX + (bottomX - topX) * fy;
+    outY = topY + (bottomY - topY) * fy;
+}
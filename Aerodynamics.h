@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+
+// Air acting on the cloth faces. The cloth lives in the screen plane, so each
+// triangle is treated as a flat plate whose chord is its longest edge and
+// whose normal is the in-plane perpendicular of that chord. Flow hitting the
+// plate pushes along the normal; that push is split into drag (along the
+// flow) and lift (across it), and skin friction drags the face along the
+// flow even when it runs edge-on.
+struct AeroSettings {
+    bool enabled = false;
+    float windX = 0.0f, windY = 0.0f;  // Mean wind velocity, pixels per second
+    float density = 2e-5f;             // Air density with the 1/2 of the drag equation folded in
+    float dragCoefficient = 1.0f;
+    float liftCoefficient = 0.6f;
+    float frictionCoefficient = 0.05f;
+    float turbulence = 0.0f;           // Gust velocity amplitude, pixels per second
+    float turbulenceScale = 256.0f;    // Pixels covered by one tile of the noise field
+    float turbulencePeriod = 4.0f;     // Seconds for the field to evolve into a fresh pattern
+};
+
+// Tileable 2D vector noise on a fixed grid. Two noise layers are kept and
+// blended over time; the blended grid is only rebuilt when the blend weight
+// has moved by a noticeable amount, and a new layer is generated once per
+// period. Layers are seeded by their period index, so stepping back in time
+// after a rollback reproduces the same field.
+class TurbulenceField {
+public:
+    static const int GRID = 64;      // Samples per side of the tile
+    static const int REFRESHES = 32; // Rebuilds of the blended grid per period
+
+    TurbulenceField();
+
+    void Update(float time, float period);
+    // u, v in tiles (wrapping); returns a vector with components in about [-1, 1]
+    void Sample(float u, float v, float& outX, float& outY) const;
+
+private:
+    std::vector<float> layerA, layerB;  // x,y pairs, GRID * GRID
+    std::vector<float> current;         // Blend of the two, sampled by the faces
+    long long layerIndex;               // Period index of layerA, -1 before the first update
+    int refreshIndex;                   // Blend step current was built for
+
+    static void Generate(std::vector<float>& layer, long long index);
+};
@@ -1,14 +1,16 @@
 #include "Cloth.h"
+#include "SoftRenderer.h"
 #include <cmath>
+#include <algorithm>
 
 Cloth::Cloth(int width, int height, float spacing)
-    : width(width), height(height), spacing(spacing), draggedPoint(-1), gravityForce(500.0f), springStiffness(8000.0f), springDamping(2.0f), showWires(true) {
+    : width(width), height(height), isMesh(false), spacing(spacing), originX(100.0f), originY(100.0f), draggedPoint(-1), gravityForce(ClothKernels::DEFAULT_GRAVITY), springStiffness(ClothKernels::DEFAULT_STIFFNESS), springDamping(ClothKernels::DEFAULT_DAMPING), showWires(true), minSubsteps(1), selfCollisionInterval(1), scheduler(&TaskScheduler::Default()), deterministic(false), projective(false), projectiveIterations(10), pdFactored(false), pdStep(0.0f), pdTopologyVersion(0), factorizationCount(0), compact(false), renderDetail(1) {
     // Initialize point masses
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             PointMass pm;
-            pm.x = x * spacing + 100.0f; // Offset to make it visible
-            pm.y = y * spacing + 100.0f;
+            pm.x = x * spacing + originX; // Offset to make it visible
+            pm.y = y * spacing + originY;
             pm.vx = 0;
             pm.vy = 0;
             pm.fx = 0;
@@ -22,10 +24,109 @@ Cloth::Cloth(int width, int height, float spacing)
 
     InitializeSprings();
     InitializeFaces();
+    InitializeTearing();
+    InitializeMaterials();
+    InitializeStability();
+    InitializeDetail();
+}
+
+Cloth::Cloth(const TriangleMesh& mesh, float scale)
+    : width(0), height(1), isMesh(true), spacing(0), originX(100.0f), originY(100.0f), draggedPoint(-1), gravityForce(ClothKernels::DEFAULT_GRAVITY), springStiffness(ClothKernels::DEFAULT_STIFFNESS), springDamping(ClothKernels::DEFAULT_DAMPING), showWires(true), minSubsteps(1), selfCollisionInterval(1), scheduler(&TaskScheduler::Default()), deterministic(false), projective(false), projectiveIterations(10), pdFactored(false), pdStep(0.0f), pdTopologyVersion(0), factorizationCount(0), compact(false), renderDetail(1) {
+    // Renumber for locality so the spring, breaking and tearing passes walk memory
+    // in order and the scene's contact tiles of consecutive points stay compact.
+    // Self-collision tests all pairs, so it gains nothing from the order.
+    TriangleMesh ordered = mesh;
+    meshToPoint = ReorderForLocality(ordered);
+
+    // Mesh cloths are addressed as a single row, so FixPoint(i, 0) pins point i
+    width = (int)ordered.x.size();
+
+    for (int i = 0; i < width; i++) {
+        PointMass pm;
+        pm.x = ordered.x[i] * scale + originX; // Same offset as the grid cloth
+        pm.y = ordered.y[i] * scale + originY;
+        pm.vx = 0;
+        pm.vy = 0;
+        pm.fx = 0;
+        pm.fy = 0;
+        pm.mass = 1.0f;
+        pm.isFixed = false;
+        pm.isDragged = false;
+        points.push_back(pm);
+        restPositions.push_back(pm.x);
+        restPositions.push_back(pm.y);
+    }
+
+    for (size_t t = 0; t + 2 < ordered.triangles.size(); t += 3) {
+        Face f = {ordered.triangles[t], ordered.triangles[t + 1], ordered.triangles[t + 2]};
+        faces.push_back(f);
+    }
+
+    InitializeMeshSprings();
+    InitializeTearing();
+    InitializeMaterials();
+    InitializeStability();
+    InitializeDetail();
+}
+
+Cloth::Cloth(const ClothData& data)
+    : width(data.width), height(data.height), isMesh(data.isMesh), spacing(data.spacing), originX(data.originX), originY(data.originY),
+      draggedPoint(-1), gravityForce(data.gravityForce), springStiffness(data.springStiffness),
+      springDamping(data.springDamping), showWires(data.showWires), minSubsteps(1), selfCollisionInterval(1),
+      aero(data.aero), scheduler(&TaskScheduler::Default()),
+      deterministic(false), projective(false), projectiveIterations(10), pdFactored(false),
+      pdStep(0.0f), pdTopologyVersion(0), factorizationCount(0), compact(false),
+      renderDetail(std::max(1, std::min(MAX_RENDER_DETAIL, data.renderDetail))) {
+    // Reserve for tearing first, so the block copies below are the only writes
+    size_t capacity = TearingCapacity(data.pointCount, data.faces, data.faceCount);
+    points.reserve(capacity);
+    points.assign(data.points, data.points + data.pointCount);
+    springs.assign(data.springs, data.springs + data.springCount);
+    faces.assign(data.faces, data.faces + data.faceCount);
+
+    // Meshes have no grid to rebuild, so Reset restores them from saved positions
+    if (isMesh) {
+        restPositions.reserve(capacity * 2);
+        restPositions.resize(points.size() * 2);
+        for (size_t i = 0; i < points.size(); i++) {
+            restPositions[i * 2] = points[i].x;
+            restPositions[i * 2 + 1] = points[i].y;
+        }
+    }
+
+    InitializeTearing(data.faceEdgeSprings);
+    InitializeMaterials();
+    InitializeStability();
+    InitializeDetail();
 }
 
 Cloth::~Cloth() {}
 
+ClothData Cloth::GetData() const {
+    assert(!compact);
+    ClothData data;
+    data.width = width;
+    data.height = height;
+    data.isMesh = isMesh;
+    data.spacing = spacing;
+    data.originX = originX;
+    data.originY = originY;
+    data.gravityForce = gravityForce;
+    data.springStiffness = springStiffness;
+    data.springDamping = springDamping;
+    data.renderDetail = renderDetail;
+    data.showWires = showWires;
+    data.aero = aero;
+    data.pointCount = (int)points.size();
+    data.springCount = (int)springs.size();
+    data.faceCount = (int)faces.size();
+    data.points = points.data();
+    data.springs = springs.data();
+    data.faces = faces.data();
+    data.faceEdgeSprings = faceEdgeSpring.data();
+    return data;
+}
+
 void Cloth::InitializeSprings() {
     // Create structural springs
     for (int y = 0; y < height; y++) {
@@ -40,6 +141,7 @@ void Cloth::InitializeSprings() {
                 s.restLength = spacing;
                 s.stiffness = springStiffness;
                 s.damping = springDamping;
+                s.family = FAMILY_STRUCTURAL;
                 springs.push_back(s);
             }
 
@@ -51,6 +153,7 @@ void Cloth::InitializeSprings() {
                 s.restLength = spacing;
                 s.stiffness = springStiffness;
                 s.damping = springDamping;
+                s.family = FAMILY_STRUCTURAL;
                 springs.push_back(s);
             }
 
@@ -60,8 +163,9 @@ void Cloth::InitializeSprings() {
                 s.point1 = current;
                 s.point2 = current + width + 1;
                 s.restLength = spacing * std::sqrt(2.0f);
-                s.stiffness = springStiffness / 2.0f;
-                s.damping = springDamping * 0.75f;
+                s.stiffness = springStiffness * ClothKernels::SHEAR_STIFFNESS_RATIO;
+                s.damping = springDamping * ClothKernels::SHEAR_DAMPING_RATIO;
+                s.family = FAMILY_SHEAR;
                 springs.push_back(s);
 
                 s.point1 = current + 1;
@@ -79,6 +183,89 @@ void Cloth::InitializeSprings() {
     }
 }
 
+void Cloth::InitializeMeshSprings() {
+    // Collect every triangle edge with the vertex opposite to it
+    struct Edge { int a, b, opposite; };
+    std::vector<Edge> edges;
+    edges.reserve(faces.size() * 3);
+    for (const auto& face : faces) {
+        int v[3] = {face.p1, face.p2, face.p3};
+        for (int e = 0; e < 3; e++) {
+            int a = v[e];
+            int b = v[(e + 1) % 3];
+            edges.push_back({std::min(a, b), std::max(a, b), v[(e + 2) % 3]});
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& l, const Edge& r) {
+        return l.a != r.a ? l.a < r.a : l.b < r.b;
+    });
+
+    float totalLength = 0.0f;
+    int structuralCount = 0;
+    std::vector<Spring> bending;
+
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b) j++;
+
+        const PointMass& p1 = points[edges[i].a];
+        const PointMass& p2 = points[edges[i].b];
+        float dx = p2.x - p1.x;
+        float dy = p2.y - p1.y;
+
+        // Structural spring along the mesh edge
+        Spring s;
+        s.point1 = edges[i].a;
+        s.point2 = edges[i].b;
+        s.restLength = std::sqrt(dx * dx + dy * dy);
+        s.stiffness = springStiffness;
+        s.damping = springDamping;
+        s.maxStretch = ClothKernels::STRUCTURAL_MAX_STRETCH;
+        s.family = FAMILY_STRUCTURAL;
+        if (s.restLength > ClothKernels::MIN_SPRING_LENGTH) {
+            springs.push_back(s);
+            totalLength += s.restLength;
+            structuralCount++;
+        }
+
+        // Bending spring across an interior edge, between the two opposite vertices
+        if (j - i == 2 && edges[i].opposite != edges[i + 1].opposite) {
+            int o1 = std::min(edges[i].opposite, edges[i + 1].opposite);
+            int o2 = std::max(edges[i].opposite, edges[i + 1].opposite);
+            float bx = points[o2].x - points[o1].x;
+            float by = points[o2].y - points[o1].y;
+
+            Spring b;
+            b.point1 = o1;
+            b.point2 = o2;
+            b.restLength = std::sqrt(bx * bx + by * by);
+            b.stiffness = springStiffness * ClothKernels::SHEAR_STIFFNESS_RATIO;
+            b.damping = springDamping * ClothKernels::SHEAR_DAMPING_RATIO;
+            b.maxStretch = ClothKernels::OTHER_MAX_STRETCH;
+            b.family = FAMILY_BENDING;
+            if (b.restLength > ClothKernels::MIN_SPRING_LENGTH) bending.push_back(b);
+        }
+        i = j;
+    }
+
+    // Keep bending springs in point order too and drop any duplicate pairs
+    std::sort(bending.begin(), bending.end(), [](const Spring& l, const Spring& r) {
+        return l.point1 != r.point1 ? l.point1 < r.point1 : l.point2 < r.point2;
+    });
+    bending.erase(std::unique(bending.begin(), bending.end(), [](const Spring& l, const Spring& r) {
+        return l.point1 == r.point1 && l.point2 == r.point2;
+    }), bending.end());
+    springs.insert(springs.end(), bending.begin(), bending.end());
+
+    for (auto& spring : springs) {
+        spring.broken = false;
+        spring.stressFrames = 0;
+    }
+
+    // Collision radius and face shading use the mean edge length as grid spacing
+    spacing = structuralCount > 0 ? totalLength / structuralCount : 1.0f;
+}
+
 void Cloth::InitializeFaces() {
     for (int y = 0; y < height - 1; y++) {
         for (int x = 0; x < width - 1; x++) {
@@ -101,89 +288,358 @@ void Cloth::ResetSpringStress(Spring& spring) {
 }
 
 void Cloth::UpdateSpringStress(Spring& spring, float stretch) {
-    float stressThreshold = 0.8f * spring.maxStretch;
-
-    if (stretch > stressThreshold) {
-        spring.stressFrames++;
-    } else {
-        spring.stressFrames = std::max(0, spring.stressFrames - 2); // Recover twice as fast
-    }
+    spring.stressFrames = ClothKernels::UpdateStress(spring.stressFrames, stretch, spring.maxStretch);
 }
 
 void Cloth::Update(float dt, float alpha) {
+    if (compact) Expand();
     if (dt > 0) {
-        // Store previous positions
-        for (auto& point : points) {
-            point.prevX = point.x;
-            point.prevY = point.y;
+        StorePreviousPositions();
+        AdvanceFrame(dt);
+    }
+
+    // Interpolation update
+    UpdateInterpolation(alpha);
+}
+
+void Cloth::Step(int steps, float dt) {
+    if (dt <= 0) return;
+    if (compact) Expand();
+    for (int i = 0; i < steps; i++) {
+        // Only the last frame's start matters for interpolation
+        if (i == steps - 1) StorePreviousPositions();
+        AdvanceFrame(dt);
+    }
+}
+
+void Cloth::StorePreviousPositions() {
+    RunPointPhase(PHASE_STORE, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            points[i].prevX = points[i].x;
+            points[i].prevY = points[i].y;
         }
+    });
+}
 
-        // Physics update
-        for (auto& point : points) {
-            point.fx = 0;
-            point.fy = 0;
+void Cloth::AdvanceFrame(float dt) {
+    SaveSnapshot();
+
+    // Run the frame, retrying from the snapshot with more substeps if it diverges.
+    // A snapshot age frames old is age frames behind, so those are run again
+    // and the frame still ends at the same simulated time.
+    int age = 0;
+    while (true) {
+        float h = dt / substeps;
+        int steps = substeps * (age + 1);
+        bool diverged = false;
+        for (int i = 0; i < steps && !diverged; i++) {
+            Simulate(h);
+            diverged = IsDiverging();
+        }
+        if (!diverged) break;
+
+        rollbackCount++;
+        stableFrames = 0;
+        int from = age;
+        if (substeps < MAX_SUBSTEPS) {
+            substeps *= 2;
+        } else if (age + 1 < snapshotCount) {
+            from++; // Still unstable at the finest step: fall back to an older state
+        } else {
+            break; // Ring exhausted, leave it to the velocity clamp
         }
+        if (snapshots[(snapshotHead - from + SNAPSHOT_COUNT) % SNAPSHOT_COUNT].topologyVersion != topologyVersion) {
+            break; // Torn since the snapshot was taken, keep the torn state
+        }
+        age = from;
+        RestoreSnapshot(age);
+    }
+    // Snapshots newer than the one the frame was rerun from belong to the abandoned run
+    snapshotHead = (snapshotHead - age + SNAPSHOT_COUNT) % SNAPSHOT_COUNT;
+    snapshotCount -= age;
+    pendingForceX = 0.0f;
+    pendingForceY = 0.0f;
+
+    // Grow the step again once the cloth has settled
+    if (substeps > minSubsteps && ++stableFrames >= STABLE_FRAMES_TO_RELAX) {
+        substeps = std::max(minSubsteps, substeps / 2);
+        stableFrames = 0;
+    }
+}
+
+void Cloth::Simulate(float dt) {
+    // Uniform parts of every field fold into one vector per substep
+    float uniformX = pendingForceX;
+    float uniformY = pendingForceY;
+    for (size_t f = 0; f < forceFields.size(); f++) {
+        if (!forceFieldActive[f]) continue;
+        const ForceField& field = forceFields[f];
+        float gust = std::sin(field.frequency * simTime + field.phase);
+        uniformX += field.fx + field.gustX * gust;
+        uniformY += field.fy + field.gustY * gust;
+    }
 
-        ApplyGravity();
-        ApplySpringForces();
+    // By default the spring, breaking and self-collision passes scatter into shared points and stay serial
+    RunPointPhase(PHASE_FORCES, [this, uniformX, uniformY](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            points[i].fx = 0;
+            points[i].fy = 0;
+        }
+        ApplyGravity(begin, end);
+        ApplyForceFields(uniformX, uniformY, begin, end);
+    });
+    bool selfCollide = ++selfCollisionPhase >= selfCollisionInterval;
+    if (selfCollide) selfCollisionPhase = 0;
+    if (projective) {
+        // Springs are solved implicitly, so bounds are enforced on the result
+        ApplyAerodynamics();
+        if (draggedPoint != -1) {
+            points[draggedPoint].prevX = points[draggedPoint].x;
+            points[draggedPoint].prevY = points[draggedPoint].y;
+            points[draggedPoint].x = mouseX;
+            points[draggedPoint].y = mouseY;
+        }
+        SolveProjective(dt);
+        if (deterministic) {
+            CheckSpringBreakingOrdered();
+            if (selfCollide) HandleSelfCollisionsOrdered();
+        } else {
+            CheckSpringBreaking();
+            if (selfCollide) HandleSelfCollisions();
+        }
+        RunPointPhase(PHASE_COLLISIONS, [this](int begin, int end) {
+            HandleCollisions(begin, end);
+        });
+        simTime += dt;
+        return;
+    }
+    if (deterministic) {
+        GatherSpringForces(dt);
+        ApplyAerodynamics();
+        CheckSpringBreakingOrdered();
+        if (selfCollide) HandleSelfCollisionsOrdered();
+    } else {
+        ApplySpringForces(dt);
+        ApplyAerodynamics();
         CheckSpringBreaking();
-        HandleSelfCollisions();
-        HandleCollisions();
-        UpdatePositions(dt);
+        if (selfCollide) HandleSelfCollisions();
     }
+    RunPointPhase(PHASE_COLLISIONS, [this](int begin, int end) {
+        HandleCollisions(begin, end);
+    });
+    UpdatePositions(dt);
+    simTime += dt;
+}
 
-    // Interpolation update
-    UpdateInterpolation(alpha);
+void Cloth::InitializeStability() {
+    snapshotHead = 0;
+    snapshotCount = 0;
+    substeps = minSubsteps;
+    selfCollisionPhase = 0;
+    stableFrames = 0;
+    rollbackCount = 0;
+    kineticEnergy = 0.0f;
+    springEnergy = 0.0f;
+    lastKineticEnergy = 0.0f;
+    clampedPoints = 0;
+    pendingForceX = 0.0f;
+    pendingForceY = 0.0f;
+    simTime = 0.0f;
+    pdFactored = false;
+    ReserveSnapshots();
 }
 
-void Cloth::UpdateInterpolation(float alpha) {
-    for (auto& point : points) {
-        point.renderX = point.prevX + (point.x - point.prevX) * alpha;
-        point.renderY = point.prevY + (point.y - point.prevY) * alpha;
+void Cloth::ReserveSnapshots() {
+    // Size for the most points tearing can create, so saving never reallocates
+    for (auto& snapshot : snapshots) {
+        snapshot.pointState.reserve(points.capacity() * 4);
+        snapshot.springBroken.reserve(springs.size());
+        snapshot.springStress.reserve(springs.size());
+        snapshot.springPeak.reserve(springs.size());
     }
+    chunkEnergy.reserve(points.capacity() / POINT_CHUNK + 1);
+    chunkClamped.reserve(points.capacity() / POINT_CHUNK + 1);
 }
 
-void Cloth::ApplyGravity() {
+void Cloth::SaveSnapshot() {
+    snapshotHead = (snapshotHead + 1) % SNAPSHOT_COUNT;
+    snapshotCount = std::min(snapshotCount + 1, SNAPSHOT_COUNT);
+
+    // Slots keep their capacity, so after warm-up this never allocates
+    StateSnapshot& snapshot = snapshots[snapshotHead];
+    snapshot.pointState.resize(points.size() * 4);
+    snapshot.springBroken.resize(springs.size());
+    snapshot.springStress.resize(springs.size());
+    snapshot.springPeak.assign(springPeak.begin(), springPeak.end());
+
+    float* state = snapshot.pointState.data();
+    for (const auto& point : points) {
+        *state++ = point.x;
+        *state++ = point.y;
+        *state++ = point.vx;
+        *state++ = point.vy;
+    }
+    for (size_t i = 0; i < springs.size(); i++) {
+        snapshot.springBroken[i] = springs[i].broken;
+        snapshot.springStress[i] = springs[i].stressFrames;
+    }
+    snapshot.kineticEnergy = lastKineticEnergy;
+    snapshot.time = simTime;
+    snapshot.topologyVersion = topologyVersion;
+}
+
+void Cloth::RestoreSnapshot(int age) {
+    const StateSnapshot& snapshot = snapshots[(snapshotHead - age + SNAPSHOT_COUNT) % SNAPSHOT_COUNT];
+
+    const float* state = snapshot.pointState.data();
     for (auto& point : points) {
-        if (!point.isFixed && !point.isDragged) {
-            point.fy += gravityForce * point.mass;
+        point.x = *state++;
+        point.y = *state++;
+        point.vx = *state++;
+        point.vy = *state++;
+        if (age > 0) {
+            point.prevX = point.x;
+            point.prevY = point.y;
         }
     }
+    for (size_t i = 0; i < springs.size(); i++) {
+        springs[i].broken = snapshot.springBroken[i] != 0;
+        springs[i].stressFrames = snapshot.springStress[i];
+    }
+    // Peaks reached after the snapshot would otherwise soften the restored springs
+    if (snapshot.springPeak.size() == springPeak.size()) {
+        std::copy(snapshot.springPeak.begin(), snapshot.springPeak.end(), springPeak.begin());
+    }
+    lastKineticEnergy = snapshot.kineticEnergy;
+    simTime = snapshot.time;
+    pdFactored = false;  // Broken springs may have been restored
 }
 
-void Cloth::ApplySpringForces() {
-    for (const auto& spring : springs) {
-        if (spring.broken) continue;
-
-        PointMass& p1 = points[spring.point1];
-        PointMass& p2 = points[spring.point2];
+bool Cloth::IsDiverging() const {
+    // Average kinetic energy per point below which growth is not considered a blow-up
+    const float energyFloor = 0.5f * 200.0f * 200.0f;
 
-        float dx = p2.x - p1.x;
-        float dy = p2.y - p1.y;
-        float length = std::sqrt(dx * dx + dy * dy);
+    if (!std::isfinite(kineticEnergy) || !std::isfinite(springEnergy)) return true;
+    if (clampedPoints * 10 > (int)points.size()) return true;
+    return kineticEnergy > 4.0f * lastKineticEnergy &&
+           kineticEnergy > energyFloor * points.size();
+}
 
-        if (length < 0.0001f) continue;
+void Cloth::UpdateInterpolation(float alpha) {
+    RunPointPhase(PHASE_INTERPOLATION, [this, alpha](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            PointMass& point = points[i];
+            point.renderX = point.prevX + (point.x - point.prevX) * alpha;
+            point.renderY = point.prevY + (point.y - point.prevY) * alpha;
+        }
+    });
+    if (renderDetail > 1) UpdateDetail();
+}
 
-        float stretch = length / spring.restLength;
-        float force = spring.stiffness * GetNonlinearForce(stretch);
+void Cloth::ApplyGravity(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        PointMass& point = points[i];
+        if (!point.isFixed && !point.isDragged) {
+            point.fy += gravityForce * point.mass;
+        }
+    }
+}
 
-        float relativeVelocityX = p2.vx - p1.vx;
-        float relativeVelocityY = p2.vy - p1.vy;
+void Cloth::ApplyForceFields(float uniformX, float uniformY, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        PointMass& point = points[i];
+        if (!point.isFixed && !point.isDragged) {
+            point.fx += uniformX;
+            point.fy += uniformY;
+        }
+    }
 
-        // Hooke's law with damping
-        float dampingForce = spring.damping * (relativeVelocityX * dx + relativeVelocityY * dy) / length;
-        float totalForce = force + dampingForce;
+    for (size_t f = 0; f < forceFields.size(); f++) {
+        const std::vector<float>& perPoint = forceFields[f].perPoint;
+        if (!forceFieldActive[f] || perPoint.empty()) continue;
+        int last = std::min(end, (int)perPoint.size() / 2);
+        for (int i = begin; i < last; i++) {
+            PointMass& point = points[i];
+            if (!point.isFixed && !point.isDragged) {
+                point.fx += perPoint[i * 2];
+                point.fy += perPoint[i * 2 + 1];
+            }
+        }
+    }
+}
 
-        float fx = (dx / length) * totalForce;
-        float fy = (dy / length) * totalForce;
+void Cloth::ApplyAerodynamics() {
+    if (!aero.enabled || faces.empty()) return;
+
+    // The turbulence tile is frozen and carried along by the mean wind
+    turbulence.Update(simTime, aero.turbulencePeriod);
+    float invScale = 1.0f / aero.turbulenceScale;
+    float scrollU = aero.windX * simTime * invScale;
+    float scrollV = aero.windY * simTime * invScale;
+
+    float chordX[AERO_BATCH], chordY[AERO_BATCH], area[AERO_BATCH];
+    float flowX[AERO_BATCH], flowY[AERO_BATCH];
+    float forceX[AERO_BATCH], forceY[AERO_BATCH];
+
+    for (size_t base = 0; base < faces.size(); base += AERO_BATCH) {
+        int count = (int)std::min((size_t)AERO_BATCH, faces.size() - base);
+
+        // Gather: the only indexed loads, everything after runs on flat arrays
+        for (int k = 0; k < count; k++) {
+            const Face& face = faces[base + k];
+            const PointMass& p1 = points[face.p1];
+            const PointMass& p2 = points[face.p2];
+            const PointMass& p3 = points[face.p3];
+
+            float ax = p2.x - p1.x, ay = p2.y - p1.y;
+            float bx = p3.x - p1.x, by = p3.y - p1.y;
+            float cx = p3.x - p2.x, cy = p3.y - p2.y;
+            area[k] = 0.5f * std::abs(ax * by - bx * ay);
+
+            // Longest edge is the chord
+            float la = ax * ax + ay * ay, lb = bx * bx + by * by, lc = cx * cx + cy * cy;
+            bool useA = la >= lb && la >= lc;
+            bool useB = !useA && lb >= lc;
+            chordX[k] = useA ? ax : (useB ? bx : cx);
+            chordY[k] = useA ? ay : (useB ? by : cy);
+
+            float gustX, gustY;
+            float centerX = (p1.x + p2.x + p3.x) * (1.0f / 3.0f);
+            float centerY = (p1.y + p2.y + p3.y) * (1.0f / 3.0f);
+            turbulence.Sample(centerX * invScale - scrollU, centerY * invScale - scrollV, gustX, gustY);
+
+            flowX[k] = aero.windX + aero.turbulence * gustX - (p1.vx + p2.vx + p3.vx) * (1.0f / 3.0f);
+            flowY[k] = aero.windY + aero.turbulence * gustY - (p1.vy + p2.vy + p3.vy) * (1.0f / 3.0f);
+        }
 
-        if (!p1.isFixed && !p1.isDragged) {
-            p1.fx += fx;
-            p1.fy += fy;
+        // Plate forces, branch-free so the loop vectorizes
+        for (int k = 0; k < count; k++) {
+            float chordLength = std::sqrt(chordX[k] * chordX[k] + chordY[k] * chordY[k]) + 1e-6f;
+            float nx = -chordY[k] / chordLength;
+            float ny = chordX[k] / chordLength;
+
+            float speed = std::sqrt(flowX[k] * flowX[k] + flowY[k] * flowY[k]) + 1e-6f;
+            float normalFlow = flowX[k] * nx + flowY[k] * ny;
+            float scale = aero.density * area[k] * (1.0f / 3.0f);  // Split over the three corners
+
+            // Normal push |v| vn n: its along-flow part is drag, the rest is lift
+            float drag = aero.dragCoefficient * normalFlow * normalFlow / speed + aero.frictionCoefficient * speed;
+            float lift = aero.liftCoefficient * normalFlow;
+            forceX[k] = scale * (drag * flowX[k] + lift * (speed * nx - normalFlow * flowX[k] / speed));
+            forceY[k] = scale * (drag * flowY[k] + lift * (speed * ny - normalFlow * flowY[k] / speed));
         }
-        if (!p2.isFixed && !p2.isDragged) {
-            p2.fx -= fx;
-            p2.fy -= fy;
+
+        // Scatter to the corners
+        for (int k = 0; k < count; k++) {
+            const Face& face = faces[base + k];
+            int corners[3] = {face.p1, face.p2, face.p3};
+            for (int c = 0; c < 3; c++) {
+                PointMass& point = points[corners[c]];
+                if (!point.isFixed && !point.isDragged) {
+                    point.fx += forceX[k];
+                    point.fy += forceY[k];
+                }
+            }
         }
     }
 }
@@ -202,20 +658,22 @@ void Cloth::CheckSpringBreaking() {
 
         UpdateSpringStress(spring, stretch);
 
-        if (stretch > spring.maxStretch && spring.stressFrames >= Spring::STRESS_THRESHOLD) {
+        if (ClothKernels::ShouldBreak(stretch, spring.maxStretch, spring.stressFrames)) {
             spring.broken = true;
+            pdFactored = false;
+            SplitVertex(spring.point1);
+            SplitVertex(spring.point2);
         }
     }
 }
 
-float Cloth::GetNonlinearForce(float stretch) const {
-    const float linearRegion = 1.2f;  // Reduced from 1.5
-    if (stretch <= linearRegion) {
-        return (stretch - 1.0f) * 1.5f;  // Increased linear response
-    } else {
-        float excess = stretch - linearRegion;
-        return (linearRegion - 1.0f) * 1.5f + excess * 2.5f;  // Increased non-linear response
-    }
+float Cloth::GetNonlinearForce(float stretch) {
+    float unused = 0.0f;
+    return DefaultResponse().Force(stretch, unused);
+}
+
+float Cloth::GetNonlinearEnergy(float stretch) {
+    return DefaultResponse().Energy(stretch);
 }
 
 void Cloth::HandleSelfCollisions() {
@@ -254,74 +712,30 @@ bool Cloth::CheckPointProximity(const PointMass& p1, const PointMass& p2) const
     return distSquared < spacing * spacing;
 }
 
-void Cloth::HandleCollisions() {
-    const float windowWidth = 800.0f;
-    const float windowHeight = 600.0f;
-    const float restitution = 0.3f; // Reduced restitution for less bouncy collisions
-
-    for (auto& point : points) {
+void Cloth::HandleCollisions(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        PointMass& point = points[i];
         if (point.isFixed || point.isDragged) continue;
-
-        // Bottom collision
-        if (point.y > windowHeight - 20) {
-            point.y = windowHeight - 20;
-            point.vy = -point.vy * restitution;
-            point.vx *= 0.8f; // Add friction
-        }
-
-        // Top collision
-        if (point.y < 20) {
-            point.y = 20;
-            point.vy = -point.vy * restitution;
-            point.vx *= 0.8f; // Add friction
-        }
-
-        // Right collision
-        if (point.x > windowWidth - 20) {
-            point.x = windowWidth - 20;
-            point.vx = -point.vx * restitution;
-            point.vy *= 0.8f; // Add friction
-        }
-
-        // Left collision
-        if (point.x < 20) {
-            point.x = 20;
-            point.vx = -point.vx * restitution;
-            point.vy *= 0.8f; // Add friction
-        }
+        ClothKernels::CollideBounds(ClothKernels::WINDOW_BOUNDS, point.x, point.y, point.vx, point.vy);
     }
 }
 
 void Cloth::UpdatePositions(float dt) {
-    for (auto& point : points) {
-        if (point.isFixed || point.isDragged) continue;
-
-        // Store previous position for interpolation
-        point.prevX = point.x;
-        point.prevY = point.y;
-
-        const float damping = 0.85f;  // Increased from 0.95 for more rigidity
-
-        // Verlet integration with velocity damping
-        float ax = point.fx / point.mass;
-        float ay = point.fy / point.mass;
-
-        // Update velocity with damping
-        point.vx = (point.vx + ax * dt) * damping;
-        point.vy = (point.vy + ay * dt) * damping;
-
-        // Limit velocity for stability
-        float maxVelocity = 1000.0f;
-        float velocity = std::sqrt(point.vx * point.vx + point.vy * point.vy);
-        if (velocity > maxVelocity) {
-            float scale = maxVelocity / velocity;
-            point.vx *= scale;
-            point.vy *= scale;
-        }
-
-        // Update position
-        point.x += point.vx * dt;
-        point.y += point.vy * dt;
+    int chunkCount = ((int)points.size() + POINT_CHUNK - 1) / POINT_CHUNK;
+    chunkEnergy.resize(chunkCount);
+    chunkClamped.resize(chunkCount);
+
+    RunPointPhase(PHASE_POSITIONS, [this, dt](int begin, int end) {
+        IntegratePoints(dt, begin, end);
+    });
+
+    // Reduce in chunk order so the totals do not depend on the thread count
+    lastKineticEnergy = kineticEnergy;
+    kineticEnergy = 0.0f;
+    clampedPoints = 0;
+    for (int c = 0; c < chunkCount; c++) {
+        kineticEnergy += chunkEnergy[c];
+        clampedPoints += chunkClamped[c];
     }
 
     // Handle dragged point
@@ -333,30 +747,39 @@ void Cloth::UpdatePositions(float dt) {
     }
 }
 
+void Cloth::IntegratePoints(float dt, int begin, int end) {
+    float damping = ClothKernels::StepDamping(ClothKernels::VELOCITY_DAMPING, dt);
+    // begin is always chunk aligned; inline runs may cover several chunks
+    for (int chunkBegin = begin; chunkBegin < end; chunkBegin += POINT_CHUNK) {
+        int chunkEnd = std::min(chunkBegin + POINT_CHUNK, end);
+        float energy = 0.0f;
+        int clamped = 0;
+
+        for (int i = chunkBegin; i < chunkEnd; i++) {
+            PointMass& point = points[i];
+            if (point.isFixed || point.isDragged) continue;
+
+            // Damped, clamped integration
+            bool limited = false;
+            float velocity = ClothKernels::IntegratePoint(point.x, point.y, point.vx, point.vy, point.fx / point.mass,
+                                                          point.fy / point.mass, dt, damping,
+                                                          ClothKernels::MAX_VELOCITY, limited);
+            clamped += limited;
+            energy += 0.5f * point.mass * velocity * velocity;
+        }
+
+        chunkEnergy[chunkBegin / POINT_CHUNK] = energy;
+        chunkClamped[chunkBegin / POINT_CHUNK] = clamped;
+    }
+}
+
+#ifdef _WIN32
 COLORREF Cloth::GetFaceColor(const Face& face) const {
-    // Calculate 2D edge vectors
-    const PointMass& p1 = points[face.p1];
-    const PointMass& p2 = points[face.p2];
-    const PointMass& p3 = points[face.p3];
-    
-    float dx1 = p2.x - p1.x;
-    float dy1 = p2.y - p1.y;
-    float dx2 = p3.x - p1.x;
-    float dy2 = p3.y - p1.y;
-    
-    // Calculate 2D cross product for orientation
-    float crossProduct = dx1 * dy2 - dx2 * dy1;
-    
-    // Calculate area-based shading
-    float area = std::abs(crossProduct) / 2.0f;
-    float baseArea = spacing * spacing / 2.0f;
-    float stretch = area / baseArea;
-    
-    // Map stretch to intensity
-    float intensity = 0.3f + 0.7f * (1.0f / (1.0f + stretch * 0.5f));
-    intensity = std::min(1.0f, std::max(0.3f, intensity));
-    
-    int color = (int)(intensity * 255);
+    return GetStretchColor(GetFaceStretch(face));
+}
+
+COLORREF Cloth::GetStretchColor(float stretch) const {
+    int color = GetStretchShade(stretch);
     return RGB(color, color, color);
 }
 
@@ -368,11 +791,14 @@ void Cloth::DrawFace(HDC hdc, const Face& face) {
     points[1].y = (LONG)this->points[face.p2].renderY;
     points[2].x = (LONG)this->points[face.p3].renderX;
     points[2].y = (LONG)this->points[face.p3].renderY;
-    
-    HBRUSH hBrush = CreateSolidBrush(GetFaceColor(face));
+    FillTriangle(hdc, points, GetFaceColor(face));
+}
+
+void Cloth::FillTriangle(HDC hdc, const POINT* corners, COLORREF color) {
+    HBRUSH hBrush = CreateSolidBrush(color);
     HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, hBrush);
     
-    Polygon(hdc, points, 3);
+    Polygon(hdc, corners, 3);
     
     SelectObject(hdc, hOldBrush);
     DeleteObject(hBrush);
@@ -387,15 +813,8 @@ void Cloth::DrawSpring(HDC hdc, const Spring& spring, const PointMass& p1, const
     float length = std::sqrt(dx * dx + dy * dy);
     float stretch = length / spring.restLength;
 
-    // Enhanced color gradient
-    float tension = (stretch - 1.0f) / (spring.maxStretch - 1.0f);
-    tension = std::min(1.0f, std::max(0.0f, tension));
-
-    int r = (int)(255 * tension);
-    int g = (int)(255 * (1.0f - tension));
-    int b = (int)(255 * (1.0f - tension * 0.5f));
-
-    HPEN hPen = CreatePen(PS_SOLID, 2, RGB(r, g, b));
+    uint32_t color = GetTensionColor(stretch, spring.maxStretch);
+    HPEN hPen = CreatePen(PS_SOLID, 2, RGB(color >> 16, (color >> 8) & 0xFF, color & 0xFF));
     HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
 
     MoveToEx(hdc, (int)p1.renderX, (int)p1.renderY, NULL);
@@ -405,10 +824,39 @@ void Cloth::DrawSpring(HDC hdc, const Spring& spring, const PointMass& p1, const
     DeleteObject(hPen);
 }
 
-void Cloth::Draw(HDC hdc) {
-    // Draw faces first
-    for (const auto& face : faces) {
+void Cloth::Draw(HDC hdc, const DirtyTileMap* dirty) {
+    if (compact) Expand();
+    const float pad = DRAW_PADDING;
+
+    auto drawFace = [&](const Face& face) {
+        if (dirty) {
+            const PointMass& a = points[face.p1];
+            const PointMass& b = points[face.p2];
+            const PointMass& c = points[face.p3];
+            if (!dirty->Intersects(std::min(a.renderX, std::min(b.renderX, c.renderX)) - pad,
+                                   std::min(a.renderY, std::min(b.renderY, c.renderY)) - pad,
+                                   std::max(a.renderX, std::max(b.renderX, c.renderX)) + pad,
+                                   std::max(a.renderY, std::max(b.renderY, c.renderY)) + pad)) return;
+        }
         DrawFace(hdc, face);
+    };
+
+    // Draw faces first; with render detail on, cells away from tears draw their fine surface
+    if (renderDetail > 1) {
+        UpdateRefinedCells();
+        for (int cy = 0; cy < height - 1; cy++) {
+            for (int cx = 0; cx < width - 1; cx++) {
+                int cell = cy * (width - 1) + cx;
+                if (cellRefined[cell]) {
+                    DrawDetailCell(hdc, cx, cy, dirty);
+                } else {
+                    drawFace(faces[cell * 2]);
+                    drawFace(faces[cell * 2 + 1]);
+                }
+            }
+        }
+    } else {
+        for (const auto& face : faces) drawFace(face);
     }
     
     if (showWires) {
@@ -417,11 +865,15 @@ void Cloth::Draw(HDC hdc) {
             if (spring.broken) continue;
             const PointMass& p1 = points[spring.point1];
             const PointMass& p2 = points[spring.point2];
+            if (dirty && !dirty->Intersects(std::min(p1.renderX, p2.renderX) - pad, std::min(p1.renderY, p2.renderY) - pad,
+                                            std::max(p1.renderX, p2.renderX) + pad, std::max(p1.renderY, p2.renderY) + pad)) continue;
             DrawSpring(hdc, spring, p1, p2);
         }
 
         // Draw points only when wires are visible
         for (const auto& point : points) {
+            if (dirty && !dirty->Intersects(point.renderX - pad, point.renderY - pad,
+                                            point.renderX + pad, point.renderY + pad)) continue;
             HBRUSH hBrush;
             if (point.isFixed) {
                 hBrush = CreateSolidBrush(RGB(255, 0, 0)); // Red for fixed points
@@ -439,23 +891,204 @@ void Cloth::Draw(HDC hdc) {
         }
     }
 }
+#endif
 
-void Cloth::AddForce(float fx, float fy) {
-    for (auto& point : points) {
-        if (!point.isFixed && !point.isDragged) {
-            point.fx += fx;
-            point.fy += fy;
+int Cloth::GetStretchShade(float stretch) {
+    // Map stretch to intensity
+    float intensity = 0.3f + 0.7f * (1.0f / (1.0f + stretch * 0.5f));
+    intensity = std::min(1.0f, std::max(0.3f, intensity));
+    return (int)(intensity * 255);
+}
+
+uint32_t Cloth::GetTensionColor(float stretch, float maxStretch) {
+    // Enhanced color gradient
+    float tension = (stretch - 1.0f) / (maxStretch - 1.0f);
+    tension = std::min(1.0f, std::max(0.0f, tension));
+
+    int r = (int)(255 * tension);
+    int g = (int)(255 * (1.0f - tension));
+    int b = (int)(255 * (1.0f - tension * 0.5f));
+    return (uint32_t)(r << 16 | g << 8 | b);
+}
+
+void Cloth::AppendDrawList(DrawList& list) {
+    if (compact) Expand();
+
+    // Same order and colors as Draw: faces or fine cells, then springs, then points
+    auto addFace = [&](const Face& face) {
+        const PointMass& a = points[face.p1];
+        const PointMass& b = points[face.p2];
+        const PointMass& c = points[face.p3];
+        int shade = GetStretchShade(GetFaceStretch(face));
+        list.AddTriangle(a.renderX, a.renderY, b.renderX, b.renderY, c.renderX, c.renderY,
+                         (uint32_t)(shade << 16 | shade << 8 | shade));
+    };
+    if (renderDetail > 1) {
+        UpdateRefinedCells();
+        for (int cy = 0; cy < height - 1; cy++) {
+            for (int cx = 0; cx < width - 1; cx++) {
+                int cell = cy * (width - 1) + cx;
+                if (cellRefined[cell]) {
+                    AppendDetailCell(list, cx, cy);
+                } else {
+                    addFace(faces[cell * 2]);
+                    addFace(faces[cell * 2 + 1]);
+                }
+            }
+        }
+    } else {
+        for (const auto& face : faces) addFace(face);
+    }
+
+    if (!showWires) return;
+    for (const auto& spring : springs) {
+        if (spring.broken) continue;
+        const PointMass& p1 = points[spring.point1];
+        const PointMass& p2 = points[spring.point2];
+        float dx = p2.renderX - p1.renderX;
+        float dy = p2.renderY - p1.renderY;
+        float stretch = std::sqrt(dx * dx + dy * dy) / spring.restLength;
+        list.AddLine(p1.renderX, p1.renderY, p2.renderX, p2.renderY, GetTensionColor(stretch, spring.maxStretch));
+    }
+    for (const auto& point : points) {
+        // Red for fixed, green for dragged, black for the rest
+        uint32_t color = point.isFixed ? 0xFF0000 : (point.isDragged ? 0x00FF00 : 0x000000);
+        list.AddDot(point.renderX, point.renderY, color);
+    }
+}
+
+void Cloth::MarkDirtyTiles(DirtyTileMap& tiles) {
+    if (compact) Expand();
+    const float pad = DRAW_PADDING;
+
+    // Colors are compared as drawn, quantized, so stretch that does not change a pixel marks nothing
+    auto springColor = [&](const Spring& spring) {
+        if (spring.broken) return UNDRAWN_SPRING;
+        const PointMass& p1 = points[spring.point1];
+        const PointMass& p2 = points[spring.point2];
+        float dx = p2.renderX - p1.renderX;
+        float dy = p2.renderY - p1.renderY;
+        return GetTensionColor(std::sqrt(dx * dx + dy * dy) / spring.restLength, spring.maxStretch);
+    };
+    auto pointState = [](const PointMass& point) -> unsigned char {
+        return point.isFixed ? 1 : (point.isDragged ? 2 : 0);
+    };
+
+    bool known = drawnPositions.size() == points.size() * 2 && drawnFaceShade.size() == faces.size();
+    if (showWires) known = known && drawnSpringColor.size() == springs.size() && drawnPointState.size() == points.size();
+    // First frame, new resolution, tearing added points or wires shown: old footprint is unknown
+    if (!known) tiles.MarkAll();
+
+    // Drawing truncates to whole pixels, so sub-pixel motion changes nothing on screen
+    auto moved = [&](int i) {
+        return (int)points[i].renderX != (int)drawnPositions[i * 2] ||
+               (int)points[i].renderY != (int)drawnPositions[i * 2 + 1];
+    };
+    auto markFootprint = [&](const int* indices, int count) {
+        float left = points[indices[0]].renderX, right = left;
+        float top = points[indices[0]].renderY, bottom = top;
+        for (int k = 0; k < count; k++) {
+            int i = indices[k];
+            left = std::min(left, std::min(points[i].renderX, drawnPositions[i * 2]));
+            right = std::max(right, std::max(points[i].renderX, drawnPositions[i * 2]));
+            top = std::min(top, std::min(points[i].renderY, drawnPositions[i * 2 + 1]));
+            bottom = std::max(bottom, std::max(points[i].renderY, drawnPositions[i * 2 + 1]));
+        }
+        tiles.MarkRect(left - pad, top - pad, right + pad, bottom + pad);
+    };
+
+    // Each footprint is marked if its shape or its color changed, then the color is recorded
+    drawnFaceShade.resize(faces.size());
+    for (size_t f = 0; f < faces.size(); f++) {
+        const Face& face = faces[f];
+        unsigned char shade = (unsigned char)GetStretchShade(GetFaceStretch(face));
+        if (known && (moved(face.p1) || moved(face.p2) || moved(face.p3) || shade != drawnFaceShade[f])) {
+            int indices[3] = {face.p1, face.p2, face.p3};
+            markFootprint(indices, 3);
+        }
+        drawnFaceShade[f] = shade;
+    }
+    if (showWires) {
+        // Springs can leave the faces' footprint, e.g. across a tear
+        drawnSpringColor.resize(springs.size());
+        for (size_t s = 0; s < springs.size(); s++) {
+            const Spring& spring = springs[s];
+            uint32_t color = springColor(spring);
+            if (known && (moved(spring.point1) || moved(spring.point2) || color != drawnSpringColor[s])) {
+                int indices[2] = {spring.point1, spring.point2};
+                markFootprint(indices, 2);
+            }
+            drawnSpringColor[s] = color;
+        }
+        drawnPointState.resize(points.size());
+        for (int i = 0; i < (int)points.size(); i++) {
+            unsigned char state = pointState(points[i]);
+            if (known && state != drawnPointState[i]) markFootprint(&i, 1);
+            drawnPointState[i] = state;
+        }
+    } else {
+        // Hiding wires uncovers their last drawn pixels; hidden wires are not
+        // compared, so showing them again repaints everything
+        if (known && drawnSpringColor.size() == springs.size() && drawnPointState.size() == points.size()) {
+            for (size_t s = 0; s < springs.size(); s++) {
+                if (drawnSpringColor[s] == UNDRAWN_SPRING) continue;
+                int indices[2] = {springs[s].point1, springs[s].point2};
+                markFootprint(indices, 2);
+            }
+            for (int i = 0; i < (int)points.size(); i++) markFootprint(&i, 1);
         }
+        drawnSpringColor.clear();
+        drawnPointState.clear();
+    }
+
+    drawnPositions.resize(points.size() * 2);
+    for (size_t i = 0; i < points.size(); i++) {
+        drawnPositions[i * 2] = points[i].renderX;
+        drawnPositions[i * 2 + 1] = points[i].renderY;
     }
+
+    if (renderDetail > 1) MarkDetailTiles(tiles);
+}
+
+void Cloth::AddForce(float fx, float fy) {
+    // Forces are rebuilt at the start of every substep, so defer to the next force pass
+    pendingForceX += fx;
+    pendingForceY += fy;
+}
+
+int Cloth::AddForceField(const ForceField& field) {
+    forceFields.push_back(field);
+    forceFieldActive.push_back(1);
+    return (int)forceFields.size() - 1;
+}
+
+void Cloth::RemoveForceField(int id) {
+    if (id < 0 || id >= (int)forceFields.size()) return;
+    forceFieldActive[id] = 0;
+    forceFields[id].perPoint.clear();
+}
+
+void Cloth::ClearForceFields() {
+    forceFields.clear();
+    forceFieldActive.clear();
 }
 
 void Cloth::FixPoint(int x, int y) {
+    if (compact) Expand();
     if (x >= 0 && x < width && y >= 0 && y < height) {
         points[y * width + x].isFixed = true;
     }
 }
 
+void Cloth::FixMeshVertex(int vertex) {
+    if (compact) Expand();
+    if (vertex >= 0 && vertex < (int)meshToPoint.size()) {
+        points[meshToPoint[vertex]].isFixed = true;
+    }
+}
+
 void Cloth::HandleMouseDown(int x, int y) {
+    if (compact) Expand();
     float minDist = 10.0f;
     draggedPoint = -1;
 
@@ -477,6 +1110,29 @@ void Cloth::HandleMouseDown(int x, int y) {
     }
 }
 
+void Cloth::SetOrigin(float x, float y) {
+    if (compact) Expand();
+    float dx = x - originX;
+    float dy = y - originY;
+    originX = x;
+    originY = y;
+
+    for (auto& point : points) {
+        point.x += dx;
+        point.y += dy;
+        point.prevX += dx;
+        point.prevY += dy;
+        point.renderX += dx;
+        point.renderY += dy;
+    }
+    for (size_t i = 0; i + 1 < restPositions.size(); i += 2) {
+        restPositions[i] += dx;
+        restPositions[i + 1] += dy;
+    }
+    // Saved states are in the old place, so do not roll back into them
+    snapshotCount = 0;
+}
+
 void Cloth::HandleMouseMove(int x, int y) {
     if (draggedPoint != -1) {
         mouseX = x;
@@ -485,37 +1141,85 @@ void Cloth::HandleMouseMove(int x, int y) {
 }
 
 void Cloth::HandleMouseUp() {
+    if (compact) Expand();
     if (draggedPoint != -1) {
         points[draggedPoint].isDragged = false;
         draggedPoint = -1;
     }
 }
 
+void Cloth::SetMaxStretch(float ratio) {
+    if (compact) Expand();
+    for (auto& spring : springs) {
+        spring.maxStretch = ratio;
+    }
+}
+
 void Cloth::SetGravity(float g) {
-    gravityForce = g * 1000.0f; // Scale for better slider control
+    gravityForce = g * ClothKernels::GRAVITY_SCALE; // Scale for better slider control
 }
 
 void Cloth::SetStiffness(float s) {
-    springStiffness = s * 10000.0f; // Scale for better slider control
+    springStiffness = s * ClothKernels::STIFFNESS_SCALE; // Scale for better slider control
+    if (compact) Expand();
     for (auto& spring : springs) {
         spring.stiffness = springStiffness;
     }
+    pdFactored = false;
+}
+
+void Cloth::SetMinSubsteps(int count) {
+    int previous = minSubsteps;
+    minSubsteps = std::max(1, std::min(MAX_SUBSTEPS, count));
+    // Substeps the monitor added for stability stay until it relaxes them
+    substeps = substeps == previous ? minSubsteps : std::max(substeps, minSubsteps);
+}
+
+void Cloth::SetSelfCollisionInterval(int steps) {
+    selfCollisionInterval = std::max(1, steps);
 }
 
 void Cloth::SetDamping(float d) {
-    springDamping = d * 2.0f; // Scale for better slider control
+    springDamping = d * ClothKernels::DAMPING_SCALE; // Scale for better slider control
+    if (compact) Expand();
     for (auto& spring : springs) {
         spring.damping = springDamping;
     }
 }
 
 void Cloth::Reset() {
+    if (compact) Expand();
+    // Undo any tearing before restoring positions
+    RestoreTopology();
+    InitializeMaterials();
+    if (draggedPoint >= (int)points.size()) {
+        draggedPoint = -1;
+    }
+
+    if (isMesh) {
+        // Mesh cloth: restore loaded positions
+        for (size_t i = 0; i < points.size(); i++) {
+            points[i].x = restPositions[i * 2];
+            points[i].y = restPositions[i * 2 + 1];
+            points[i].vx = 0;
+            points[i].vy = 0;
+            points[i].fx = 0;
+            points[i].fy = 0;
+        }
+        for (auto& spring : springs) {
+            spring.broken = false;
+            spring.stressFrames = 0;
+        }
+        InitializeStability();
+        return;
+    }
+
     // Reset points to initial positions
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             int i = y * width + x;
-            points[i].x = x * spacing + 100.0f;
-            points[i].y = y * spacing + 100.0f;
+            points[i].x = x * spacing + originX;
+            points[i].y = y * spacing + originY;
             points[i].vx = 0;
             points[i].vy = 0;
             points[i].fx = 0;
@@ -527,9 +1231,11 @@ void Cloth::Reset() {
         spring.broken = false;
         spring.stressFrames = 0;
     }
+    InitializeStability();
 }
 
 void Cloth::SetResolution(int newWidth, int newHeight) {
+    if (compact) Expand();
     // Store fixed points state
     bool wasTopLeftFixed = points[0].isFixed;
     bool wasTopRightFixed = points[width - 1].isFixed;
@@ -537,18 +1243,21 @@ void Cloth::SetResolution(int newWidth, int newHeight) {
     // Create new cloth with desired resolution
     width = newWidth;
     height = newHeight;
-    spacing = 400.0f / newWidth; // Adjust spacing to maintain approximate size
+    isMesh = false;
+    spacing = GRID_EXTENT / newWidth; // Adjust spacing to maintain approximate size
     
     points.clear();
     springs.clear();
     faces.clear();
+    restPositions.clear();
+    meshToPoint.clear();
     
     // Reinitialize with new resolution
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             PointMass pm;
-            pm.x = x * spacing + 100.0f;
-            pm.y = y * spacing + 100.0f;
+            pm.x = x * spacing + originX;
+            pm.y = y * spacing + originY;
             pm.vx = 0;
             pm.vy = 0;
             pm.fx = 0;
@@ -566,8 +1275,135 @@ void Cloth::SetResolution(int newWidth, int newHeight) {
     
     InitializeSprings();
     InitializeFaces();
+    InitializeTearing();
+    InitializeMaterials();
+    InitializeStability();
+    InitializeDetail();
 }
 
 Cloth* Cloth::CreateWithResolution(int resolution) {
-    return new Cloth(resolution, resolution, 400.0f / resolution);
+    return new Cloth(resolution, resolution, GRID_EXTENT / resolution);
+}
+
+bool Cloth::IsDefaultGrid() const {
+    return !isMesh && width == height && std::fabs(spacing * width - GRID_EXTENT) < 0.01f;
+}
+
+Cloth* Cloth::CreateFromMesh(const std::string& path, float scale) {
+    TriangleMesh mesh;
+    if (!LoadMesh(path, mesh)) {
+        return nullptr;
+    }
+    return new Cloth(mesh, scale);
+}
+
+int Cloth::GetBrokenSpringCount() const {
+    int count = 0;
+    if (compact) {
+        for (uint8_t broken : compactState.springBroken) count += broken;
+        return count;
+    }
+    for (const auto& spring : springs) {
+        if (spring.broken) count++;
+    }
+    return count;
+}
+
+float Cloth::GetMaxStrain() const {
+    float maxStrain = 0.0f;
+    if (compact) {
+        // Positions are kept exact, so a parked cloth reports the same value
+        const CompactState& state = compactState;
+        for (size_t s = 0; s < state.restLength.size(); s++) {
+            if (state.springBroken[s]) continue;
+            const float* p1 = &state.position[state.springEnds[s * 2] * 2];
+            const float* p2 = &state.position[state.springEnds[s * 2 + 1] * 2];
+            float dx = p2[0] - p1[0];
+            float dy = p2[1] - p1[1];
+            maxStrain = std::max(maxStrain, std::sqrt(dx * dx + dy * dy) / state.restLength[s]);
+        }
+        return maxStrain;
+    }
+    for (const auto& spring : springs) {
+        if (spring.broken) continue;
+        const PointMass& p1 = points[spring.point1];
+        const PointMass& p2 = points[spring.point2];
+        float dx = p2.x - p1.x;
+        float dy = p2.y - p1.y;
+        maxStrain = std::max(maxStrain, std::sqrt(dx * dx + dy * dy) / spring.restLength);
+    }
+    return maxStrain;
+}
+
+float Cloth::GetFaceStretch(const Face& face) const {
+    assert(!compact);
+    const PointMass& p1 = points[face.p1];
+    const PointMass& p2 = points[face.p2];
+    const PointMass& p3 = points[face.p3];
+
+    // 2D cross product of the edge vectors gives twice the signed area
+    float dx1 = p2.x - p1.x;
+    float dy1 = p2.y - p1.y;
+    float dx2 = p3.x - p1.x;
+    float dy2 = p3.y - p1.y;
+    float area = std::abs(dx1 * dy2 - dx2 * dy1) / 2.0f;
+    float baseArea = spacing * spacing / 2.0f;
+    return area / baseArea;
+}
+
+float Cloth::GetEnergy() const {
+    float energy = GetElasticEnergy();
+    if (compact) {
+        const CompactState& state = compactState;
+        for (size_t i = 0; i < state.pointFlags.size(); i++) {
+            if (!(state.pointFlags[i] & 1)) {
+                energy -= gravityForce * state.masses[state.pointMaterial[i]] * state.position[i * 2 + 1];
+            }
+        }
+        return energy;
+    }
+    for (const auto& point : points) {
+        if (!point.isFixed) {
+            energy -= gravityForce * point.mass * point.y; // Gravity pulls towards +y
+        }
+    }
+    return energy;
+}
+
+float Cloth::GetElasticEnergy() const {
+    float energy = 0.0f;
+    if (compact) {
+        // Same sums in the same order as below, from the compact arrays
+        const CompactState& state = compactState;
+        for (size_t i = 0; i < state.pointFlags.size(); i++) {
+            const float* v = &state.velocity[i * 2];
+            energy += 0.5f * state.masses[state.pointMaterial[i]] * (v[0] * v[0] + v[1] * v[1]);
+        }
+        for (size_t s = 0; s < state.restLength.size(); s++) {
+            if (state.springBroken[s]) continue;
+            const float* p1 = &state.position[state.springEnds[s * 2] * 2];
+            const float* p2 = &state.position[state.springEnds[s * 2 + 1] * 2];
+            float dx = p2[0] - p1[0];
+            float dy = p2[1] - p1[1];
+            float stretch = std::sqrt(dx * dx + dy * dy) / state.restLength[s];
+            const SpringMaterial& spring = state.materials[state.springMaterial[s]];
+            const MaterialModel& material = materials[std::min((int)spring.family, FAMILY_COUNT - 1)];
+            energy += spring.stiffness * state.restLength[s] * material.Energy(stretch);
+        }
+        return energy;
+    }
+    for (const auto& point : points) {
+        energy += 0.5f * point.mass * (point.vx * point.vx + point.vy * point.vy);
+    }
+    for (const auto& spring : springs) {
+        if (spring.broken) continue;
+        const PointMass& p1 = points[spring.point1];
+        const PointMass& p2 = points[spring.point2];
+        float dx = p2.x - p1.x;
+        float dy = p2.y - p1.y;
+        float stretch = std::sqrt(dx * dx + dy * dy) / spring.restLength;
+        const MaterialModel& material = materials[std::min((int)spring.family, FAMILY_COUNT - 1)];
+        energy += spring.stiffness * spring.restLength * material.Energy(stretch);
+    }
+    return energy;
 }
\ No newline at end of file
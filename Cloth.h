@@ -1,7 +1,20 @@
 #pragma once
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <vector>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <string>
+#include "MeshLoader.h"
+#include "TaskScheduler.h"
+#include "DirtyTiles.h"
+#include "Aerodynamics.h"
+#include "MaterialCurves.h"
+#include "ClothKernels.h"
+
+struct DrawList;
 
 struct PointMass {
     float x, y;         // Position
@@ -14,31 +27,104 @@ struct PointMass {
     float renderX, renderY; // Interpolated position for rendering
 };
 
+// Springs are grouped by role; each family has its own material curve
+enum SpringFamily : unsigned char { FAMILY_STRUCTURAL, FAMILY_SHEAR, FAMILY_BENDING, FAMILY_COUNT };
+
 struct Spring {
     int point1, point2; // Indices of connected point masses
     float restLength;
     float stiffness;
     float damping;
     bool broken;        // New: track if spring is broken
+    unsigned char family;  // SpringFamily, in what was padding
     float maxStretch;   // New: maximum stretch ratio before breaking
     int stressFrames;   // Track consecutive high-stress frames
-    static const int STRESS_THRESHOLD = 30; // Frames before breaking
+    static const int STRESS_THRESHOLD = ClothKernels::STRESS_FRAMES; // Frames before breaking
     float getBreakThreshold() const {
-        return (point2 - point1 == 1) ? 30.5f : 20.8f; // Higher threshold for structural springs
+        // Higher threshold for structural springs
+        return (point2 - point1 == 1) ? ClothKernels::STRUCTURAL_MAX_STRETCH : ClothKernels::OTHER_MAX_STRETCH;
     }
 };
 
+// Point and spring state saved for rollback when a step diverges
+struct StateSnapshot {
+    std::vector<float> pointState;          // x, y, vx, vy per point
+    std::vector<unsigned char> springBroken;
+    std::vector<int> springStress;
+    std::vector<float> springPeak;          // Hysteresis peaks, empty while they are released
+    float kineticEnergy;
+    float time;            // Simulated time, so time-varying fields replay identically
+    int topologyVersion;   // Snapshots from before a vertex split cannot be restored
+};
+
 struct Face {
     int p1, p2, p3;  // Indices of three points forming a triangle
 };
 
+// Spring parameters that are nearly always shared; compact storage keeps an index
+struct SpringMaterial {
+    float stiffness, damping, maxStretch;
+    unsigned char family;
+};
+
+// Storage of a parked cloth. Positions and velocities stay exact, so stepping
+// resumes where it stopped; interpolation positions become 16-bit offsets from
+// a per-tile origin, stress counters saturate at 255, masses and spring
+// parameters become indices into shared tables and force scratch is dropped.
+struct CompactState {
+    static constexpr int TILE_POINTS = 64;  // Consecutive points sharing one origin
+    std::vector<float> position, velocity;  // x, y per point
+    std::vector<float> tileOrigin;          // Per tile: origin x, y and step x, y
+    std::vector<uint16_t> prevOffset, renderOffset;  // x, y per point, in tile steps
+    std::vector<uint8_t> pointMaterial;     // Index into masses
+    std::vector<uint8_t> pointFlags;        // 1 fixed, 2 dragged
+    std::vector<float> masses;
+    std::vector<int> springEnds;            // point1, point2 per spring
+    std::vector<float> restLength;
+    std::vector<uint8_t> springMaterial;    // Index into materials
+    std::vector<uint8_t> springStress;      // Saturating stress frames
+    std::vector<uint8_t> springBroken;
+    std::vector<SpringMaterial> materials;
+    size_t pointCapacity;                   // Reserved again on expand, for tearing
+};
+
+// A cloth's arrays and settings as flat memory, as written to and mapped from
+// scene files. Forces are in the internal units, not the 0-1 slider values.
+struct ClothData {
+    int width, height;
+    bool isMesh;                  // Points are a triangle mesh in one row, not a width x height grid
+    float spacing;
+    float originX, originY;
+    float gravityForce, springStiffness, springDamping;
+    int renderDetail;
+    bool showWires;
+    AeroSettings aero;
+    int pointCount, springCount, faceCount;
+    const PointMass* points;      // Pins are the isFixed flags
+    const Spring* springs;
+    const Face* faces;
+    const int* faceEdgeSprings;   // 3 per face, as built by the tearing setup
+};
+
+// External force that stays registered across steps and is applied in every
+// substep's force pass: constant + gust * sin(frequency * t + phase), plus an
+// optional per-point term. Like AddForce it skips fixed and dragged points.
+struct ForceField {
+    float fx, fy;                 // Constant part
+    float gustX, gustY;           // Amplitude of the sinusoidal part
+    float frequency, phase;       // Radians per second, radians
+    std::vector<float> perPoint;  // Optional fx, fy pairs by point index; points past the end get none
+};
+
 class Cloth {
 private:
     std::vector<PointMass> points;
     std::vector<Spring> springs;
     std::vector<Face> faces;
     int width, height;
+    bool isMesh;             // Loaded from a triangle mesh: width points addressed as one row, no grid
     float spacing;
+    float originX, originY;  // Top-left of the rest grid; mesh cloths add it to the loaded coordinates
     int draggedPoint;   // Index of the point being dragged
     float mouseX, mouseY; // Current mouse position
     float gravityForce;
@@ -46,35 +132,252 @@ private:
     float springDamping;
     bool showWires;
     float accumulator;     // Time accumulator for interpolation
+    std::vector<float> restPositions;  // Mesh cloths: x,y pairs restored by Reset
+    std::vector<int> meshToPoint;      // Mesh cloths: file vertex index -> point index
+
+    // Stability monitor
+    static constexpr int SNAPSHOT_COUNT = 4;        // Ring of recent frame states
+    static constexpr int MAX_SUBSTEPS = 16;
+    static constexpr int STABLE_FRAMES_TO_RELAX = 120; // Stable frames before halving substeps
+    StateSnapshot snapshots[SNAPSHOT_COUNT];
+    int topologyVersion;    // Bumped whenever tearing splits a vertex
+    int snapshotHead;       // Slot holding the most recent snapshot
+    int snapshotCount;      // Valid snapshots in the ring
+    int substeps;           // Current substeps per Update
+    int minSubsteps;        // Floor the monitor relaxes back to
+    int selfCollisionInterval;  // Substeps per self-collision pass
+    int selfCollisionPhase;
+    int stableFrames;
+    int rollbackCount;
+    float kineticEnergy;    // Accumulated by UpdatePositions
+    float springEnergy;     // Accumulated by ApplySpringForces
+    float lastKineticEnergy;
+    int clampedPoints;      // Points that hit the velocity clamp this step
+
+    // External forces
+    std::vector<ForceField> forceFields;
+    std::vector<unsigned char> forceFieldActive;  // Removed ids stay as inactive slots
+    float pendingForceX, pendingForceY;  // AddForce total, consumed by the next substep
+    float simTime;                       // Simulated seconds since construction or Reset
+
+    // Per-face aerodynamics
+    static constexpr int AERO_BATCH = 64;  // Faces gathered into one SoA batch
+    AeroSettings aero;
+    TurbulenceField turbulence;
+
+    // Parallel point sweeps
+    enum Phase {
+        PHASE_STORE, PHASE_FORCES, PHASE_COLLISIONS, PHASE_POSITIONS, PHASE_INTERPOLATION, PHASE_DETAIL,
+        PHASE_SPRINGS, PHASE_GATHER, PHASE_BREAKING, PHASE_SELF_COLLISIONS, PHASE_COUNT
+    };
+    static constexpr int POINT_CHUNK = 16384 / sizeof(PointMass); // Points per chunk (~16 KiB)
+    TaskScheduler* scheduler;     // Null runs every phase inline
+    PhaseTuning phaseTuning[PHASE_COUNT];
+    std::vector<float> chunkEnergy;  // Per-chunk kinetic energy, summed in chunk order
+    std::vector<int> chunkClamped;
+
+    // Deterministic mode: every pass that used to scatter or resolve in place
+    // runs as fixed-size chunks whose results are combined in a fixed order,
+    // so the state after a step does not depend on the thread count
+    static constexpr int SPRING_CHUNK = 16384 / sizeof(Spring);
+    static constexpr int COLLISION_ROWS = 64;  // Points per self-collision detection chunk
+    bool deterministic;
+    std::vector<float> springForce;        // fx, fy per spring, added to point1 and taken from point2
+    std::vector<float> chunkSpringEnergy;  // Per material pass chunk, summed in pass and chunk order
+    std::vector<unsigned char> springBreaks;  // Per spring: breaks this substep
+    std::vector<std::vector<int>> chunkPairs; // Per collision chunk: close (i, j) pairs in order
+
+    // Projective dynamics: springs become a constant implicit system that is
+    // Cholesky-factored once and reused until pins, springs or the step change
+    bool projective;
+    int projectiveIterations;
+    bool pdFactored;                      // Cleared when springs break, stiffness or materials change or state is restored
+    float pdStep;                         // Substep length the factor was built for
+    float pdSlope[FAMILY_COUNT];          // Per family: the material's slope at rest when factored
+    int pdTopologyVersion;
+    int factorizationCount;
+    std::vector<unsigned char> pdPinned;  // Per point: fixed or dragged when factored
+    std::vector<int> pdRow;               // Point -> row of the system, -1 if pinned
+    std::vector<int> pdPoint;             // Row -> point
+    std::vector<int> pdFirst;             // First column of each row's envelope
+    std::vector<size_t> pdOffset;         // Start of each row in pdFactor; the row ends at its diagonal
+    std::vector<double> pdFactor;         // Lower triangular Cholesky factor, row envelopes
+    std::vector<double> pdRhsX, pdRhsY;
+    std::vector<float> pdInertia;         // 4 per point: inertial target x, y, then start x, y
+    std::vector<float> pdProjection;      // x, y per spring: nearest rest-length (p2 - p1)
+    std::vector<float> chunkPdEnergy;     // Per spring chunk, summed in chunk order
+
+    // Material curves: springs are listed per distinct curve so each pass is
+    // instantiated for its curve and dispatched once; families with the same
+    // curve share a pass, which keeps the default cloth at one sweep
+    MaterialModel materials[FAMILY_COUNT];
+    std::vector<int> passSprings[FAMILY_COUNT];  // Spring indices in index order; empty for a single pass
+    int passFamily[FAMILY_COUNT];                // Family whose curve the pass uses
+    int passCount;
+    std::vector<float> springPeak;                 // Per spring: hysteresis peak stretch
+
+    // Compact storage: points, springs, snapshots and solver scratch are
+    // released while the cloth is parked in compactState
+    bool compact;
+    CompactState compactState;
+
+    // Tearing topology; every array is sized for the worst case up front so
+    // splitting vertices never reallocates mid-frame
+    std::vector<int> faceEdgeSpring;   // 3 per face: spring along edge (corner i, corner i+1), -1 if none
+    std::vector<int> cornerNext;       // 3 per face: next corner around the same point, -1 at end
+    std::vector<int> firstCorner;      // Per point: head of its corner list
+    std::vector<int> springEndNext;    // 2 per spring: next spring end at the same point
+    std::vector<int> firstSpringEnd;   // Per point: head of its spring-end list
+    std::vector<int> fanFaces;         // Scratch for SplitVertex
+    std::vector<int> fanLabels;
+    std::vector<Face> initialFaces;    // Topology restored by Reset
+    std::vector<int> initialSpringEnds;
+    std::vector<float> initialMasses;  // Splits share a point's mass between its copies
+    int initialPointCount;
+
+    // Render level of detail: grid cloths can draw a Catmull-Rom surface
+    // through the simulated points with renderDetail^2 fine cells per cell
+    static constexpr int MAX_RENDER_DETAIL = 16;
+    static constexpr int DETAIL_ROW_CHUNK = 8;  // Fine rows per parallel chunk
+    int renderDetail;                    // 1 draws the simulated faces
+    int detailWidth, detailHeight;       // Fine vertices per row and column
+    std::vector<int> detailColumnIndex;  // 4 coarse columns per fine column, clamped at the edges
+    std::vector<float> detailColumnWeight;
+    std::vector<int> detailRowIndex;     // 4 coarse rows per fine row
+    std::vector<float> detailRowWeight;
+    std::vector<float> detailRowPassX, detailRowPassY;  // Coarse rows already interpolated along x
+    std::vector<float> detailX, detailY;                // Fine render positions
+    std::vector<float> drawnDetail;      // Fine positions (x,y pairs) as last reported to MarkDirtyTiles
+    std::vector<unsigned char> cellRefined;  // Per coarse cell: draw fine, away from any tear
+    int detailTopologyVersion;           // Topology cellRefined was built for
+
+    // Dirty-tile tracking
+    static constexpr float DRAW_PADDING = 4.0f;  // Point markers (radius 3) and 2 px spring pens
+    static constexpr uint32_t UNDRAWN_SPRING = 0xFFFFFFFF;  // Broken springs are not drawn
+    std::vector<float> drawnPositions;  // Render positions (x,y pairs) as last reported to MarkDirtyTiles
+    std::vector<unsigned char> drawnFaceShade;  // Per face: stretch shade as last reported
+    std::vector<uint32_t> drawnSpringColor;     // Per spring: tension color as last reported; empty without wires
+    std::vector<unsigned char> drawnPointState; // Per point: 0 free, 1 fixed, 2 dragged; empty without wires
 
     void InitializeSprings();
     void InitializeFaces();
-    void ApplySpringForces();
-    void ApplyGravity();
+    void InitializeMeshSprings();
+    void ApplySpringForces(float dt);  // dt scales hysteresis retention to the step
+    void GatherSpringForces(float dt);
+    void ComputeSpringForces(float dt);  // Deterministic: fills springForce and springEnergy
+    void InitializeMaterials();
+    void BuildMaterialPasses();
+    template <typename Response>
+    void ApplyPassForces(Response response, int pass);  // By value: kept in registers
+    template <typename Response>
+    void ComputePassForces(Response response, int pass, int firstChunk);
+    int GetPassSize(int pass) const {
+        return passCount == 1 ? (int)springs.size() : (int)passSprings[pass].size();
+    }
+    void SolveProjective(float dt);
+    void FactorProjective(float dt);
+    bool ProjectivePinsChanged() const;
+    void CheckSpringBreakingOrdered();
+    void HandleSelfCollisionsOrdered();
+    void ApplyGravity(int begin, int end);
+    void ApplyForceFields(float uniformX, float uniformY, int begin, int end);
+    void ApplyAerodynamics();
+    void StorePreviousPositions();
+    void AdvanceFrame(float dt);
     void UpdatePositions(float dt);
-    void HandleCollisions();
+    void IntegratePoints(float dt, int begin, int end);
+    void Simulate(float dt);
+    void InitializeStability();
+    void ReserveSnapshots();
+    void ReleaseScratch();
+    void SaveSnapshot();
+    void RestoreSnapshot(int age);
+    bool IsDiverging() const;
+    void HandleCollisions(int begin, int end);
+#ifdef _WIN32
     void DrawSpring(HDC hdc, const Spring& spring, const PointMass& p1, const PointMass& p2);
     void DrawFace(HDC hdc, const Face& face);
+#endif
     void HandleSelfCollisions();  // New: self-collision detection
-    float GetNonlinearForce(float stretch) const;  // New: non-linear spring force
     void CheckSpringBreaking();  // New: check for spring breaks
+    void InitializeTearing(const int* edgeSprings = nullptr);  // Precomputed faceEdgeSpring, if any
+    // Points the cloth can reach by tearing: every face corner split off, plus points on no face
+    static size_t TearingCapacity(int pointCount, const Face* faces, int faceCount);
+    void MatchFaceEdgeSprings();
+    void RestoreTopology();
+    void SplitVertex(int vertex);
+    void LinkCorner(int corner, int vertex);
+    void LinkSpringEnd(int end, int vertex);
     bool CheckPointProximity(const PointMass& p1, const PointMass& p2) const;
     void ResetSpringStress(Spring& spring);
     void UpdateSpringStress(Spring& spring, float stretch);
+#ifdef _WIN32
     COLORREF GetFaceColor(const Face& face) const;
+#endif
     void UpdateInterpolation(float alpha);
+    void InitializeDetail();
+    void UpdateDetail();
+    void UpdateRefinedCells();
+    void MarkDetailTiles(DirtyTileMap& tiles);
+    void AppendDetailCell(DrawList& list, int cellX, int cellY) const;
+#ifdef _WIN32
+    void DrawDetailCell(HDC hdc, int cellX, int cellY, const DirtyTileMap* dirty);
+    void FillTriangle(HDC hdc, const POINT* corners, COLORREF color);
+    COLORREF GetStretchColor(float stretch) const;
+#endif
+
+    template <typename Body>
+    void RunPhase(Phase phase, int count, int chunk, const Body& body) {
+        if (scheduler) {
+            scheduler->ParallelFor(count, chunk, phaseTuning[phase], body);
+        } else {
+            body(0, count);
+        }
+    }
+
+    template <typename Body>
+    void RunPointPhase(Phase phase, const Body& body) {
+        RunPhase(phase, (int)points.size(), POINT_CHUNK, body);
+    }
 
 public:
     Cloth(int width, int height, float spacing);
+    Cloth(const TriangleMesh& mesh, float scale = 1.0f);
+    explicit Cloth(const ClothData& data);  // Copies each array in one block, nothing is rebuilt
     ~Cloth();
 
     void Update(float dt, float alpha = 1.0f);
-    void Draw(HDC hdc);
-    void AddForce(float fx, float fy);
+    // Advance steps frames of dt in one call; render positions are left for Update(0, alpha)
+    void Step(int steps, float dt);
+#ifdef _WIN32
+    void Draw(HDC hdc, const DirtyTileMap* dirty = nullptr);  // Skips geometry outside dirty tiles
+#endif
+    // Appends what Draw would paint this frame, for the software renderer
+    void AppendDrawList(DrawList& list);
+    static int GetStretchShade(float stretch);  // Gray level of a face, shared with GetFaceColor
+    static uint32_t GetTensionColor(float stretch, float maxStretch);  // 0x00RRGGBB spring pen
+    // Mark tiles covered by anything that moved since the last call, old and new footprint
+    void MarkDirtyTiles(DirtyTileMap& tiles);
+    void AddForce(float fx, float fy);  // One-shot, applied during the next frame
+    int AddForceField(const ForceField& field);  // Returns an id for RemoveForceField
+    void RemoveForceField(int id);
+    void ClearForceFields();
+    float GetTime() const { return simTime; }
+    // Grid cloths only: draw factor x factor Catmull-Rom cells per simulated cell
+    void SetRenderDetail(int factor);
+    int GetRenderDetail() const { return renderDetail; }
+    int GetDetailWidth() const { return detailWidth; }
+    int GetDetailHeight() const { return detailHeight; }
+    const std::vector<float>& GetDetailX() const { return detailX; }  // Row-major, as of the last Update
+    const std::vector<float>& GetDetailY() const { return detailY; }
+    void SetAerodynamics(const AeroSettings& settings) { aero = settings; }
+    const AeroSettings& GetAerodynamics() const { return aero; }
     void FixPoint(int x, int y);
+    void SetOrigin(float x, float y);  // Moves the whole cloth; Reset and SetResolution keep it
     void HandleMouseDown(int x, int y);
     void HandleMouseMove(int x, int y);
     void HandleMouseUp();
+    bool IsDragging() const { return draggedPoint != -1; }
     void SetMaxStretch(float ratio);  // New: set max stretch ratio
     void SetGravity(float g);
     void SetStiffness(float s);
@@ -82,6 +385,74 @@ public:
     void Reset();
     void SetWireVisibility(bool visible) { showWires = visible; }
     bool GetWireVisibility() const { return showWires; }
+    static constexpr float GRID_EXTENT = 400.0f;  // Width of the grids SetResolution and CreateWithResolution build
     void SetResolution(int newWidth, int newHeight);
     static Cloth* CreateWithResolution(int resolution);
+    bool IsDefaultGrid() const;  // Square grid as CreateWithResolution builds it, so SetResolution keeps its size
+    static float GetNonlinearForce(float stretch);   // Non-linear spring force, the default curve
+    static float GetNonlinearEnergy(float stretch);  // Integral of GetNonlinearForce from rest
+    // Response curve of one spring family; hysteresis state restarts at rest
+    void SetMaterial(SpringFamily family, const MaterialModel& model);
+    const MaterialModel& GetMaterial(SpringFamily family) const { return materials[family]; }
+
+    // Headless metrics
+    int GetBrokenSpringCount() const;
+    float GetMaxStrain() const;   // Largest stretch ratio over intact springs
+    float GetEnergy() const;      // Kinetic + spring + gravitational potential
+    float GetElasticEnergy() const;  // Kinetic + spring, without gravity
+    float GetGravityForce() const { return gravityForce; }  // Acceleration towards +y
+    float GetKineticEnergy() const { return kineticEnergy; }  // As of the last step
+    float GetSpringEnergy() const { return springEnergy; }    // As of the last step
+    int GetSubsteps() const { return substeps; }
+    void SetMinSubsteps(int count);
+    int GetMinSubsteps() const { return minSubsteps; }
+    void SetSelfCollisionInterval(int steps);  // Self-collide every n-th substep
+    int GetSelfCollisionInterval() const { return selfCollisionInterval; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    float GetSpacing() const { return spacing; }
+    bool IsMesh() const { return isMesh; }  // Grid queries and SetResolution do not apply to meshes
+    int GetRollbackCount() const { return rollbackCount; }
+    void SetScheduler(TaskScheduler* pool) { scheduler = pool; }
+    // Bit-identical results for any thread count, at some cost in throughput
+    void SetDeterministic(bool enabled) { deterministic = enabled; }
+    bool IsDeterministic() const { return deterministic; }
+    unsigned long long GetStateHash() const;  // FNV-1a over point state and broken springs
+    // Implicit springs with a prefactored matrix; stiff cloths stay stable at one substep.
+    // Each family's springs are linearised at the slope of its material at rest
+    void SetProjective(bool enabled);
+    bool IsProjective() const { return projective; }
+    void SetProjectiveIterations(int count);  // Local/global rounds per substep
+    int GetFactorizationCount() const { return factorizationCount; }
+    // Parks the cloth in compact storage; false if it has more than 256 distinct
+    // masses or spring materials, in which case it is left as it is. Every
+    // non-const call that touches points or springs expands it again, and the
+    // headless metrics and GetStateHash read the parked arrays directly. The
+    // const views GetPoints, GetSprings, GetFaceStretch and GetData need an
+    // expanded cloth, so Expand before taking them.
+    bool Compact();
+    void Expand();
+    bool IsCompact() const { return compact; }
+    size_t GetStateBytes() const;  // Point, spring, snapshot and solver storage currently held
+    static Cloth* CreateFromMesh(const std::string& path, float scale = 1.0f);
+    void FixMeshVertex(int vertex);
+
+    // Read-only views for publishers and offline tools
+    const std::vector<PointMass>& GetPoints() const {
+        assert(!compact);
+        return points;
+    }
+    const std::vector<Spring>& GetSprings() const {
+        assert(!compact);
+        return springs;
+    }
+    const std::vector<Face>& GetFaces() const { return faces; }
+    size_t GetPointCapacity() const { return points.capacity(); }  // Upper bound once tearing has split every corner
+    float GetFaceStretch(const Face& face) const;  // Face area over rest area
+    ClothData GetData() const;  // Views into this cloth's arrays, valid until it changes
+    // Direct point access for scene-level contacts between cloths
+    PointMass* GetPointData() {
+        if (compact) Expand();
+        return points.data();
+    }
 };
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "ClothApi.h"
+#include "Cloth.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+// The same spring-mass model as Cloth's default path (gravity, nonlinear
+// damped springs, stress-based breaking, bounds with restitution and
+// friction, damped and clamped integration), run directly on the caller's
+// interleaved buffers through the kernels Cloth uses. There is no
+// self-collision, and broken springs stop pulling but vertices are not
+// split, since the caller's buffers cannot grow. ClothApiTest checks the
+// two stay identical.
+
+struct ClothHandle {
+    int width, height, pointCount, springCount;
+    float* positions;
+    float* velocities;
+    uint8_t* flags;
+    ClothParams params;
+
+    // Springs as parallel arrays, allocated once by ClothCreate
+    int32_t* ends;           // point1, point2 per spring
+    float* restLength;
+    unsigned char* shear;    // Diagonals use half stiffness and 0.75 damping
+    float* maxStretch;
+    int32_t* stressFrames;
+    uint8_t* broken;
+    float* forces;           // Interleaved fx, fy scratch
+    int32_t brokenCount;
+};
+
+namespace {
+
+// Sizes of the version 1 structs; callers built against newer headers send more
+const uint32_t MIN_DESC_SIZE = offsetof(ClothDesc, flags) + sizeof(uint8_t*);
+const uint32_t MIN_PARAMS_SIZE = offsetof(ClothParams, tearing) + sizeof(int32_t);
+
+// Overlays the caller's prefix of a versioned struct on target, which holds
+// the defaults for the fields an older caller does not know about
+template <typename Struct>
+bool CopyVersioned(const Struct& source, uint32_t minimumSize, Struct& target) {
+    uint32_t size = source.structSize;
+    if (size < minimumSize || size > sizeof(Struct)) return false;
+    std::memcpy(&target, &source, size);
+    target.structSize = sizeof(Struct);
+    return true;
+}
+
+bool Aligned(const void* buffer) {
+    return buffer && reinterpret_cast<uintptr_t>(buffer) % CLOTH_BUFFER_ALIGNMENT == 0;
+}
+
+void FreeArrays(ClothHandle* cloth) {
+    delete[] cloth->ends;
+    delete[] cloth->restLength;
+    delete[] cloth->shear;
+    delete[] cloth->maxStretch;
+    delete[] cloth->stressFrames;
+    delete[] cloth->broken;
+    delete[] cloth->forces;
+}
+
+void AddSpring(ClothHandle* cloth, int& s, int a, int b, float rest, bool shear) {
+    cloth->ends[s * 2] = a;
+    cloth->ends[s * 2 + 1] = b;
+    cloth->restLength[s] = rest;
+    cloth->shear[s] = shear;
+    // Same thresholds as Spring::getBreakThreshold
+    cloth->maxStretch[s] = (b - a == 1) ? ClothKernels::STRUCTURAL_MAX_STRETCH : ClothKernels::OTHER_MAX_STRETCH;
+    cloth->stressFrames[s] = 0;
+    cloth->broken[s] = 0;
+    s++;
+}
+
+void Substep(ClothHandle* cloth, float dt) {
+    const ClothParams& params = cloth->params;
+    float* x = cloth->positions;
+    float* v = cloth->velocities;
+    const uint8_t* flags = cloth->flags;
+    float* f = cloth->forces;
+    int n = cloth->pointCount;
+
+    for (int i = 0; i < n; i++) {
+        f[i * 2] = 0.0f;
+        f[i * 2 + 1] = (flags[i] & CLOTH_FLAG_PINNED) ? 0.0f : params.gravity;
+    }
+
+    for (int s = 0; s < cloth->springCount; s++) {
+        if (cloth->broken[s]) continue;
+        int a = cloth->ends[s * 2];
+        int b = cloth->ends[s * 2 + 1];
+        float dx = x[b * 2] - x[a * 2];
+        float dy = x[b * 2 + 1] - x[a * 2 + 1];
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < ClothKernels::MIN_SPRING_LENGTH) continue;
+
+        float stiffness = cloth->shear[s] ? params.stiffness * ClothKernels::SHEAR_STIFFNESS_RATIO : params.stiffness;
+        float damping = cloth->shear[s] ? params.damping * ClothKernels::SHEAR_DAMPING_RATIO : params.damping;
+        float force = stiffness * Cloth::GetNonlinearForce(length / cloth->restLength[s]);
+        float fx, fy;
+        ClothKernels::SpringForce(dx, dy, length, v[b * 2] - v[a * 2], v[b * 2 + 1] - v[a * 2 + 1], force, damping,
+                                  fx, fy);
+        f[a * 2] += fx;
+        f[a * 2 + 1] += fy;
+        f[b * 2] -= fx;
+        f[b * 2 + 1] -= fy;
+    }
+
+    if (params.tearing) {
+        for (int s = 0; s < cloth->springCount; s++) {
+            if (cloth->broken[s]) continue;
+            int a = cloth->ends[s * 2];
+            int b = cloth->ends[s * 2 + 1];
+            float dx = x[b * 2] - x[a * 2];
+            float dy = x[b * 2 + 1] - x[a * 2 + 1];
+            float stretch = std::sqrt(dx * dx + dy * dy) / cloth->restLength[s];
+
+            cloth->stressFrames[s] = ClothKernels::UpdateStress(cloth->stressFrames[s], stretch, cloth->maxStretch[s]);
+            if (ClothKernels::ShouldBreak(stretch, cloth->maxStretch[s], cloth->stressFrames[s])) {
+                cloth->broken[s] = 1;
+                cloth->brokenCount++;
+            }
+        }
+    }
+
+    ClothKernels::Bounds bounds = {params.boundsLeft, params.boundsTop, params.boundsRight, params.boundsBottom,
+                                   params.restitution, params.friction};
+    float damping = ClothKernels::StepDamping(params.velocityDamping, dt);
+    for (int i = 0; i < n; i++) {
+        if (flags[i] & CLOTH_FLAG_PINNED) continue;
+        bool clamped = false;
+        ClothKernels::CollideBounds(bounds, x[i * 2], x[i * 2 + 1], v[i * 2], v[i * 2 + 1]);
+        ClothKernels::IntegratePoint(x[i * 2], x[i * 2 + 1], v[i * 2], v[i * 2 + 1], f[i * 2], f[i * 2 + 1], dt,
+                                     damping, params.maxVelocity, clamped);
+    }
+}
+
+} // namespace
+
+int ClothApiVersion(void) {
+    return CLOTH_API_VERSION;
+}
+
+void ClothDefaultParams(ClothParams* params) {
+    if (!params) return;
+    params->structSize = sizeof(ClothParams);
+    params->gravity = ClothKernels::DEFAULT_GRAVITY;
+    params->stiffness = ClothKernels::DEFAULT_STIFFNESS;
+    params->damping = ClothKernels::DEFAULT_DAMPING;
+    params->velocityDamping = ClothKernels::VELOCITY_DAMPING;
+    params->maxVelocity = ClothKernels::MAX_VELOCITY;
+    params->boundsLeft = ClothKernels::WINDOW_BOUNDS.left;
+    params->boundsTop = ClothKernels::WINDOW_BOUNDS.top;
+    params->boundsRight = ClothKernels::WINDOW_BOUNDS.right;
+    params->boundsBottom = ClothKernels::WINDOW_BOUNDS.bottom;
+    params->restitution = ClothKernels::WINDOW_BOUNDS.restitution;
+    params->friction = ClothKernels::WINDOW_BOUNDS.friction;
+    params->substeps = 1;
+    params->tearing = 1;
+}
+
+ClothStatus ClothCreate(const ClothDesc* callerDesc, float originX, float originY, ClothHandle** cloth) {
+    ClothDesc copy = ClothDesc();
+    if (!callerDesc || !cloth || !CopyVersioned(*callerDesc, MIN_DESC_SIZE, copy)) return CLOTH_ERROR_ARGUMENT;
+    const ClothDesc* desc = &copy;
+    if (desc->width < 2 || desc->height < 2 || !(desc->spacing > 0.0f)) return CLOTH_ERROR_ARGUMENT;
+    if (!desc->positions || !desc->velocities || !desc->flags) return CLOTH_ERROR_ARGUMENT;
+    if (!Aligned(desc->positions) || !Aligned(desc->velocities) || !Aligned(desc->flags)) return CLOTH_ERROR_ALIGNMENT;
+
+    ClothHandle* handle = new (std::nothrow) ClothHandle();
+    if (!handle) return CLOTH_ERROR_MEMORY;
+    int width = desc->width;
+    int height = desc->height;
+    int n = width * height;
+    int springs = (width - 1) * height + width * (height - 1) + 2 * (width - 1) * (height - 1);
+    handle->width = width;
+    handle->height = height;
+    handle->pointCount = n;
+    handle->springCount = springs;
+    handle->positions = desc->positions;
+    handle->velocities = desc->velocities;
+    handle->flags = desc->flags;
+    ClothDefaultParams(&handle->params);
+
+    handle->ends = new (std::nothrow) int32_t[springs * 2];
+    handle->restLength = new (std::nothrow) float[springs];
+    handle->shear = new (std::nothrow) unsigned char[springs];
+    handle->maxStretch = new (std::nothrow) float[springs];
+    handle->stressFrames = new (std::nothrow) int32_t[springs];
+    handle->broken = new (std::nothrow) uint8_t[springs];
+    handle->forces = new (std::nothrow) float[n * 2];
+    if (!handle->ends || !handle->restLength || !handle->shear || !handle->maxStretch ||
+        !handle->stressFrames || !handle->broken || !handle->forces) {
+        FreeArrays(handle);
+        delete handle;
+        return CLOTH_ERROR_MEMORY;
+    }
+
+    // Spring order matches Cloth::InitializeSprings
+    float spacing = desc->spacing;
+    int s = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int current = y * width + x;
+            if (x < width - 1) AddSpring(handle, s, current, current + 1, spacing, false);
+            if (y < height - 1) AddSpring(handle, s, current, current + width, spacing, false);
+            if (x < width - 1 && y < height - 1) {
+                AddSpring(handle, s, current, current + width + 1, spacing * std::sqrt(2.0f), true);
+                AddSpring(handle, s, current + 1, current + width, spacing * std::sqrt(2.0f), true);
+            }
+        }
+    }
+    handle->brokenCount = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int i = y * width + x;
+            handle->positions[i * 2] = originX + x * spacing;
+            handle->positions[i * 2 + 1] = originY + y * spacing;
+            handle->velocities[i * 2] = 0.0f;
+            handle->velocities[i * 2 + 1] = 0.0f;
+            handle->flags[i] = 0;
+        }
+    }
+
+    *cloth = handle;
+    return CLOTH_OK;
+}
+
+void ClothDestroy(ClothHandle* cloth) {
+    if (!cloth) return;
+    FreeArrays(cloth);
+    delete cloth;
+}
+
+ClothStatus ClothBindBuffers(ClothHandle* cloth, float* positions, float* velocities, uint8_t* flags) {
+    if (!cloth || !positions || !velocities || !flags) return CLOTH_ERROR_ARGUMENT;
+    if (!Aligned(positions) || !Aligned(velocities) || !Aligned(flags)) return CLOTH_ERROR_ALIGNMENT;
+    cloth->positions = positions;
+    cloth->velocities = velocities;
+    cloth->flags = flags;
+    return CLOTH_OK;
+}
+
+ClothStatus ClothSetParams(ClothHandle* cloth, const ClothParams* callerParams) {
+    if (!cloth || !callerParams) return CLOTH_ERROR_ARGUMENT;
+    ClothParams params;
+    ClothDefaultParams(&params);
+    if (!CopyVersioned(*callerParams, MIN_PARAMS_SIZE, params)) return CLOTH_ERROR_ARGUMENT;
+    if (params.substeps < 1 || params.boundsLeft > params.boundsRight || params.boundsTop > params.boundsBottom) {
+        return CLOTH_ERROR_ARGUMENT;
+    }
+    cloth->params = params;
+    return CLOTH_OK;
+}
+
+ClothStatus ClothGetParams(const ClothHandle* cloth, ClothParams* params) {
+    if (!cloth || !params || params->structSize < MIN_PARAMS_SIZE) return CLOTH_ERROR_ARGUMENT;
+    // Never past the end of an older caller's struct
+    uint32_t size = std::min<uint32_t>(params->structSize, sizeof(ClothParams));
+    std::memcpy(params, &cloth->params, size);
+    params->structSize = size;
+    return CLOTH_OK;
+}
+
+ClothStatus ClothStep(ClothHandle* cloth, int32_t steps, float dt) {
+    if (!cloth || steps < 0 || !(dt >= 0.0f)) return CLOTH_ERROR_ARGUMENT;
+    float h = dt / cloth->params.substeps;
+    for (int32_t i = 0; i < steps; i++) {
+        for (int32_t sub = 0; sub < cloth->params.substeps; sub++) Substep(cloth, h);
+    }
+    return CLOTH_OK;
+}
+
+int32_t ClothGetPointCount(const ClothHandle* cloth) {
+    return cloth ? cloth->pointCount : 0;
+}
+
+int32_t ClothGetSpringCount(const ClothHandle* cloth) {
+    return cloth ? cloth->springCount : 0;
+}
+
+int32_t ClothGetBrokenSpringCount(const ClothHandle* cloth) {
+    return cloth ? cloth->brokenCount : 0;
+}
+
+const int32_t* ClothGetSpringEnds(const ClothHandle* cloth) {
+    return cloth ? cloth->ends : nullptr;
+}
+
+const uint8_t* ClothGetSpringBroken(const ClothHandle* cloth) {
+    return cloth ? cloth->broken : nullptr;
+}
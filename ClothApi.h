@@ -0,0 +1,106 @@
+#ifndef CLOTH_API_H
+#define CLOTH_API_H
+
+/* Embeddable C interface to the cloth solver. The caller owns the state:
+ * positions and velocities are interleaved x, y floats and flags are one
+ * byte per point, all CLOTH_BUFFER_ALIGNMENT aligned. The solver reads and
+ * writes those buffers in place during ClothStep and keeps no copy, so the
+ * caller can read them, move pinned points or flip flags between steps.
+ * Springs and scratch forces are allocated once by ClothCreate; no other
+ * call allocates. Only standard C headers are used. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(CLOTH_API_BUILD)
+#    define CLOTH_API __declspec(dllexport)
+#  else
+#    define CLOTH_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define CLOTH_API __attribute__((visibility("default")))
+#else
+#  define CLOTH_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOTH_API_VERSION 1
+#define CLOTH_BUFFER_ALIGNMENT 16
+
+typedef enum ClothStatus {
+    CLOTH_OK = 0,
+    CLOTH_ERROR_ARGUMENT = -1,   /* Null handle or buffer, bad size or count */
+    CLOTH_ERROR_ALIGNMENT = -2,  /* A buffer is not CLOTH_BUFFER_ALIGNMENT aligned */
+    CLOTH_ERROR_MEMORY = -3
+} ClothStatus;
+
+/* Point flags */
+#define CLOTH_FLAG_PINNED 0x01u  /* Not moved by the solver; the caller may move it */
+
+typedef struct ClothHandle ClothHandle;
+
+/* Versioned structs: set structSize to sizeof the struct you compiled
+ * against. Later versions only append fields; a struct from an older header
+ * is accepted down to the version 1 size, fields it lacks take their
+ * defaults, and ClothGetParams writes no more than structSize bytes. */
+
+/* Grid cloth over caller buffers */
+typedef struct ClothDesc {
+    uint32_t structSize;
+    int32_t width, height;  /* Points per side, at least 2 each */
+    float spacing;          /* Rest distance between neighbours */
+    float* positions;       /* 2 * width * height floats */
+    float* velocities;      /* 2 * width * height floats */
+    uint8_t* flags;         /* width * height bytes */
+} ClothDesc;
+
+/* Same units as the interactive simulation: pixels and seconds */
+typedef struct ClothParams {
+    uint32_t structSize;
+    float gravity;          /* Downward acceleration */
+    float stiffness;        /* Structural spring stiffness; shear springs get half */
+    float damping;          /* Spring damping along the spring */
+    float velocityDamping;  /* Velocity kept per 1/60 s, 0-1, whatever the substeps */
+    float maxVelocity;
+    float boundsLeft, boundsTop, boundsRight, boundsBottom;  /* Points are kept inside */
+    float restitution;      /* Velocity kept when bouncing off the bounds */
+    float friction;         /* Tangential velocity kept on contact */
+    int32_t substeps;
+    int32_t tearing;        /* Non-zero lets overstretched springs break */
+} ClothParams;
+
+CLOTH_API int ClothApiVersion(void);
+CLOTH_API void ClothDefaultParams(ClothParams* params);
+
+/* Writes the rest grid at (originX, originY) into the caller's buffers and
+ * clears velocities and flags; pin points afterwards through the flags. */
+CLOTH_API ClothStatus ClothCreate(const ClothDesc* desc, float originX, float originY, ClothHandle** cloth);
+CLOTH_API void ClothDestroy(ClothHandle* cloth);
+
+/* Point the solver at other buffers of the same size, e.g. to double-buffer */
+CLOTH_API ClothStatus ClothBindBuffers(ClothHandle* cloth, float* positions, float* velocities, uint8_t* flags);
+CLOTH_API ClothStatus ClothSetParams(ClothHandle* cloth, const ClothParams* params);
+/* Set params->structSize first; it is lowered to the bytes written if the
+ * caller's struct is larger than this version's */
+CLOTH_API ClothStatus ClothGetParams(const ClothHandle* cloth, ClothParams* params);
+
+/* Advances steps frames of dt seconds, each split into the set substeps */
+CLOTH_API ClothStatus ClothStep(ClothHandle* cloth, int32_t steps, float dt);
+
+CLOTH_API int32_t ClothGetPointCount(const ClothHandle* cloth);
+CLOTH_API int32_t ClothGetSpringCount(const ClothHandle* cloth);
+CLOTH_API int32_t ClothGetBrokenSpringCount(const ClothHandle* cloth);
+/* Spring end points as index pairs, valid for the lifetime of the handle */
+CLOTH_API const int32_t* ClothGetSpringEnds(const ClothHandle* cloth);
+/* One byte per spring, non-zero once broken; valid for the lifetime of the handle */
+CLOTH_API const uint8_t* ClothGetSpringBroken(const ClothHandle* cloth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOTH_API_H */
@@ -0,0 +1,232 @@
+#include "Cloth.h"
+#include <algorithm>
+
+// Compact storage. A parked cloth keeps only what stepping needs to resume:
+// exact positions and velocities, spring ends and rest lengths, and
+// everything else in the narrowest form that is good enough. Interpolation
+// positions are only used to draw the last frame, so they are quantized to
+// 16 bits per axis against the bounds of each tile of TILE_POINTS points.
+// Stress counters only matter up to the break threshold and saturate at 255.
+// Stiffness, damping and break ratio are set per cloth or per spring family,
+// so a cloth rarely has more than a handful of distinct triples.
+
+namespace {
+
+template <typename T>
+void Release(std::vector<T>& values) {
+    std::vector<T>().swap(values);
+}
+
+template <typename T>
+size_t Bytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// Index of value in table, appended if new; -1 once the table is full
+template <typename T, typename Equal>
+int FindOrAdd(std::vector<T>& table, const T& value, Equal equal) {
+    for (size_t i = 0; i < table.size(); i++) {
+        if (equal(table[i], value)) return (int)i;
+    }
+    if (table.size() >= 256) return -1;
+    table.push_back(value);
+    return (int)table.size() - 1;
+}
+
+uint16_t Quantize(float value, float origin, float step) {
+    float q = (value - origin) / step + 0.5f;
+    return (uint16_t)std::max(0.0f, std::min(65535.0f, q));
+}
+
+} // namespace
+
+void Cloth::ReleaseScratch() {
+    for (auto& snapshot : snapshots) {
+        Release(snapshot.pointState);
+        Release(snapshot.springBroken);
+        Release(snapshot.springStress);
+    }
+    snapshotCount = 0;
+    Release(chunkEnergy);
+    Release(chunkClamped);
+    Release(springForce);
+    Release(chunkSpringEnergy);
+    Release(springBreaks);
+    Release(chunkPairs);
+    Release(pdPinned);
+    Release(pdRow);
+    Release(pdPoint);
+    Release(pdFirst);
+    Release(pdOffset);
+    Release(pdFactor);
+    Release(pdRhsX);
+    Release(pdRhsY);
+    Release(pdInertia);
+    Release(pdProjection);
+    Release(chunkPdEnergy);
+    for (auto& list : passSprings) Release(list);
+    pdFactored = false;
+
+    // Peaks only move under a hysteretic curve; otherwise they are all at rest
+    bool hysteretic = false;
+    for (const auto& model : materials) hysteretic = hysteretic || model.hysteretic;
+    if (!hysteretic) Release(springPeak);
+}
+
+bool Cloth::Compact() {
+    if (compact) return true;
+    CompactState& state = compactState;
+    int count = (int)points.size();
+    int springCount = (int)springs.size();
+
+    // Build the tables first so a cloth that does not fit is left untouched
+    state.masses.clear();
+    state.materials.clear();
+    state.pointMaterial.resize(count);
+    state.springMaterial.resize(springCount);
+    for (int i = 0; i < count; i++) {
+        int index = FindOrAdd(state.masses, points[i].mass, [](float a, float b) { return a == b; });
+        if (index < 0) return false;
+        state.pointMaterial[i] = (uint8_t)index;
+    }
+    for (int s = 0; s < springCount; s++) {
+        SpringMaterial material = {springs[s].stiffness, springs[s].damping, springs[s].maxStretch, springs[s].family};
+        int index = FindOrAdd(state.materials, material, [](const SpringMaterial& a, const SpringMaterial& b) {
+            return a.stiffness == b.stiffness && a.damping == b.damping && a.maxStretch == b.maxStretch &&
+                   a.family == b.family;
+        });
+        if (index < 0) return false;
+        state.springMaterial[s] = (uint8_t)index;
+    }
+
+    state.position.resize(count * 2);
+    state.velocity.resize(count * 2);
+    state.pointFlags.resize(count);
+    for (int i = 0; i < count; i++) {
+        const PointMass& point = points[i];
+        state.position[i * 2] = point.x;
+        state.position[i * 2 + 1] = point.y;
+        state.velocity[i * 2] = point.vx;
+        state.velocity[i * 2 + 1] = point.vy;
+        state.pointFlags[i] = (point.isFixed ? 1 : 0) | (point.isDragged ? 2 : 0);
+    }
+
+    // Each tile's origin and step span the prev and render positions of its points
+    int tiles = (count + CompactState::TILE_POINTS - 1) / CompactState::TILE_POINTS;
+    state.tileOrigin.resize(tiles * 4);
+    state.prevOffset.resize(count * 2);
+    state.renderOffset.resize(count * 2);
+    for (int t = 0; t < tiles; t++) {
+        int begin = t * CompactState::TILE_POINTS;
+        int end = std::min(count, begin + CompactState::TILE_POINTS);
+        float minX = points[begin].prevX, maxX = minX;
+        float minY = points[begin].prevY, maxY = minY;
+        for (int i = begin; i < end; i++) {
+            minX = std::min(minX, std::min(points[i].prevX, points[i].renderX));
+            maxX = std::max(maxX, std::max(points[i].prevX, points[i].renderX));
+            minY = std::min(minY, std::min(points[i].prevY, points[i].renderY));
+            maxY = std::max(maxY, std::max(points[i].prevY, points[i].renderY));
+        }
+        float stepX = maxX > minX ? (maxX - minX) / 65535.0f : 1.0f;
+        float stepY = maxY > minY ? (maxY - minY) / 65535.0f : 1.0f;
+        float* origin = &state.tileOrigin[t * 4];
+        origin[0] = minX;
+        origin[1] = minY;
+        origin[2] = stepX;
+        origin[3] = stepY;
+        for (int i = begin; i < end; i++) {
+            state.prevOffset[i * 2] = Quantize(points[i].prevX, minX, stepX);
+            state.prevOffset[i * 2 + 1] = Quantize(points[i].prevY, minY, stepY);
+            state.renderOffset[i * 2] = Quantize(points[i].renderX, minX, stepX);
+            state.renderOffset[i * 2 + 1] = Quantize(points[i].renderY, minY, stepY);
+        }
+    }
+
+    state.springEnds.resize(springCount * 2);
+    state.restLength.resize(springCount);
+    state.springStress.resize(springCount);
+    state.springBroken.resize(springCount);
+    for (int s = 0; s < springCount; s++) {
+        const Spring& spring = springs[s];
+        state.springEnds[s * 2] = spring.point1;
+        state.springEnds[s * 2 + 1] = spring.point2;
+        state.restLength[s] = spring.restLength;
+        state.springStress[s] = (uint8_t)std::max(0, std::min(255, spring.stressFrames));
+        state.springBroken[s] = spring.broken ? 1 : 0;
+    }
+
+    state.pointCapacity = points.capacity();
+    Release(points);
+    Release(springs);
+    ReleaseScratch();
+    compact = true;
+    return true;
+}
+
+void Cloth::Expand() {
+    if (!compact) return;
+    CompactState& state = compactState;
+    int count = (int)state.pointFlags.size();
+    int springCount = (int)state.restLength.size();
+
+    // Same capacity as before, so tearing still never reallocates mid-frame
+    points.reserve(state.pointCapacity);
+    points.resize(count);
+    for (int i = 0; i < count; i++) {
+        PointMass& point = points[i];
+        const float* origin = &state.tileOrigin[(i / CompactState::TILE_POINTS) * 4];
+        point.x = state.position[i * 2];
+        point.y = state.position[i * 2 + 1];
+        point.vx = state.velocity[i * 2];
+        point.vy = state.velocity[i * 2 + 1];
+        point.fx = 0.0f;
+        point.fy = 0.0f;
+        point.mass = state.masses[state.pointMaterial[i]];
+        point.isFixed = (state.pointFlags[i] & 1) != 0;
+        point.isDragged = (state.pointFlags[i] & 2) != 0;
+        point.prevX = origin[0] + state.prevOffset[i * 2] * origin[2];
+        point.prevY = origin[1] + state.prevOffset[i * 2 + 1] * origin[3];
+        point.renderX = origin[0] + state.renderOffset[i * 2] * origin[2];
+        point.renderY = origin[1] + state.renderOffset[i * 2 + 1] * origin[3];
+    }
+
+    springs.resize(springCount);
+    for (int s = 0; s < springCount; s++) {
+        Spring& spring = springs[s];
+        const SpringMaterial& material = state.materials[state.springMaterial[s]];
+        spring.point1 = state.springEnds[s * 2];
+        spring.point2 = state.springEnds[s * 2 + 1];
+        spring.restLength = state.restLength[s];
+        spring.stiffness = material.stiffness;
+        spring.damping = material.damping;
+        spring.maxStretch = material.maxStretch;
+        spring.family = material.family;
+        spring.broken = state.springBroken[s] != 0;
+        spring.stressFrames = state.springStress[s];
+    }
+
+    state = CompactState();
+    compact = false;
+    ReserveSnapshots();
+    BuildMaterialPasses();
+    if (springPeak.size() != springs.size()) springPeak.assign(springs.size(), 1.0f);
+}
+
+size_t Cloth::GetStateBytes() const {
+    const CompactState& state = compactState;
+    size_t bytes = Bytes(points) + Bytes(springs);
+    for (const auto& snapshot : snapshots) {
+        bytes += Bytes(snapshot.pointState) + Bytes(snapshot.springBroken) + Bytes(snapshot.springStress);
+    }
+    bytes += Bytes(chunkEnergy) + Bytes(chunkClamped) + Bytes(springForce) + Bytes(chunkSpringEnergy) +
+             Bytes(springBreaks) + Bytes(pdPinned) + Bytes(pdRow) + Bytes(pdPoint) + Bytes(pdFirst) +
+             Bytes(pdOffset) + Bytes(pdFactor) + Bytes(pdRhsX) + Bytes(pdRhsY) + Bytes(pdInertia) +
+             Bytes(pdProjection) + Bytes(chunkPdEnergy) + Bytes(springPeak);
+    for (const auto& list : passSprings) bytes += Bytes(list);
+    bytes += Bytes(state.position) + Bytes(state.velocity) + Bytes(state.tileOrigin) +
+             Bytes(state.prevOffset) + Bytes(state.renderOffset) + Bytes(state.pointMaterial) +
+             Bytes(state.pointFlags) + Bytes(state.masses) + Bytes(state.springEnds) +
+             Bytes(state.restLength) + Bytes(state.springMaterial) + Bytes(state.springStress) +
+             Bytes(state.springBroken) + Bytes(state.materials);
+    return bytes;
+}
@@ -0,0 +1,236 @@
+#include "Cloth.h"
+#include "SoftRenderer.h"
+#include <algorithm>
+
+// Render level of detail: physics runs on the coarse grid while drawing uses
+// a Catmull-Rom surface through the render positions. Weights depend only on
+// the grid size and the detail factor, so they are built once; each frame is
+// then two separable passes of 4-tap weighted sums over flat arrays, first
+// along the coarse rows and then down the fine columns.
+
+namespace {
+
+// Catmull-Rom basis at t in [0, 1] for the points at -1, 0, 1, 2
+void CatmullRomWeights(float t, float* w) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+    w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+    w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+void BuildAxis(int coarse, int factor, std::vector<int>& index, std::vector<float>& weight) {
+    int fine = (coarse - 1) * factor + 1;
+    index.resize(fine * 4);
+    weight.resize(fine * 4);
+    for (int i = 0; i < fine; i++) {
+        int cell = std::min(i / factor, coarse - 2);
+        float t = (i - cell * factor) / (float)factor;
+        CatmullRomWeights(t, &weight[i * 4]);
+        for (int k = 0; k < 4; k++) {
+            index[i * 4 + k] = std::max(0, std::min(coarse - 1, cell - 1 + k));
+        }
+    }
+}
+
+} // namespace
+
+void Cloth::SetRenderDetail(int factor) {
+    if (compact) Expand();
+    renderDetail = std::max(1, std::min(MAX_RENDER_DETAIL, factor));
+    InitializeDetail();
+    drawnPositions.clear(); // Footprint changes shape, repaint everything once
+}
+
+void Cloth::InitializeDetail() {
+    // Mesh cloths have no grid to interpolate over, nor has a single row or column
+    if (isMesh || width < 2 || height < 2) renderDetail = 1;
+
+    detailTopologyVersion = -1;
+    drawnDetail.clear();
+    if (renderDetail == 1) {
+        detailWidth = detailHeight = 0;
+        detailX.clear();
+        detailY.clear();
+        return;
+    }
+
+    BuildAxis(width, renderDetail, detailColumnIndex, detailColumnWeight);
+    BuildAxis(height, renderDetail, detailRowIndex, detailRowWeight);
+    detailWidth = (width - 1) * renderDetail + 1;
+    detailHeight = (height - 1) * renderDetail + 1;
+    detailRowPassX.assign(height * detailWidth, 0.0f);
+    detailRowPassY.assign(height * detailWidth, 0.0f);
+    detailX.assign(detailWidth * detailHeight, 0.0f);
+    detailY.assign(detailWidth * detailHeight, 0.0f);
+    cellRefined.assign((width - 1) * (height - 1), 0);
+    UpdateDetail();
+}
+
+void Cloth::UpdateDetail() {
+    // Along x on every coarse row; split copies from tearing sit past the grid and are ignored
+    for (int cy = 0; cy < height; cy++) {
+        const PointMass* row = &points[cy * width];
+        float* outX = &detailRowPassX[cy * detailWidth];
+        float* outY = &detailRowPassY[cy * detailWidth];
+        for (int i = 0; i < detailWidth; i++) {
+            const int* index = &detailColumnIndex[i * 4];
+            const float* w = &detailColumnWeight[i * 4];
+            outX[i] = w[0] * row[index[0]].renderX + w[1] * row[index[1]].renderX +
+                      w[2] * row[index[2]].renderX + w[3] * row[index[3]].renderX;
+            outY[i] = w[0] * row[index[0]].renderY + w[1] * row[index[1]].renderY +
+                      w[2] * row[index[2]].renderY + w[3] * row[index[3]].renderY;
+        }
+    }
+
+    // Down the columns: contiguous rows weighted and summed, which vectorizes
+    auto body = [this](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            const int* index = &detailRowIndex[j * 4];
+            const float* w = &detailRowWeight[j * 4];
+            const float* x0 = &detailRowPassX[index[0] * detailWidth];
+            const float* x1 = &detailRowPassX[index[1] * detailWidth];
+            const float* x2 = &detailRowPassX[index[2] * detailWidth];
+            const float* x3 = &detailRowPassX[index[3] * detailWidth];
+            const float* y0 = &detailRowPassY[index[0] * detailWidth];
+            const float* y1 = &detailRowPassY[index[1] * detailWidth];
+            const float* y2 = &detailRowPassY[index[2] * detailWidth];
+            const float* y3 = &detailRowPassY[index[3] * detailWidth];
+            float* outX = &detailX[j * detailWidth];
+            float* outY = &detailY[j * detailWidth];
+            for (int i = 0; i < detailWidth; i++) {
+                outX[i] = w[0] * x0[i] + w[1] * x1[i] + w[2] * x2[i] + w[3] * x3[i];
+                outY[i] = w[0] * y0[i] + w[1] * y1[i] + w[2] * y2[i] + w[3] * y3[i];
+            }
+        }
+    };
+    if (scheduler) {
+        scheduler->ParallelFor(detailHeight, DETAIL_ROW_CHUNK, phaseTuning[PHASE_DETAIL], body);
+    } else {
+        body(0, detailHeight);
+    }
+}
+
+void Cloth::UpdateRefinedCells() {
+    if (detailTopologyVersion == topologyVersion) return;
+    detailTopologyVersion = topologyVersion;
+
+    // A cell is intact while both its faces still use the original grid points
+    int cellsX = width - 1;
+    int cellsY = height - 1;
+    std::vector<unsigned char> intact(cellsX * cellsY);
+    for (int cy = 0; cy < cellsY; cy++) {
+        for (int cx = 0; cx < cellsX; cx++) {
+            int cell = cy * cellsX + cx;
+            int topLeft = cy * width + cx;
+            int bottomLeft = topLeft + width;
+            const Face& f1 = faces[cell * 2];
+            const Face& f2 = faces[cell * 2 + 1];
+            intact[cell] = f1.p1 == topLeft && f1.p2 == bottomLeft && f1.p3 == topLeft + 1 &&
+                           f2.p1 == bottomLeft && f2.p2 == bottomLeft + 1 && f2.p3 == topLeft + 1;
+        }
+    }
+
+    // The 4x4 stencil reaches one cell out, so refine only cells with no tear next to them
+    for (int cy = 0; cy < cellsY; cy++) {
+        for (int cx = 0; cx < cellsX; cx++) {
+            bool refined = true;
+            for (int ny = std::max(0, cy - 1); ny <= std::min(cellsY - 1, cy + 1); ny++) {
+                for (int nx = std::max(0, cx - 1); nx <= std::min(cellsX - 1, cx + 1); nx++) {
+                    refined = refined && intact[ny * cellsX + nx];
+                }
+            }
+            cellRefined[cy * cellsX + cx] = refined;
+        }
+    }
+}
+
+void Cloth::MarkDetailTiles(DirtyTileMap& tiles) {
+    const float pad = DRAW_PADDING;
+    size_t count = detailX.size();
+
+    if (drawnDetail.size() != count * 2) {
+        tiles.MarkAll();
+    } else {
+        // Per coarse cell: union of the old and new footprint of its fine vertices
+        for (int cy = 0; cy < height - 1; cy++) {
+            for (int cx = 0; cx < width - 1; cx++) {
+                bool moved = false;
+                float left = detailX[cy * renderDetail * detailWidth + cx * renderDetail], right = left;
+                float top = detailY[cy * renderDetail * detailWidth + cx * renderDetail], bottom = top;
+                for (int sy = 0; sy <= renderDetail; sy++) {
+                    int rowStart = (cy * renderDetail + sy) * detailWidth + cx * renderDetail;
+                    for (int sx = 0; sx <= renderDetail; sx++) {
+                        int i = rowStart + sx;
+                        float oldX = drawnDetail[i * 2], oldY = drawnDetail[i * 2 + 1];
+                        moved = moved || (int)detailX[i] != (int)oldX || (int)detailY[i] != (int)oldY;
+                        left = std::min(left, std::min(detailX[i], oldX));
+                        right = std::max(right, std::max(detailX[i], oldX));
+                        top = std::min(top, std::min(detailY[i], oldY));
+                        bottom = std::max(bottom, std::max(detailY[i], oldY));
+                    }
+                }
+                if (moved) tiles.MarkRect(left - pad, top - pad, right + pad, bottom + pad);
+            }
+        }
+    }
+
+    drawnDetail.resize(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        drawnDetail[i * 2] = detailX[i];
+        drawnDetail[i * 2 + 1] = detailY[i];
+    }
+}
+
+void Cloth::AppendDetailCell(DrawList& list, int cellX, int cellY) const {
+    float baseArea = spacing * spacing / (2.0f * renderDetail * renderDetail);
+
+    for (int sy = 0; sy < renderDetail; sy++) {
+        int top = (cellY * renderDetail + sy) * detailWidth + cellX * renderDetail;
+        int bottom = top + detailWidth;
+        for (int sx = 0; sx < renderDetail; sx++) {
+            // Same triangles and shading as DrawDetailCell
+            int triangles[2][3] = {{top + sx, bottom + sx, top + sx + 1},
+                                   {bottom + sx, bottom + sx + 1, top + sx + 1}};
+            for (const auto& t : triangles) {
+                float ax = detailX[t[0]], ay = detailY[t[0]];
+                float bx = detailX[t[1]], by = detailY[t[1]];
+                float cx = detailX[t[2]], cy = detailY[t[2]];
+                float area = std::abs((bx - ax) * (cy - ay) - (cx - ax) * (by - ay)) / 2.0f;
+                int shade = GetStretchShade(area / baseArea);
+                list.AddTriangle(ax, ay, bx, by, cx, cy, (uint32_t)(shade << 16 | shade << 8 | shade));
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+void Cloth::DrawDetailCell(HDC hdc, int cellX, int cellY, const DirtyTileMap* dirty) {
+    const float pad = DRAW_PADDING;
+    float baseArea = spacing * spacing / (2.0f * renderDetail * renderDetail);
+
+    for (int sy = 0; sy < renderDetail; sy++) {
+        int top = (cellY * renderDetail + sy) * detailWidth + cellX * renderDetail;
+        int bottom = top + detailWidth;
+        for (int sx = 0; sx < renderDetail; sx++) {
+            // Same split as the coarse faces: (TL, BL, TR) and (BL, BR, TR)
+            int triangles[2][3] = {{top + sx, bottom + sx, top + sx + 1},
+                                   {bottom + sx, bottom + sx + 1, top + sx + 1}};
+            for (const auto& t : triangles) {
+                float ax = detailX[t[0]], ay = detailY[t[0]];
+                float bx = detailX[t[1]], by = detailY[t[1]];
+                float cx = detailX[t[2]], cy = detailY[t[2]];
+                if (dirty && !dirty->Intersects(std::min(ax, std::min(bx, cx)) - pad,
+                                                std::min(ay, std::min(by, cy)) - pad,
+                                                std::max(ax, std::max(bx, cx)) + pad,
+                                                std::max(ay, std::max(by, cy)) + pad)) continue;
+
+                float area = std::abs((bx - ax) * (cy - ay) - (cx - ax) * (by - ay)) / 2.0f;
+                POINT corners[3] = {{(LONG)ax, (LONG)ay}, {(LONG)bx, (LONG)by}, {(LONG)cx, (LONG)cy}};
+                FillTriangle(hdc, corners, GetStretchColor(area / baseArea));
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,161 @@
+#include "Cloth.h"
+#include <algorithm>
+
+// Reassociated sums would depend on the vector width the compiler picks
+#if defined(__FAST_MATH__) || defined(_M_FP_FAST)
+#error "Deterministic mode needs strict IEEE float; build without -ffast-math or /fp:fast"
+#endif
+
+// Deterministic mode. Work is split into chunks of a fixed size that does not
+// depend on the thread count, every chunk writes only its own outputs, and
+// anything shared is combined afterwards in chunk or index order:
+//   - springs compute their force once, then every point gathers the forces
+//     of its springs in spring-end list order instead of springs scattering
+//     into points as they go;
+//   - break decisions are made per spring in parallel and applied in spring
+//     index order, so vertex splits always happen in the same sequence;
+//   - self-collision pairs are found in parallel but resolved one after the
+//     other in (i, j) order;
+//   - spring energy is summed per chunk in spring order and the chunk sums
+//     are added in pass and chunk order.
+// Every sum is a scalar loop in that order. The core is built without fused
+// multiply-adds or fast math, so the compiler may not regroup or contract
+// them and the result does not depend on the SIMD width it targets either.
+
+void Cloth::GatherSpringForces(float dt) {
+    ComputeSpringForces(dt);
+
+    RunPointPhase(PHASE_GATHER, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            PointMass& point = points[i];
+            if (point.isFixed || point.isDragged) continue;
+
+            float fx = 0.0f;
+            float fy = 0.0f;
+            for (int e = firstSpringEnd[i]; e != -1; e = springEndNext[e]) {
+                int s = e / 2;
+                float sign = (e % 2 == 0) ? 1.0f : -1.0f;  // Pulls point1 towards point2 and back
+                fx += sign * springForce[s * 2];
+                fy += sign * springForce[s * 2 + 1];
+            }
+            point.fx += fx;
+            point.fy += fy;
+        }
+    });
+}
+
+void Cloth::CheckSpringBreakingOrdered() {
+    springBreaks.resize(springs.size());
+
+    RunPhase(PHASE_BREAKING, (int)springs.size(), SPRING_CHUNK, [this](int begin, int end) {
+        for (int s = begin; s < end; s++) {
+            Spring& spring = springs[s];
+            springBreaks[s] = 0;
+            if (spring.broken) continue;
+
+            const PointMass& p1 = points[spring.point1];
+            const PointMass& p2 = points[spring.point2];
+            float dx = p2.x - p1.x;
+            float dy = p2.y - p1.y;
+            float stretch = std::sqrt(dx * dx + dy * dy) / spring.restLength;
+
+            UpdateSpringStress(spring, stretch);
+            springBreaks[s] = ClothKernels::ShouldBreak(stretch, spring.maxStretch, spring.stressFrames);
+        }
+    });
+
+    for (size_t s = 0; s < springs.size(); s++) {
+        if (!springBreaks[s]) continue;
+        springs[s].broken = true;
+        pdFactored = false;
+        SplitVertex(springs[s].point1);
+        SplitVertex(springs[s].point2);
+    }
+}
+
+void Cloth::HandleSelfCollisionsOrdered() {
+    const float minDistance = spacing * 0.5f;
+    int count = (int)points.size();
+    int chunkCount = (count + COLLISION_ROWS - 1) / COLLISION_ROWS;
+    if ((int)chunkPairs.size() < chunkCount) chunkPairs.resize(chunkCount);
+
+    // Detection reads positions only, so rows can be scanned in parallel
+    RunPhase(PHASE_SELF_COLLISIONS, count, COLLISION_ROWS, [this, count, minDistance](int begin, int end) {
+        for (int chunkBegin = begin; chunkBegin < end; chunkBegin += COLLISION_ROWS) {
+            int chunkEnd = std::min(chunkBegin + COLLISION_ROWS, end);
+            std::vector<int>& pairs = chunkPairs[chunkBegin / COLLISION_ROWS];
+            pairs.clear();
+
+            for (int i = chunkBegin; i < chunkEnd; i++) {
+                for (int j = i + 1; j < count; j++) {
+                    float dx = points[j].x - points[i].x;
+                    float dy = points[j].y - points[i].y;
+                    if (dx * dx + dy * dy < minDistance * minDistance) {
+                        pairs.push_back(i);
+                        pairs.push_back(j);
+                    }
+                }
+            }
+        }
+    });
+
+    // Resolve in (i, j) order against the positions as they are being corrected
+    for (int c = 0; c < chunkCount; c++) {
+        const std::vector<int>& pairs = chunkPairs[c];
+        for (size_t k = 0; k < pairs.size(); k += 2) {
+            PointMass& a = points[pairs[k]];
+            PointMass& b = points[pairs[k + 1]];
+            float dx = b.x - a.x;
+            float dy = b.y - a.y;
+            float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist >= minDistance || dist <= 0.0001f) continue;
+
+            float moveRatio = (minDistance - dist) / (2.0f * dist);
+            float moveX = dx * moveRatio;
+            float moveY = dy * moveRatio;
+            if (!a.isFixed && !a.isDragged) {
+                a.x -= moveX;
+                a.y -= moveY;
+            }
+            if (!b.isFixed && !b.isDragged) {
+                b.x += moveX;
+                b.y += moveY;
+            }
+        }
+    }
+}
+
+unsigned long long Cloth::GetStateHash() const {
+    unsigned long long hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    if (compact) {
+        // Positions, velocities, ends and broken flags are kept exact, so parking does not change the hash
+        const CompactState& parked = compactState;
+        for (size_t i = 0; i < parked.pointFlags.size(); i++) {
+            float state[4] = {parked.position[i * 2], parked.position[i * 2 + 1], parked.velocity[i * 2],
+                              parked.velocity[i * 2 + 1]};
+            mix(state, sizeof(state));
+        }
+        for (size_t s = 0; s < parked.restLength.size(); s++) {
+            int ends[3] = {parked.springEnds[s * 2], parked.springEnds[s * 2 + 1], parked.springBroken[s]};
+            mix(ends, sizeof(ends));
+        }
+        return hash;
+    }
+    for (const auto& point : points) {
+        float state[4] = {point.x, point.y, point.vx, point.vy};
+        mix(state, sizeof(state));
+    }
+    for (const auto& spring : springs) {
+        int ends[3] = {spring.point1, spring.point2, spring.broken ? 1 : 0};
+        mix(ends, sizeof(ends));
+    }
+    return hash;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Constants and per-spring / per-point arithmetic of the cloth model, shared
+// by every solver that runs it: Cloth's own passes, the C API over caller
+// buffers and the domain-decomposed grid. Each kernel takes plain floats, so
+// callers keep their own storage layout, and the operations happen in one
+// place in one order, which is what keeps those solvers in step bit for bit.
+namespace ClothKernels {
+
+// Slider scaling from the GUI's 0-1 controls to internal units
+const float GRAVITY_SCALE = 1000.0f;
+const float STIFFNESS_SCALE = 10000.0f;
+const float DAMPING_SCALE = 2.0f;
+
+// A new cloth's settings, in internal units
+const float DEFAULT_GRAVITY = 500.0f;
+const float DEFAULT_STIFFNESS = 8000.0f;
+const float DEFAULT_DAMPING = 2.0f;
+
+// Shear and bending springs relative to the structural ones
+const float SHEAR_STIFFNESS_RATIO = 0.5f;
+const float SHEAR_DAMPING_RATIO = 0.75f;
+
+const float MIN_SPRING_LENGTH = 0.0001f;  // Shorter springs have no direction and push nothing
+const float VELOCITY_DAMPING = 0.85f;     // Velocity kept per frame at DAMPING_FRAME_RATE
+const float MAX_VELOCITY = 1000.0f;
+
+// Velocity damping is specified per frame at this rate and scaled to the
+// step, so splitting a frame into more substeps damps it by the same amount
+const float DAMPING_FRAME_RATE = 60.0f;
+
+// Velocity kept over a step of dt given the amount kept per reference frame
+inline float StepDamping(float perFrame, float dt) {
+    return std::pow(perFrame, dt * DAMPING_FRAME_RATE);
+}
+
+// Breaking: a spring past its maximum stretch breaks once it has spent
+// STRESS_FRAMES substeps above STRESS_FRACTION of it; relaxed springs
+// recover two frames per substep
+const float STRUCTURAL_MAX_STRETCH = 30.5f;
+const float OTHER_MAX_STRETCH = 20.8f;
+const float STRESS_FRACTION = 0.8f;
+const int STRESS_FRAMES = 30;
+
+// Box the points are kept inside, with the velocity kept on a bounce and
+// the tangential velocity kept on contact
+struct Bounds {
+    float left, top, right, bottom;
+    float restitution, friction;
+};
+const Bounds WINDOW_BOUNDS = {20.0f, 20.0f, 800.0f - 20.0f, 600.0f - 20.0f, 0.3f, 0.8f};
+
+// Force on point1 of a spring along (dx, dy) of the given length: the
+// material force plus damping of the relative velocity along the spring.
+// Point2 takes the opposite force.
+inline void SpringForce(float dx, float dy, float length, float dvx, float dvy, float materialForce, float damping,
+                        float& fx, float& fy) {
+    float dampingForce = damping * (dvx * dx + dvy * dy) / length;
+    float totalForce = materialForce + dampingForce;
+    fx = (dx / length) * totalForce;
+    fy = (dy / length) * totalForce;
+}
+
+// Stress frames after a substep at this stretch
+inline int UpdateStress(int stressFrames, float stretch, float maxStretch) {
+    return stretch > STRESS_FRACTION * maxStretch ? stressFrames + 1 : std::max(0, stressFrames - 2);
+}
+
+inline bool ShouldBreak(float stretch, float maxStretch, int stressFrames) {
+    return stretch > maxStretch && stressFrames >= STRESS_FRAMES;
+}
+
+inline void CollideBounds(const Bounds& bounds, float& x, float& y, float& vx, float& vy) {
+    if (y > bounds.bottom) {
+        y = bounds.bottom;
+        vy = -vy * bounds.restitution;
+        vx *= bounds.friction;
+    }
+    if (y < bounds.top) {
+        y = bounds.top;
+        vy = -vy * bounds.restitution;
+        vx *= bounds.friction;
+    }
+    if (x > bounds.right) {
+        x = bounds.right;
+        vx = -vx * bounds.restitution;
+        vy *= bounds.friction;
+    }
+    if (x < bounds.left) {
+        x = bounds.left;
+        vx = -vx * bounds.restitution;
+        vy *= bounds.friction;
+    }
+}
+
+// Damped explicit step: velocity from the acceleration, damped by the
+// step's StepDamping, clamped to maxVelocity, then the position. Returns
+// the speed after clamping.
+inline float IntegratePoint(float& x, float& y, float& vx, float& vy, float ax, float ay, float dt, float damping,
+                            float maxVelocity, bool& clamped) {
+    vx = (vx + ax * dt) * damping;
+    vy = (vy + ay * dt) * damping;
+    float velocity = std::sqrt(vx * vx + vy * vy);
+    clamped = velocity > maxVelocity;
+    if (clamped) {
+        float scale = maxVelocity / velocity;
+        vx *= scale;
+        vy *= scale;
+        velocity = maxVelocity;
+    }
+    x += vx * dt;
+    y += vy * dt;
+    return velocity;
+}
+
+} // namespace ClothKernels
@@ -0,0 +1,151 @@
+#include "Cloth.h"
+#include <algorithm>
+
+// Spring material curves. Springs are listed per distinct curve; a pass
+// switches on its curve once and runs the loop instantiated for that response
+// type, so the per-spring work is the curve's inline min/max or table
+// arithmetic with no branch on the material. Families that share a curve
+// share a pass, and every list stays in spring index order. A single pass
+// walks the springs directly with no list, so the default cloth still sweeps
+// its springs once in memory order with the same forces as before.
+
+void Cloth::InitializeMaterials() {
+    BuildMaterialPasses();
+    springPeak.assign(springs.size(), 1.0f);
+}
+
+void Cloth::BuildMaterialPasses() {
+    int familyPass[FAMILY_COUNT];
+    passCount = 0;
+    for (int f = 0; f < FAMILY_COUNT; f++) {
+        familyPass[f] = passCount;
+        for (int p = 0; p < passCount; p++) {
+            if (materials[passFamily[p]].SameCurve(materials[f])) familyPass[f] = p;
+        }
+        if (familyPass[f] == passCount) passFamily[passCount++] = f;
+    }
+
+    for (auto& list : passSprings) list.clear();
+    if (passCount == 1) return;
+    for (int s = 0; s < (int)springs.size(); s++) {
+        int family = std::min((int)springs[s].family, FAMILY_COUNT - 1);
+        passSprings[familyPass[family]].push_back(s);
+    }
+}
+
+void Cloth::SetMaterial(SpringFamily family, const MaterialModel& model) {
+    if (family >= FAMILY_COUNT) return;
+    if (compact) Expand();
+    materials[family] = model;
+    std::fill(springPeak.begin(), springPeak.end(), 1.0f);
+    pdFactored = false;  // Projective weights follow the slope at rest
+    BuildMaterialPasses();
+}
+
+template <typename Response>
+void Cloth::ApplyPassForces(Response response, int pass) {
+    float energy = 0.0f;
+
+    auto apply = [&](int s) {
+        const Spring& spring = springs[s];
+        if (spring.broken) return;
+
+        PointMass& p1 = points[spring.point1];
+        PointMass& p2 = points[spring.point2];
+
+        float dx = p2.x - p1.x;
+        float dy = p2.y - p1.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+
+        if (length < ClothKernels::MIN_SPRING_LENGTH) return;
+
+        float stretch = length / spring.restLength;
+        float force = spring.stiffness * response.Force(stretch, springPeak[s]);
+        energy += spring.stiffness * spring.restLength * response.Energy(stretch);
+
+        // Hooke's law with damping
+        float fx, fy;
+        ClothKernels::SpringForce(dx, dy, length, p2.vx - p1.vx, p2.vy - p1.vy, force, spring.damping, fx, fy);
+
+        if (!p1.isFixed && !p1.isDragged) {
+            p1.fx += fx;
+            p1.fy += fy;
+        }
+        if (!p2.isFixed && !p2.isDragged) {
+            p2.fx -= fx;
+            p2.fy -= fy;
+        }
+    };
+    if (passCount == 1) {
+        for (int s = 0; s < (int)springs.size(); s++) apply(s);
+    } else {
+        for (int s : passSprings[pass]) apply(s);
+    }
+    springEnergy += energy;
+}
+
+void Cloth::ApplySpringForces(float dt) {
+    springEnergy = 0.0f;
+    for (int p = 0; p < passCount; p++) {
+        materials[passFamily[p]].Visit(dt, [this, p](const auto& response) { ApplyPassForces(response, p); });
+    }
+}
+
+// Deterministic counterpart: fixed chunks of the pass list, each writing
+// its springs' forces and its own energy slot
+template <typename Response>
+void Cloth::ComputePassForces(Response response, int pass, int firstChunk) {
+    // Writes the spring's force and returns its energy
+    auto compute = [this, response](int s) {
+        const Spring& spring = springs[s];
+        springForce[s * 2] = 0.0f;
+        springForce[s * 2 + 1] = 0.0f;
+        if (spring.broken) return 0.0f;
+
+        const PointMass& p1 = points[spring.point1];
+        const PointMass& p2 = points[spring.point2];
+        float dx = p2.x - p1.x;
+        float dy = p2.y - p1.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < ClothKernels::MIN_SPRING_LENGTH) return 0.0f;
+
+        float stretch = length / spring.restLength;
+        float force = spring.stiffness * response.Force(stretch, springPeak[s]);
+        ClothKernels::SpringForce(dx, dy, length, p2.vx - p1.vx, p2.vy - p1.vy, force, spring.damping,
+                                  springForce[s * 2], springForce[s * 2 + 1]);
+        return spring.stiffness * spring.restLength * response.Energy(stretch);
+    };
+
+    const int* list = passCount == 1 ? nullptr : passSprings[pass].data();
+    RunPhase(PHASE_SPRINGS, GetPassSize(pass), SPRING_CHUNK, [&](int begin, int end) {
+        // begin is always chunk aligned; inline runs may cover several chunks
+        for (int chunkBegin = begin; chunkBegin < end; chunkBegin += SPRING_CHUNK) {
+            int chunkEnd = std::min(chunkBegin + SPRING_CHUNK, end);
+            float energy = 0.0f;
+            if (list) {
+                for (int k = chunkBegin; k < chunkEnd; k++) energy += compute(list[k]);
+            } else {
+                for (int s = chunkBegin; s < chunkEnd; s++) energy += compute(s);
+            }
+            chunkSpringEnergy[firstChunk + chunkBegin / SPRING_CHUNK] = energy;
+        }
+    });
+}
+
+void Cloth::ComputeSpringForces(float dt) {
+    int firstChunk[FAMILY_COUNT + 1] = {0};
+    for (int p = 0; p < passCount; p++) {
+        firstChunk[p + 1] = firstChunk[p] + (GetPassSize(p) + SPRING_CHUNK - 1) / SPRING_CHUNK;
+    }
+    springForce.resize(springs.size() * 2);
+    chunkSpringEnergy.resize(firstChunk[passCount]);
+
+    for (int p = 0; p < passCount; p++) {
+        materials[passFamily[p]].Visit(dt, [this, p, &firstChunk](const auto& response) {
+            ComputePassForces(response, p, firstChunk[p]);
+        });
+    }
+
+    springEnergy = 0.0f;
+    for (int c = 0; c < firstChunk[passCount]; c++) springEnergy += chunkSpringEnergy[c];
+}
@@ -0,0 +1,286 @@
+#include "Cloth.h"
+#include <algorithm>
+#include <cmath>
+
+// Projective dynamics. Each substep minimises
+//   m/(2h^2) |x - y|^2 + sum k/2 |(x2 - x1) - d|^2
+// where y is where momentum and external forces alone would take the points
+// and d is the spring vector projected onto its rest length. For fixed d this
+// is a linear system whose matrix only depends on the masses, the step, the
+// intact springs and which points are pinned, so it is Cholesky-factored once
+// and every iteration is a parallel projection per spring plus a forward and
+// backward substitution. Springs use the slope of their family's material
+// just above rest, so the default cloth keeps the 1.5 of the original curve,
+// and report the material's energy; hysteresis and any stiffening past a knee
+// are not modelled. Their damping is replaced by the velocity damping that
+// is folded into y. Rows are free points in point order, so grid cloths have
+// a band of about width + 1 and the factor is stored as row envelopes.
+
+namespace {
+
+int FamilyOf(const Spring& spring) {
+    return std::min((int)spring.family, FAMILY_COUNT - 1);
+}
+
+float ProjectiveStiffness(const Spring& spring, const float* slopes) {
+    return slopes[FamilyOf(spring)] * spring.stiffness / spring.restLength;
+}
+
+} // namespace
+
+void Cloth::SetProjective(bool enabled) {
+    projective = enabled;
+    pdFactored = false;
+}
+
+void Cloth::SetProjectiveIterations(int count) {
+    projectiveIterations = std::max(1, std::min(100, count));
+}
+
+bool Cloth::ProjectivePinsChanged() const {
+    if (pdPinned.size() != points.size()) return true;
+    for (size_t i = 0; i < points.size(); i++) {
+        if ((points[i].isFixed || points[i].isDragged) != (pdPinned[i] != 0)) return true;
+    }
+    return false;
+}
+
+void Cloth::FactorProjective(float dt) {
+    int count = (int)points.size();
+    pdPinned.resize(count);
+    pdRow.resize(count);
+    pdPoint.clear();
+    for (int i = 0; i < count; i++) {
+        pdPinned[i] = points[i].isFixed || points[i].isDragged;
+        pdRow[i] = pdPinned[i] ? -1 : (int)pdPoint.size();
+        if (!pdPinned[i]) pdPoint.push_back(i);
+    }
+    int rows = (int)pdPoint.size();
+
+    // Envelope: each row starts at its lowest coupled row
+    pdFirst.resize(rows);
+    for (int r = 0; r < rows; r++) pdFirst[r] = r;
+    for (const auto& spring : springs) {
+        int r1 = pdRow[spring.point1];
+        int r2 = pdRow[spring.point2];
+        if (spring.broken || r1 < 0 || r2 < 0 || r1 == r2) continue;
+        int high = std::max(r1, r2);
+        pdFirst[high] = std::min(pdFirst[high], std::min(r1, r2));
+    }
+    pdOffset.resize(rows + 1);
+    pdOffset[0] = 0;
+    for (int r = 0; r < rows; r++) pdOffset[r + 1] = pdOffset[r] + (r - pdFirst[r] + 1);
+
+    // Assemble M/h^2 + sum k over the springs into the envelope
+    for (int f = 0; f < FAMILY_COUNT; f++) pdSlope[f] = materials[f].RestSlope();
+    pdFactor.assign(pdOffset[rows], 0.0);
+    double inverseStep = 1.0 / ((double)dt * dt);
+    for (int r = 0; r < rows; r++) {
+        pdFactor[pdOffset[r + 1] - 1] = points[pdPoint[r]].mass * inverseStep;
+    }
+    for (const auto& spring : springs) {
+        if (spring.broken) continue;
+        int r1 = pdRow[spring.point1];
+        int r2 = pdRow[spring.point2];
+        double k = ProjectiveStiffness(spring, pdSlope);
+        if (r1 >= 0) pdFactor[pdOffset[r1 + 1] - 1] += k;
+        if (r2 >= 0) pdFactor[pdOffset[r2 + 1] - 1] += k;
+        if (r1 >= 0 && r2 >= 0 && r1 != r2) {
+            int high = std::max(r1, r2);
+            int low = std::min(r1, r2);
+            pdFactor[pdOffset[high] + (low - pdFirst[high])] -= k;
+        }
+    }
+
+    // Row-by-row Cholesky; fill stays inside each row's envelope
+    for (int i = 0; i < rows; i++) {
+        double* rowI = &pdFactor[pdOffset[i]];
+        int firstI = pdFirst[i];
+        for (int j = firstI; j <= i; j++) {
+            const double* rowJ = &pdFactor[pdOffset[j]];
+            int firstJ = pdFirst[j];
+            double sum = rowI[j - firstI];
+            for (int k = std::max(firstI, firstJ); k < j; k++) {
+                sum -= rowI[k - firstI] * rowJ[k - firstJ];
+            }
+            if (j < i) {
+                rowI[j - firstI] = sum / rowJ[j - firstJ];
+            } else {
+                rowI[i - firstI] = std::sqrt(std::max(sum, 1e-12));  // The mass term keeps it positive
+            }
+        }
+    }
+
+    pdRhsX.resize(rows);
+    pdRhsY.resize(rows);
+    pdStep = dt;
+    pdTopologyVersion = topologyVersion;
+    pdFactored = true;
+    factorizationCount++;
+}
+
+void Cloth::SolveProjective(float dt) {
+    if (!pdFactored || pdStep != dt || pdTopologyVersion != topologyVersion || ProjectivePinsChanged()) {
+        FactorProjective(dt);
+    }
+    int rows = (int)pdPoint.size();
+    int springCount = (int)springs.size();
+    int springChunks = (springCount + SPRING_CHUNK - 1) / SPRING_CHUNK;
+    pdInertia.resize(points.size() * 4);
+    pdProjection.resize(springs.size() * 2);
+    chunkPdEnergy.resize(springChunks);
+
+    // Inertial target, also the first guess
+    float scale = dt * ClothKernels::StepDamping(ClothKernels::VELOCITY_DAMPING, dt);
+    RunPointPhase(PHASE_FORCES, [this, dt, scale](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            PointMass& point = points[i];
+            float* state = &pdInertia[i * 4];
+            state[2] = point.x;
+            state[3] = point.y;
+            if (point.isFixed || point.isDragged) {
+                state[0] = point.x;
+                state[1] = point.y;
+                continue;
+            }
+            state[0] = point.x + scale * (point.vx + point.fx / point.mass * dt);
+            state[1] = point.y + scale * (point.vy + point.fy / point.mass * dt);
+            point.x = state[0];
+            point.y = state[1];
+        }
+    });
+
+    double inverseStep = 1.0 / ((double)dt * dt);
+    for (int iteration = 0; iteration < projectiveIterations; iteration++) {
+        // Local step: nearest rest-length vector for every spring. Only the
+        // last iteration's energy is kept, so earlier ones skip the material
+        bool last = iteration == projectiveIterations - 1;
+        RunPhase(PHASE_SPRINGS, springCount, SPRING_CHUNK, [this, last](int begin, int end) {
+            // begin is always chunk aligned; inline runs may cover several chunks
+            for (int chunkBegin = begin; chunkBegin < end; chunkBegin += SPRING_CHUNK) {
+                int chunkEnd = std::min(chunkBegin + SPRING_CHUNK, end);
+                float energy = 0.0f;
+
+                for (int s = chunkBegin; s < chunkEnd; s++) {
+                    const Spring& spring = springs[s];
+                    if (spring.broken) continue;
+                    float dx = points[spring.point2].x - points[spring.point1].x;
+                    float dy = points[spring.point2].y - points[spring.point1].y;
+                    float length = std::sqrt(dx * dx + dy * dy);
+                    float scale = length < ClothKernels::MIN_SPRING_LENGTH ? 1.0f : spring.restLength / length;
+                    pdProjection[s * 2] = dx * scale;
+                    pdProjection[s * 2 + 1] = dy * scale;
+                    if (last) {
+                        const MaterialModel& material = materials[FamilyOf(spring)];
+                        energy += spring.stiffness * spring.restLength * material.Energy(length / spring.restLength);
+                    }
+                }
+                chunkPdEnergy[chunkBegin / SPRING_CHUNK] = energy;
+            }
+        });
+
+        // Right-hand side, gathered per point in spring-end list order
+        RunPhase(PHASE_GATHER, rows, POINT_CHUNK, [this, inverseStep](int begin, int end) {
+            for (int r = begin; r < end; r++) {
+                int i = pdPoint[r];
+                double mass = points[i].mass * inverseStep;
+                double bx = mass * pdInertia[i * 4];
+                double by = mass * pdInertia[i * 4 + 1];
+                for (int e = firstSpringEnd[i]; e != -1; e = springEndNext[e]) {
+                    int s = e / 2;
+                    const Spring& spring = springs[s];
+                    if (spring.broken) continue;
+                    double k = ProjectiveStiffness(spring, pdSlope);
+                    double sign = (e % 2 == 0) ? -1.0 : 1.0;  // point1 sits at -d, point2 at +d
+                    bx += sign * k * pdProjection[s * 2];
+                    by += sign * k * pdProjection[s * 2 + 1];
+                    int other = (e % 2 == 0) ? spring.point2 : spring.point1;
+                    if (pdPinned[other]) {
+                        bx += k * points[other].x;
+                        by += k * points[other].y;
+                    }
+                }
+                pdRhsX[r] = bx;
+                pdRhsY[r] = by;
+            }
+        });
+
+        // Global step: L z = b, then L^T x = z
+        for (int i = 0; i < rows; i++) {
+            const double* row = &pdFactor[pdOffset[i]];
+            int first = pdFirst[i];
+            double sumX = pdRhsX[i];
+            double sumY = pdRhsY[i];
+            for (int k = first; k < i; k++) {
+                sumX -= row[k - first] * pdRhsX[k];
+                sumY -= row[k - first] * pdRhsY[k];
+            }
+            pdRhsX[i] = sumX / row[i - first];
+            pdRhsY[i] = sumY / row[i - first];
+        }
+        for (int i = rows - 1; i >= 0; i--) {
+            const double* row = &pdFactor[pdOffset[i]];
+            int first = pdFirst[i];
+            double x = pdRhsX[i] / row[i - first];
+            double y = pdRhsY[i] / row[i - first];
+            pdRhsX[i] = x;
+            pdRhsY[i] = y;
+            for (int k = first; k < i; k++) {
+                pdRhsX[k] -= row[k - first] * x;
+                pdRhsY[k] -= row[k - first] * y;
+            }
+        }
+
+        RunPhase(PHASE_POSITIONS, rows, POINT_CHUNK, [this](int begin, int end) {
+            for (int r = begin; r < end; r++) {
+                points[pdPoint[r]].x = (float)pdRhsX[r];
+                points[pdPoint[r]].y = (float)pdRhsY[r];
+            }
+        });
+    }
+
+    springEnergy = 0.0f;
+    for (int c = 0; c < springChunks; c++) springEnergy += chunkPdEnergy[c];
+
+    // Velocities follow from the positions, clamped like IntegratePoints
+    int chunkCount = ((int)points.size() + POINT_CHUNK - 1) / POINT_CHUNK;
+    chunkEnergy.resize(chunkCount);
+    chunkClamped.resize(chunkCount);
+    RunPointPhase(PHASE_POSITIONS, [this, dt](int begin, int end) {
+        for (int chunkBegin = begin; chunkBegin < end; chunkBegin += POINT_CHUNK) {
+            int chunkEnd = std::min(chunkBegin + POINT_CHUNK, end);
+            float energy = 0.0f;
+            int clamped = 0;
+
+            for (int i = chunkBegin; i < chunkEnd; i++) {
+                PointMass& point = points[i];
+                if (point.isFixed || point.isDragged) continue;
+                const float* state = &pdInertia[i * 4];
+                point.vx = (point.x - state[2]) / dt;
+                point.vy = (point.y - state[3]) / dt;
+                float velocity = std::sqrt(point.vx * point.vx + point.vy * point.vy);
+                if (velocity > ClothKernels::MAX_VELOCITY) {
+                    float scale = ClothKernels::MAX_VELOCITY / velocity;
+                    point.vx *= scale;
+                    point.vy *= scale;
+                    point.x = state[2] + point.vx * dt;
+                    point.y = state[3] + point.vy * dt;
+                    velocity = ClothKernels::MAX_VELOCITY;
+                    clamped++;
+                }
+                energy += 0.5f * point.mass * velocity * velocity;
+            }
+
+            chunkEnergy[chunkBegin / POINT_CHUNK] = energy;
+            chunkClamped[chunkBegin / POINT_CHUNK] = clamped;
+        }
+    });
+
+    lastKineticEnergy = kineticEnergy;
+    kineticEnergy = 0.0f;
+    clampedPoints = 0;
+    for (int c = 0; c < chunkCount; c++) {
+        kineticEnergy += chunkEnergy[c];
+        clampedPoints += chunkClamped[c];
+    }
+}
@@ -0,0 +1,293 @@
+#include "ClothScene.h"
+#include "Cloth.h"
+#include "SceneFile.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+bool Overlap(const ClothScene::Bounds& a, const ClothScene::Bounds& b) {
+    return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+ClothScene::Bounds Union(const ClothScene::Bounds& a, const ClothScene::Bounds& b) {
+    return {std::min(a.left, b.left), std::min(a.top, b.top),
+            std::max(a.right, b.right), std::max(a.bottom, b.bottom)};
+}
+
+float Area(const ClothScene::Bounds& box) {
+    return (box.right - box.left) * (box.bottom - box.top);
+}
+
+} // namespace
+
+void ClothScene::BoundsTree::Build(const std::vector<Bounds>& boxes) {
+    nodes.clear();
+    if (boxes.empty()) return;
+    nodes.reserve(boxes.size() * 2 - 1);
+    order.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) order[i] = (int)i;
+    BuildRange(boxes, 0, (int)boxes.size());
+}
+
+int ClothScene::BoundsTree::BuildRange(const std::vector<Bounds>& boxes, int begin, int end) {
+    int index = (int)nodes.size();
+    nodes.push_back({boxes[order[begin]], -1, -1, order[begin]});
+    if (end - begin == 1) return index;
+
+    // Split at the median centre along the wider axis of the centres
+    Bounds centres = {1e30f, 1e30f, -1e30f, -1e30f};
+    for (int i = begin; i < end; i++) {
+        const Bounds& box = boxes[order[i]];
+        float cx = box.left + box.right;
+        float cy = box.top + box.bottom;
+        centres = Union(centres, {cx, cy, cx, cy});
+    }
+    bool alongX = centres.right - centres.left >= centres.bottom - centres.top;
+    int middle = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+        [&boxes, alongX](int a, int b) {
+            return alongX ? boxes[a].left + boxes[a].right < boxes[b].left + boxes[b].right
+                          : boxes[a].top + boxes[a].bottom < boxes[b].top + boxes[b].bottom;
+        });
+
+    int left = BuildRange(boxes, begin, middle);
+    int right = BuildRange(boxes, middle, end);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    nodes[index].box = Union(nodes[left].box, nodes[right].box);
+    return index;
+}
+
+void ClothScene::BoundsTree::Refit(const std::vector<Bounds>& boxes) {
+    // Children sit after their parent, so a backwards sweep sees them first
+    for (int i = (int)nodes.size() - 1; i >= 0; i--) {
+        Node& node = nodes[i];
+        node.box = node.left < 0 ? boxes[node.item] : Union(nodes[node.left].box, nodes[node.right].box);
+    }
+}
+
+ClothScene::ClothScene() : contactDistance(0.0f), stats() {}
+
+ClothScene::~ClothScene() {
+    Clear();
+}
+
+int ClothScene::Add(Cloth* cloth) {
+    Body body;
+    body.cloth = cloth;
+    body.pointCount = -1;
+    body.width = 0;
+    body.spacing = 0.0f;
+    bodies.push_back(body);
+    return (int)bodies.size() - 1;
+}
+
+void ClothScene::Replace(int index, Cloth* cloth) {
+    if (index >= (int)bodies.size()) {
+        Add(cloth);
+        return;
+    }
+    delete bodies[index].cloth;
+    bodies[index].cloth = cloth;
+    bodies[index].pointCount = -1;
+}
+
+void ClothScene::Clear() {
+    for (auto& body : bodies) delete body.cloth;
+    bodies.clear();
+}
+
+bool ClothScene::Load(const std::string& path) {
+    SceneFile file;
+    if (!file.Open(path) || file.GetClothCount() == 0) return false;
+
+    Clear();
+    for (int i = 0; i < file.GetClothCount(); i++) {
+        Add(new Cloth(file.GetCloth(i)));
+    }
+    return true;
+}
+
+void ClothScene::Step(int steps, float dt) {
+    for (int i = 0; i < steps; i++) {
+        for (auto& body : bodies) body.cloth->Step(1, dt);
+        HandleContacts();
+    }
+}
+
+void ClothScene::BuildTiles(Body& body) {
+    const Cloth& cloth = *body.cloth;
+    int count = (int)cloth.GetPoints().size();
+    int width = cloth.GetWidth();
+    int height = cloth.GetHeight();
+    body.pointCount = count;
+    body.width = width;
+    body.tileStart.clear();
+    body.tilePoints.clear();
+
+    // Grid cloths: square blocks of the original grid
+    int gridCount = 0;
+    if (!cloth.IsMesh()) {
+        gridCount = width * height;
+        for (int ty = 0; ty < height; ty += TILE_SIZE) {
+            for (int tx = 0; tx < width; tx += TILE_SIZE) {
+                body.tileStart.push_back((int)body.tilePoints.size());
+                for (int y = ty; y < std::min(ty + TILE_SIZE, height); y++) {
+                    for (int x = tx; x < std::min(tx + TILE_SIZE, width); x++) {
+                        body.tilePoints.push_back(y * width + x);
+                    }
+                }
+            }
+        }
+    }
+    // Mesh points and split copies: runs of consecutive indices
+    for (int i = gridCount; i < count; i++) {
+        if ((i - gridCount) % CHUNK_POINTS == 0) body.tileStart.push_back((int)body.tilePoints.size());
+        body.tilePoints.push_back(i);
+    }
+    body.tileStart.push_back((int)body.tilePoints.size());
+
+    body.spacing = cloth.GetSpacing();
+    if (body.spacing <= 0.0f) {
+        // Mesh cloths have no grid spacing; use the mean spring length
+        float total = 0.0f;
+        for (const auto& spring : cloth.GetSprings()) total += spring.restLength;
+        body.spacing = cloth.GetSprings().empty() ? 1.0f : total / cloth.GetSprings().size();
+    }
+
+    body.tileBounds.assign(body.tileStart.size() - 1, Bounds());
+    RefitTiles(body, 0.0f);
+    body.tiles.Build(body.tileBounds);
+}
+
+void ClothScene::RefitTiles(Body& body, float pad) {
+    const PointMass* points = body.cloth->GetPointData();
+    for (size_t t = 0; t + 1 < body.tileStart.size(); t++) {
+        Bounds box = {1e30f, 1e30f, -1e30f, -1e30f};
+        for (int k = body.tileStart[t]; k < body.tileStart[t + 1]; k++) {
+            const PointMass& p = points[body.tilePoints[k]];
+            box.left = std::min(box.left, p.x);
+            box.top = std::min(box.top, p.y);
+            box.right = std::max(box.right, p.x);
+            box.bottom = std::max(box.bottom, p.y);
+        }
+        body.tileBounds[t] = {box.left - pad, box.top - pad, box.right + pad, box.bottom + pad};
+    }
+    body.tiles.Refit(body.tileBounds);
+}
+
+template <typename Visit>
+void ClothScene::ForEachOverlap(const BoundsTree& a, const BoundsTree& b, Visit visit) {
+    if (a.nodes.empty() || b.nodes.empty()) return;
+    stack.clear();
+    stack.push_back(0);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        int nb = stack.back(); stack.pop_back();
+        int na = stack.back(); stack.pop_back();
+        const BoundsTree::Node& nodeA = a.nodes[na];
+        const BoundsTree::Node& nodeB = b.nodes[nb];
+        if (!Overlap(nodeA.box, nodeB.box)) continue;
+
+        bool leafA = nodeA.left < 0;
+        bool leafB = nodeB.left < 0;
+        if (leafA && leafB) {
+            visit(nodeA.item, nodeB.item);
+        } else if (leafB || (!leafA && Area(nodeA.box) >= Area(nodeB.box))) {
+            // Open the bigger box so both sides shrink at a similar rate
+            stack.push_back(nodeA.left); stack.push_back(nb);
+            stack.push_back(nodeA.right); stack.push_back(nb);
+        } else {
+            stack.push_back(na); stack.push_back(nodeB.left);
+            stack.push_back(na); stack.push_back(nodeB.right);
+        }
+    }
+}
+
+void ClothScene::HandleContacts() {
+    stats = Stats();
+    if (bodies.size() < 2) return;
+
+    // Tile bounds padded so that two tiles within reach of each other overlap
+    bodyBounds.resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); i++) {
+        Body& body = bodies[i];
+        // Tearing adds points and SetResolution changes the grid
+        if (body.pointCount != (int)body.cloth->GetPoints().size() || body.width != body.cloth->GetWidth()) {
+            BuildTiles(body);
+        }
+        float pad = contactDistance > 0.0f ? contactDistance * 0.5f : body.spacing * 0.25f;
+        RefitTiles(body, pad);
+        bodyBounds[i] = body.tiles.nodes[0].box;
+    }
+
+    // Few cloths, so the top-level tree is simply rebuilt every frame
+    clothPairs.clear();
+    bodyTree.Build(bodyBounds);
+    ForEachOverlap(bodyTree, bodyTree, [this](int i, int j) {
+        if (i < j) clothPairs.push_back({i, j});
+    });
+    std::sort(clothPairs.begin(), clothPairs.end());
+
+    for (const auto& pair : clothPairs) {
+        Body& a = bodies[pair.first];
+        Body& b = bodies[pair.second];
+        float distance = contactDistance > 0.0f ? contactDistance : (a.spacing + b.spacing) * 0.25f;
+        stats.clothPairs++;
+        CollideBodies(a, b, distance);
+    }
+}
+
+void ClothScene::CollideBodies(Body& a, Body& b, float distance) {
+    ForEachOverlap(a.tiles, b.tiles, [this, &a, &b, distance](int tileA, int tileB) {
+        stats.tilePairs++;
+        CollideTiles(a, tileA, b, tileB, distance);
+    });
+}
+
+void ClothScene::CollideTiles(Body& a, int tileA, Body& b, int tileB, float distance) {
+    PointMass* pointsA = a.cloth->GetPointData();
+    PointMass* pointsB = b.cloth->GetPointData();
+
+    // Skip points of A that cannot reach anything in B's tile
+    const Bounds& boxB = b.tileBounds[tileB];
+    for (int ka = a.tileStart[tileA]; ka < a.tileStart[tileA + 1]; ka++) {
+        PointMass& p = pointsA[a.tilePoints[ka]];
+        if (p.x < boxB.left - distance || p.x > boxB.right + distance ||
+            p.y < boxB.top - distance || p.y > boxB.bottom + distance) continue;
+        float weightP = (p.isFixed || p.isDragged) ? 0.0f : 1.0f;
+        for (int kb = b.tileStart[tileB]; kb < b.tileStart[tileB + 1]; kb++) {
+            PointMass& q = pointsB[b.tilePoints[kb]];
+            stats.pointTests++;
+            float dx = q.x - p.x;
+            float dy = q.y - p.y;
+            float distSq = dx * dx + dy * dy;
+            if (distSq >= distance * distance || distSq <= 1e-8f) continue;
+
+            // Pinned and dragged points do not move; the other side takes the whole correction
+            float weightQ = (q.isFixed || q.isDragged) ? 0.0f : 1.0f;
+            float total = weightP + weightQ;
+            if (total == 0.0f) continue;
+            stats.contacts++;
+
+            float dist = std::sqrt(distSq);
+            float nx = dx / dist;
+            float ny = dy / dist;
+            float push = distance - dist;
+            p.x -= nx * push * weightP / total;
+            p.y -= ny * push * weightP / total;
+            q.x += nx * push * weightQ / total;
+            q.y += ny * push * weightQ / total;
+
+            // Cancel the approaching part of the relative velocity so they do not push straight back in
+            float approach = (q.vx - p.vx) * nx + (q.vy - p.vy) * ny;
+            if (approach < 0.0f) {
+                p.vx += nx * approach * weightP / total;
+                p.vy += ny * approach * weightP / total;
+                q.vx -= nx * approach * weightQ / total;
+                q.vy -= ny * approach * weightQ / total;
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+class Cloth;
+
+// Several cloths stepped together and pushed apart where they touch. Every
+// cloth's points are grouped into small tiles: 8x8 blocks of the grid, and
+// runs of 64 points for mesh cloths and for the copies tearing adds (both
+// are laid out for locality). Each frame the tile bounds are refit into a
+// per-cloth AABB tree, a tree over the cloth bounds finds the cloth pairs
+// that overlap, and the two tile trees are descended together so point
+// pairs are only tested inside tiles whose bounds overlap. The work follows
+// the contact area instead of the product of the point counts.
+//
+// Contacts are point against point only: each point of one cloth is kept the
+// contact distance away from each point of the other. Edges and faces are
+// not tested, so where the contact distance is below the spacing a point can
+// pass between two neighbouring points of the other cloth, and the cloths
+// interpenetrate along the edges between vertices.
+class ClothScene {
+public:
+    static const int TILE_SIZE = 8;      // Grid points per tile side
+    static const int CHUNK_POINTS = 64;  // Points per tile for mesh cloths and split copies
+
+    struct Bounds {
+        float left, top, right, bottom;
+    };
+
+    struct Stats {
+        int clothPairs;  // Cloth bounds that overlapped
+        int tilePairs;   // Tile bounds that overlapped
+        int pointTests;  // Point pairs checked in the narrowphase
+        int contacts;    // Point pairs that were pushed apart
+    };
+
+    ClothScene();
+    ~ClothScene();  // Deletes the cloths it holds
+
+    int Add(Cloth* cloth);  // Takes ownership, returns the index
+    void Replace(int index, Cloth* cloth);  // Deletes the cloth that was there
+    void Clear();
+    // Replaces the scene with the cloths of a binary scene file; false leaves it unchanged
+    bool Load(const std::string& path);
+    int GetCount() const { return (int)bodies.size(); }
+    Cloth* Get(int index) const { return bodies[index].cloth; }
+
+    // Each frame steps every cloth, then resolves contacts between them
+    void Step(int steps, float dt);
+    void HandleContacts();
+    // Closest two points of different cloths may get; 0 uses half the average spacing.
+    // Point contacts only, so edges pass through each other between vertices
+    void SetContactDistance(float distance) { contactDistance = distance; }
+    const Stats& GetStats() const { return stats; }  // From the last HandleContacts
+
+private:
+    // AABB tree over a fixed list of boxes: built top-down by median split,
+    // then refit bottom-up while the boxes move
+    struct BoundsTree {
+        struct Node {
+            Bounds box;
+            int left, right;  // Children, or -1 for a leaf
+            int item;         // Box index for leaves
+        };
+        std::vector<Node> nodes;  // Children always come after their parent
+        std::vector<int> order;   // Scratch for building
+
+        void Build(const std::vector<Bounds>& boxes);
+        void Refit(const std::vector<Bounds>& boxes);
+        int BuildRange(const std::vector<Bounds>& boxes, int begin, int end);
+    };
+
+    struct Body {
+        Cloth* cloth;
+        int pointCount, width;          // Layout the tiles were built for
+        float spacing;                  // Typical spring rest length
+        std::vector<int> tileStart;     // Tile t owns tilePoints[tileStart[t], tileStart[t + 1])
+        std::vector<int> tilePoints;
+        std::vector<Bounds> tileBounds;
+        BoundsTree tiles;
+    };
+
+    std::vector<Body> bodies;
+    std::vector<Bounds> bodyBounds;
+    BoundsTree bodyTree;
+    std::vector<int> stack;  // Node pairs still to visit
+    std::vector<std::pair<int, int>> clothPairs;  // Overlapping cloths, kept to reuse the storage
+    float contactDistance;
+    Stats stats;
+
+    template <typename Visit>
+    void ForEachOverlap(const BoundsTree& a, const BoundsTree& b, Visit visit);
+    void BuildTiles(Body& body);
+    void RefitTiles(Body& body, float pad);
+    void CollideBodies(Body& a, Body& b, float distance);
+    void CollideTiles(Body& a, int tileA, Body& b, int tileB, float distance);
+};
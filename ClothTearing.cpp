@@ -0,0 +1,251 @@
+#include "Cloth.h"
+#include <algorithm>
+
+namespace {
+
+int& FaceCorner(Face& face, int corner) {
+    return corner == 0 ? face.p1 : (corner == 1 ? face.p2 : face.p3);
+}
+
+} // namespace
+
+// Tearing: when a spring breaks, each of its end points is checked for a
+// fan of faces that has come apart. Faces around a point stay together while
+// the edge they share still has an intact spring; if the fan falls into
+// several groups the point is duplicated, one copy per group, and the faces
+// and springs of each group are moved to their copy along with their share
+// of its mass. All of this only walks the faces and springs touching the
+// point.
+
+void Cloth::LinkCorner(int corner, int vertex) {
+    cornerNext[corner] = firstCorner[vertex];
+    firstCorner[vertex] = corner;
+}
+
+void Cloth::LinkSpringEnd(int end, int vertex) {
+    springEndNext[end] = firstSpringEnd[vertex];
+    firstSpringEnd[vertex] = end;
+}
+
+size_t Cloth::TearingCapacity(int pointCount, const Face* faces, int faceCount) {
+    // Worst case every face corner becomes its own point; points on no face never split
+    std::vector<char> referenced(pointCount, 0);
+    for (int f = 0; f < faceCount; f++) {
+        referenced[faces[f].p1] = 1;
+        referenced[faces[f].p2] = 1;
+        referenced[faces[f].p3] = 1;
+    }
+    size_t unreferenced = std::count(referenced.begin(), referenced.end(), 0);
+    return unreferenced + (size_t)faceCount * 3;
+}
+
+void Cloth::InitializeTearing(const int* edgeSprings) {
+    topologyVersion = 0;
+    initialPointCount = (int)points.size();
+    initialMasses.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) initialMasses[i] = points[i].mass;
+    initialFaces = faces;
+    initialSpringEnds.resize(springs.size() * 2);
+    for (size_t s = 0; s < springs.size(); s++) {
+        initialSpringEnds[s * 2] = springs[s].point1;
+        initialSpringEnds[s * 2 + 1] = springs[s].point2;
+    }
+
+    size_t capacity = TearingCapacity((int)points.size(), faces.data(), (int)faces.size());
+    points.reserve(capacity);
+    if (!restPositions.empty()) restPositions.reserve(capacity * 2);
+    firstCorner.reserve(capacity);
+    firstSpringEnd.reserve(capacity);
+
+    if (edgeSprings) {
+        faceEdgeSpring.assign(edgeSprings, edgeSprings + faces.size() * 3);
+    } else {
+        MatchFaceEdgeSprings();
+    }
+
+    RestoreTopology();
+
+    // A point can never gain faces by splitting, so the largest fan bounds the scratch space
+    int maxFan = 0;
+    for (size_t v = 0; v < points.size(); v++) {
+        int fan = 0;
+        for (int c = firstCorner[v]; c != -1; c = cornerNext[c]) fan++;
+        maxFan = std::max(maxFan, fan);
+    }
+    fanFaces.reserve(maxFan);
+    fanLabels.reserve(maxFan);
+}
+
+// Match every face edge with the spring running along it
+void Cloth::MatchFaceEdgeSprings() {
+    std::vector<std::pair<long long, int>> edgeSprings(springs.size());
+    for (size_t s = 0; s < springs.size(); s++) {
+        long long a = std::min(springs[s].point1, springs[s].point2);
+        long long b = std::max(springs[s].point1, springs[s].point2);
+        edgeSprings[s] = {a * (long long)points.size() + b, (int)s};
+    }
+    std::sort(edgeSprings.begin(), edgeSprings.end());
+
+    faceEdgeSpring.assign(faces.size() * 3, -1);
+    for (size_t f = 0; f < faces.size(); f++) {
+        int v[3] = {faces[f].p1, faces[f].p2, faces[f].p3};
+        for (int e = 0; e < 3; e++) {
+            long long a = std::min(v[e], v[(e + 1) % 3]);
+            long long b = std::max(v[e], v[(e + 1) % 3]);
+            auto it = std::lower_bound(edgeSprings.begin(), edgeSprings.end(),
+                                       std::make_pair(a * (long long)points.size() + b, -1));
+            if (it != edgeSprings.end() && it->first == a * (long long)points.size() + b) {
+                faceEdgeSpring[f * 3 + e] = it->second;
+            }
+        }
+    }
+}
+
+void Cloth::RestoreTopology() {
+    points.resize(initialPointCount);
+    for (int i = 0; i < initialPointCount; i++) points[i].mass = initialMasses[i];
+    if (!restPositions.empty()) restPositions.resize(initialPointCount * 2);
+    faces = initialFaces;
+    for (size_t s = 0; s < springs.size(); s++) {
+        springs[s].point1 = initialSpringEnds[s * 2];
+        springs[s].point2 = initialSpringEnds[s * 2 + 1];
+    }
+
+    cornerNext.assign(faces.size() * 3, -1);
+    firstCorner.assign(points.size(), -1);
+    for (size_t f = 0; f < faces.size(); f++) {
+        LinkCorner((int)f * 3, faces[f].p1);
+        LinkCorner((int)f * 3 + 1, faces[f].p2);
+        LinkCorner((int)f * 3 + 2, faces[f].p3);
+    }
+
+    springEndNext.assign(springs.size() * 2, -1);
+    firstSpringEnd.assign(points.size(), -1);
+    for (size_t s = 0; s < springs.size(); s++) {
+        LinkSpringEnd((int)s * 2, springs[s].point1);
+        LinkSpringEnd((int)s * 2 + 1, springs[s].point2);
+    }
+    topologyVersion++;
+}
+
+void Cloth::SplitVertex(int vertex) {
+    fanFaces.clear();
+    for (int c = firstCorner[vertex]; c != -1; c = cornerNext[c]) fanFaces.push_back(c);
+    int fanSize = (int)fanFaces.size();
+    if (fanSize < 2) return;
+
+    // Label connected groups of faces; two faces join through a shared edge with an intact spring
+    fanLabels.resize(fanSize);
+    for (int i = 0; i < fanSize; i++) fanLabels[i] = i;
+    auto find = [this](int i) {
+        while (fanLabels[i] != i) i = fanLabels[i] = fanLabels[fanLabels[i]];
+        return i;
+    };
+
+    for (int i = 0; i < fanSize; i++) {
+        int fi = fanFaces[i] / 3;
+        int ci = fanFaces[i] % 3;
+        for (int j = i + 1; j < fanSize; j++) {
+            int fj = fanFaces[j] / 3;
+            int cj = fanFaces[j] % 3;
+            // Edges at the point: (ci, ci+1) and (ci+2, ci)
+            for (int ei = 0; ei < 2; ei++) {
+                int wi = FaceCorner(faces[fi], (ci + 1 + ei) % 3);
+                int springI = faceEdgeSpring[fi * 3 + (ei == 0 ? ci : (ci + 2) % 3)];
+                for (int ej = 0; ej < 2; ej++) {
+                    int wj = FaceCorner(faces[fj], (cj + 1 + ej) % 3);
+                    if (wi != wj) continue;
+                    int springJ = faceEdgeSpring[fj * 3 + (ej == 0 ? cj : (cj + 2) % 3)];
+                    int edgeSpring = springI != -1 ? springI : springJ;
+                    if (edgeSpring == -1 || !springs[edgeSpring].broken) {
+                        fanLabels[find(i)] = find(j);
+                    }
+                }
+            }
+        }
+    }
+
+    int root = find(0);
+    bool split = false;
+    for (int i = 0; i < fanSize; i++) {
+        fanLabels[i] = find(i);
+        if (fanLabels[i] != root) split = true;
+    }
+    if (!split) return;
+
+    // One new point per extra group; faces of that group move to it. The mass
+    // is shared by face count, so tearing never adds mass to the cloth
+    float mass = points[vertex].mass;
+    float faceMass = mass / fanSize;
+    float movedMass = 0.0f;
+    firstCorner[vertex] = -1;
+    for (int i = 0; i < fanSize; i++) {
+        int label = fanLabels[i];
+        if (label == root) {
+            LinkCorner(fanFaces[i], vertex);
+            continue;
+        }
+
+        int copy = -1;
+        for (int j = 0; j < i; j++) {
+            if (fanLabels[j] == label) {
+                copy = FaceCorner(faces[fanFaces[j] / 3], fanFaces[j] % 3);
+                break;
+            }
+        }
+        if (copy == -1) {
+            copy = (int)points.size();
+            PointMass duplicate = points[vertex];
+            duplicate.isDragged = false;
+            duplicate.mass = 0.0f;
+            points.push_back(duplicate);
+            firstCorner.push_back(-1);
+            firstSpringEnd.push_back(-1);
+            if (!restPositions.empty()) {
+                restPositions.push_back(restPositions[vertex * 2]);
+                restPositions.push_back(restPositions[vertex * 2 + 1]);
+            }
+        }
+        FaceCorner(faces[fanFaces[i] / 3], fanFaces[i] % 3) = copy;
+        LinkCorner(fanFaces[i], copy);
+        points[copy].mass += faceMass;
+        movedMass += faceMass;
+    }
+    points[vertex].mass = mass - movedMass;
+
+    // Springs follow the group holding their other end, or else the nearest group
+    int end = firstSpringEnd[vertex];
+    firstSpringEnd[vertex] = -1;
+    while (end != -1) {
+        int next = springEndNext[end];
+        Spring& spring = springs[end / 2];
+        int other = (end % 2 == 0) ? spring.point2 : spring.point1;
+
+        int target = vertex;
+        if (!spring.broken) {
+            float bestDistance = 0.0f;
+            for (int i = 0; i < fanSize; i++) {
+                Face& face = faces[fanFaces[i] / 3];
+                int owner = FaceCorner(face, fanFaces[i] % 3);
+                if (face.p1 == other || face.p2 == other || face.p3 == other) {
+                    target = owner;
+                    break;
+                }
+                float cx = (points[face.p1].x + points[face.p2].x + points[face.p3].x) / 3.0f - points[other].x;
+                float cy = (points[face.p1].y + points[face.p2].y + points[face.p3].y) / 3.0f - points[other].y;
+                float distance = cx * cx + cy * cy;
+                if (i == 0 || distance < bestDistance) {
+                    bestDistance = distance;
+                    target = owner;
+                }
+            }
+        }
+
+        if (end % 2 == 0) spring.point1 = target;
+        else spring.point2 = target;
+        LinkSpringEnd(end, target);
+        end = next;
+    }
+
+    topologyVersion++;
+}
@@ -0,0 +1,116 @@
+// Parks a batch of torn, wind-blown cloths in compact storage and reports the
+// bytes held per point and per spring before and after, how long packing and
+// unpacking take, and whether the cloths resume exactly: each compacted cloth
+// is stepped on next to an identical cloth that was never compacted and the
+// state hashes of the two are compared. The exit code is non-zero if any
+// pair differs.
+//
+// Usage: ClothCompactBench [cloths] [resolution] [steps]
+#include "Cloth.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const float FIXED_TIME_STEP = 1.0f / 60.0f;
+
+Cloth* CreateCloth(int resolution, int index) {
+    Cloth* cloth = new Cloth(resolution, resolution, Cloth::GRID_EXTENT / resolution);
+    cloth->SetDeterministic(true);  // Both copies must take the same path for any thread count
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(resolution - 1, 0);
+    cloth->SetMaxStretch(1.3f);     // Tears, so split vertices and stress counters are exercised
+
+    AeroSettings air;
+    air.enabled = true;
+    air.windX = 100.0f + 20.0f * index;
+    air.density = 6e-5f;
+    air.turbulence = 100.0f;
+    cloth->SetAerodynamics(air);
+    return cloth;
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 8;
+    int resolution = argc > 2 ? atoi(argv[2]) : 60;
+    int steps = argc > 3 ? atoi(argv[3]) : 120;
+    if (count < 1 || resolution < 2 || steps < 1) {
+        fprintf(stderr, "Usage: %s [cloths] [resolution] [steps]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Cloth*> cloths, twins;
+    for (int i = 0; i < count; i++) {
+        cloths.push_back(CreateCloth(resolution, i));
+        twins.push_back(CreateCloth(resolution, i));
+    }
+    for (int i = 0; i < count; i++) {
+        cloths[i]->Step(steps, FIXED_TIME_STEP);
+        cloths[i]->Update(0.0f, 0.5f);  // Leave render positions between frames
+        twins[i]->Step(steps, FIXED_TIME_STEP);
+        twins[i]->Update(0.0f, 0.5f);
+    }
+
+    long long points = 0, springs = 0, broken = 0;
+    size_t fullBytes = 0;
+    for (Cloth* cloth : cloths) {
+        points += cloth->GetPoints().size();
+        springs += cloth->GetSprings().size();
+        broken += cloth->GetBrokenSpringCount();
+        fullBytes += cloth->GetStateBytes();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int parked = 0;
+    for (Cloth* cloth : cloths) parked += cloth->Compact() ? 1 : 0;
+    double compactMs = Milliseconds(start);
+    size_t compactBytes = 0;
+    for (Cloth* cloth : cloths) compactBytes += cloth->GetStateBytes();
+
+    // Record sizes: exact position and velocity, two 16-bit offset pairs, a
+    // mass index and flags per point plus a share of the tile origin
+    double pointRecord = sizeof(PointMass);
+    double pointCompact = 4 * sizeof(float) + 4 * sizeof(uint16_t) + 2 * sizeof(uint8_t) +
+                          4.0 * sizeof(float) / CompactState::TILE_POINTS;
+    double springRecord = sizeof(Spring);
+    double springCompact = 2 * sizeof(int) + sizeof(float) + 3 * sizeof(uint8_t);
+
+    printf("%d cloths of %dx%d after %d steps: %lld points, %lld springs, %lld broken, %d/%d compacted\n",
+           count, resolution, resolution, steps, points, springs, broken, parked, count);
+    printf("%-26s %10s %10s %10s\n", "", "full", "compact", "saved");
+    printf("%-26s %10.2f %10.2f %10.2f\n", "bytes per point record", pointRecord, pointCompact,
+           pointRecord - pointCompact);
+    printf("%-26s %10.2f %10.2f %10.2f\n", "bytes per spring record", springRecord, springCompact,
+           springRecord - springCompact);
+    printf("%-26s %10.2f %10.2f %10.2f\n", "held per point + spring", (double)fullBytes / (points + springs),
+           (double)compactBytes / (points + springs), (double)(fullBytes - compactBytes) / (points + springs));
+    printf("%-26s %10.2f %10.2f %9.1f%%\n", "held in total (MiB)", fullBytes / 1048576.0, compactBytes / 1048576.0,
+           100.0 * (fullBytes - compactBytes) / fullBytes);
+
+    // Stepping expands the cloth again; the twins were never compacted
+    start = std::chrono::steady_clock::now();
+    for (Cloth* cloth : cloths) cloth->Expand();
+    double expandMs = Milliseconds(start);
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        cloths[i]->Step(steps, FIXED_TIME_STEP);
+        twins[i]->Step(steps, FIXED_TIME_STEP);
+        if (cloths[i]->GetStateHash() != twins[i]->GetStateHash()) mismatches++;
+    }
+    printf("compact %.2f ms, expand %.2f ms, %d of %d cloths resumed differently\n",
+           compactMs, expandMs, mismatches, count);
+
+    for (int i = 0; i < count; i++) {
+        delete cloths[i];
+        delete twins[i];
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// Headless checks that every public call on a parked cloth is safe: calls
+// that touch points or springs expand it first and keep their effect, the
+// metrics read the compact arrays and match the expanded cloth, and writers
+// refuse a parked cloth instead of saving an empty one. Prints each failed
+// check; the exit code is non-zero if any failed.
+//
+// Usage: ClothCompactTest
+#include "Cloth.h"
+#include "DirtyTiles.h"
+#include "SceneFile.h"
+#include "SoftRenderer.h"
+#include "TestHarness.h"
+#ifndef _WIN32
+#include "StatePublisher.h"
+#endif
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+namespace {
+
+const int RESOLUTION = 12;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+// A hanging cloth that has moved for a while, parked
+std::unique_ptr<Cloth> Parked() {
+    std::unique_ptr<Cloth> cloth(Cloth::CreateWithResolution(RESOLUTION));
+    cloth->SetScheduler(nullptr);
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(RESOLUTION - 1, 0);
+    cloth->Step(30, FRAME_TIME);
+    cloth->Update(0.0f, 0.5f);
+    Check(cloth->Compact() && cloth->IsCompact(), "a plain cloth parks");
+    return cloth;
+}
+
+// Runs call on a parked cloth; it must leave the cloth expanded and pass check
+void CheckExpands(const char* what, const std::function<void(Cloth&)>& call,
+                  const std::function<bool(Cloth&)>& check = nullptr) {
+    std::unique_ptr<Cloth> cloth = Parked();
+    call(*cloth);
+    Check(!cloth->IsCompact() && (!check || check(*cloth)), what);
+}
+
+void TestMetrics() {
+    std::unique_ptr<Cloth> cloth(Cloth::CreateWithResolution(RESOLUTION));
+    cloth->SetScheduler(nullptr);
+    cloth->FixPoint(0, 0);
+    cloth->SetGravity(3.0f);  // Hard enough to tear at the pin
+    cloth->Step(120, FRAME_TIME);
+    int broken = cloth->GetBrokenSpringCount();
+    float strain = cloth->GetMaxStrain();
+    float energy = cloth->GetEnergy();
+    float elastic = cloth->GetElasticEnergy();
+    unsigned long long hash = cloth->GetStateHash();
+
+    Check(cloth->Compact(), "a stepped cloth parks");
+    Check(cloth->GetBrokenSpringCount() == broken, "parked broken spring count matches");
+    Check(cloth->GetMaxStrain() == strain, "parked max strain matches");
+    Check(cloth->GetEnergy() == energy, "parked energy matches");
+    Check(cloth->GetElasticEnergy() == elastic, "parked elastic energy matches");
+    Check(cloth->GetStateHash() == hash, "parked state hash matches");
+    Check(cloth->IsCompact(), "metrics leave the cloth parked");
+    Check(cloth->GetWidth() == RESOLUTION && cloth->GetHeight() == RESOLUTION, "parked size is kept");
+    Check(!cloth->GetFaces().empty(), "faces stay available while parked");
+}
+
+void TestMutators() {
+    CheckExpands("Update expands", [](Cloth& c) { c.Update(FRAME_TIME); });
+    CheckExpands("Step expands", [](Cloth& c) { c.Step(2, FRAME_TIME); });
+    CheckExpands("Reset expands", [](Cloth& c) { c.Reset(); });
+    CheckExpands("SetResolution expands", [](Cloth& c) { c.SetResolution(8, 8); },
+                 [](Cloth& c) { return (int)c.GetPoints().size() == 64; });
+    CheckExpands("FixPoint keeps the pin", [](Cloth& c) { c.FixPoint(3, 3); },
+                 [](Cloth& c) { return c.GetPoints()[3 * RESOLUTION + 3].isFixed; });
+    CheckExpands("SetOrigin moves the points", [](Cloth& c) { c.SetOrigin(150.0f, 100.0f); },
+                 [](Cloth& c) { return c.GetPoints()[0].x == 150.0f; });
+    CheckExpands("SetMaxStretch keeps the setting", [](Cloth& c) { c.SetMaxStretch(2.5f); },
+                 [](Cloth& c) { return c.GetSprings()[0].maxStretch == 2.5f; });
+    CheckExpands("SetStiffness keeps the setting", [](Cloth& c) { c.SetStiffness(0.3f); },
+                 [](Cloth& c) { return c.GetSprings()[0].stiffness == 0.3f * ClothKernels::STIFFNESS_SCALE; });
+    CheckExpands("SetDamping keeps the setting", [](Cloth& c) { c.SetDamping(0.3f); },
+                 [](Cloth& c) { return c.GetSprings()[0].damping == 0.3f * ClothKernels::DAMPING_SCALE; });
+    CheckExpands("SetMaterial keeps the curve", [](Cloth& c) {
+        c.SetMaterial(FAMILY_SHEAR, MaterialModel().WithHysteresis(0.5f, 1.0f));
+    }, [](Cloth& c) { return c.GetMaterial(FAMILY_SHEAR).hysteretic; });
+    CheckExpands("SetRenderDetail builds the detail grid", [](Cloth& c) { c.SetRenderDetail(2); },
+                 [](Cloth& c) { return c.GetDetailWidth() == (RESOLUTION - 1) * 2 + 1; });
+    CheckExpands("MarkDirtyTiles expands", [](Cloth& c) {
+        DirtyTileMap tiles;
+        tiles.Resize(800, 600);
+        c.MarkDirtyTiles(tiles);
+    });
+    CheckExpands("AppendDrawList draws the cloth", [](Cloth& c) {
+        DrawList list;
+        c.AppendDrawList(list);
+        Check(!list.primitives.empty(), "a parked cloth still draws");
+    });
+    CheckExpands("a drag can start on a parked cloth", [](Cloth& c) {
+        c.HandleMouseDown(100, 100);  // The pinned corner stays at the origin
+        c.HandleMouseMove(110, 120);
+    }, [](Cloth& c) { return c.IsDragging(); });
+    CheckExpands("GetPointData expands", [](Cloth& c) { Check(c.GetPointData() != nullptr, "point data is there"); });
+
+    // A drag in progress when the cloth is parked ends on the expanded point
+    std::unique_ptr<Cloth> cloth(Cloth::CreateWithResolution(RESOLUTION));
+    cloth->HandleMouseDown(100, 100);
+    Check(cloth->IsDragging() && cloth->Compact(), "a cloth parks mid-drag");
+    cloth->HandleMouseUp();
+    Check(!cloth->IsCompact() && !cloth->IsDragging() && !cloth->GetPoints()[0].isDragged,
+          "releasing the mouse ends the drag on a parked cloth");
+}
+
+void TestUnchanged() {
+    // Settings outside the point and spring arrays are kept without expanding
+    std::unique_ptr<Cloth> cloth = Parked();
+    cloth->SetGravity(0.2f);
+    cloth->AddForce(10.0f, 0.0f);
+    cloth->ClearForceFields();
+    cloth->SetMinSubsteps(2);
+    cloth->SetSelfCollisionInterval(2);
+    cloth->SetWireVisibility(false);
+    cloth->SetDeterministic(true);
+    cloth->SetProjective(true);
+    cloth->SetProjectiveIterations(5);
+    Check(cloth->IsCompact(), "settings leave the cloth parked");
+    Check(cloth->GetGravityForce() == 0.2f * ClothKernels::GRAVITY_SCALE, "gravity is kept while parked");
+    cloth->Expand();
+    cloth->Step(2, FRAME_TIME);
+    Check(cloth->GetSubsteps() >= 2 && cloth->GetRollbackCount() == 0, "a parked projective cloth resumes");
+}
+
+void TestWriters() {
+    std::unique_ptr<Cloth> cloth = Parked();
+    std::vector<const Cloth*> cloths = {cloth.get()};
+    Check(!SceneFile::Write("compact_test.scene", cloths), "a parked cloth is not written");
+#ifndef _WIN32
+    StatePublisher publisher;
+    Check(!publisher.Open(*cloth, "/cloth_compact_test"), "a parked cloth is not published");
+#endif
+    Check(cloth->IsCompact(), "refused writes leave the cloth parked");
+    std::remove("compact_test.scene");
+}
+
+} // namespace
+
+int main() {
+    TestMetrics();
+    TestMutators();
+    TestUnchanged();
+    TestWriters();
+    return FinishChecks("compact storage");
+}
@@ -0,0 +1,256 @@
+// Local simulation daemon and its bundled client. By default it serves warm
+// cloth instances on a Unix socket until interrupted or asked to shut down.
+// With --client it runs concurrent client threads against a running daemon;
+// each query opens a preset, steps it, reads the snapshot from shared memory,
+// queries the metrics and releases the instance. --self-test serves and runs
+// the clients in one process, checking every state hash against a cloth
+// simulated locally.
+//
+// Usage: ClothDaemon [--socket path] [--window ms] [--park seconds] [--threads N]
+//        ClothDaemon --client [--socket path] [--clients N] [--queries N] [--resolution N]
+//                    [--seconds S] [--verify] [--shutdown]
+//        ClothDaemon --self-test [same client options]
+#include "Cloth.h"
+#include "SimulationDaemon.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const float FIXED_TIME_STEP = 1.0f / 60.0f;
+
+SimulationDaemon* serving = nullptr;
+
+void HandleSignal(int) {
+    if (serving) serving->Stop();
+}
+
+struct ClientOptions {
+    int clients = 4;
+    int queries = 8;
+    int resolution = 40;
+    double seconds = 2.0;
+    bool verify = false;
+    bool shutdown = false;
+};
+
+struct QueryResult {
+    double latencyMs;
+    int batchSize;
+    bool verified;
+};
+
+// Presets vary a little between queries so several templates stay warm
+DaemonProtocol::Preset MakePreset(const ClientOptions& options, int client, int query) {
+    DaemonProtocol::Preset preset = DaemonProtocol::GridPreset(options.resolution);
+    preset.gravity = 0.4f + 0.1f * ((client + query) % 3);
+    if (options.verify) preset.flags |= DaemonProtocol::FLAG_DETERMINISTIC;
+    return preset;
+}
+
+// Builds the preset from scratch, as a tool without the daemon would
+Cloth* BuildLocally(const DaemonProtocol::Preset& preset) {
+    Cloth* cloth = Cloth::CreateWithResolution(preset.resolution);
+    cloth->SetScheduler(nullptr);
+    cloth->SetGravity(preset.gravity);
+    cloth->SetStiffness(preset.stiffness);
+    cloth->SetDamping(preset.damping);
+    cloth->SetMaxStretch(preset.maxStretch);
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(preset.resolution - 1, 0);
+    cloth->SetDeterministic((preset.flags & DaemonProtocol::FLAG_DETERMINISTIC) != 0);
+    return cloth;
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool RunClient(const std::string& socketPath, const ClientOptions& options, int client,
+               std::vector<QueryResult>& results) {
+    DaemonClient connection;
+    if (!connection.Connect(socketPath)) return false;
+    int frames = std::max(1, (int)(options.seconds / FIXED_TIME_STEP + 0.5));
+
+    for (int query = 0; query < options.queries; query++) {
+        DaemonProtocol::Preset preset = MakePreset(options, client, query);
+        QueryResult result = {0.0, 0, false};
+        auto start = std::chrono::steady_clock::now();
+
+        int instance = connection.Open(preset);
+        DaemonProtocol::Response stepped, metrics;
+        float lowest = 0.0f;
+        if (instance < 0 || !connection.Step(instance, frames, FIXED_TIME_STEP, &stepped) ||
+            !connection.Snapshot(instance, [&lowest](const SharedState::FrameView& view) {
+                lowest = -1e30f;
+                for (uint32_t i = 0; i < view.pointCount; i++) lowest = std::max(lowest, view.positions[i * 2 + 1]);
+            }) ||
+            !connection.Query(instance, metrics) || !connection.Release(instance)) {
+            fprintf(stderr, "Client %d: query %d failed\n", client, query);
+            return false;
+        }
+        result.latencyMs = Milliseconds(start);
+        result.batchSize = stepped.batchSize;
+
+        if (options.verify) {
+            Cloth* local = BuildLocally(preset);
+            local->Step(frames, FIXED_TIME_STEP);
+            result.verified = local->GetStateHash() == metrics.stateHash;
+            delete local;
+        }
+        if (query == 0 && client == 0) {
+            printf("t=%.2f s  points %d  broken %d  lowest point y=%.1f  energy %.1f  hash %016llx\n", metrics.time,
+                   metrics.pointCount, metrics.brokenSprings, lowest, metrics.energy,
+                   (unsigned long long)metrics.stateHash);
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+int RunClients(const std::string& socketPath, const ClientOptions& options) {
+    std::vector<std::vector<QueryResult>> results(options.clients);
+    std::vector<char> succeeded(options.clients, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < options.clients; c++) {
+        threads.emplace_back([&, c]() { succeeded[c] = RunClient(socketPath, options, c, results[c]); });
+    }
+    for (auto& thread : threads) thread.join();
+    double wallMs = Milliseconds(start);
+
+    std::vector<double> latencies;
+    double batchSum = 0.0;
+    int verified = 0;
+    for (const auto& clientResults : results) {
+        for (const QueryResult& result : clientResults) {
+            latencies.push_back(result.latencyMs);
+            batchSum += result.batchSize;
+            verified += result.verified;
+        }
+    }
+    int failedClients = (int)std::count(succeeded.begin(), succeeded.end(), 0);
+    if (latencies.empty()) {
+        fprintf(stderr, "No daemon answered on %s\n", socketPath.c_str());
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    int count = (int)latencies.size();
+    printf("%d clients x %d queries of %.1f s on %dx%d cloths: %d answered in %.0f ms\n", options.clients,
+           options.queries, options.seconds, options.resolution, options.resolution, count, wallMs);
+    printf("latency  median %.1f ms  p90 %.1f ms  max %.1f ms\n", latencies[count / 2],
+           latencies[std::min(count - 1, count * 9 / 10)], latencies[count - 1]);
+    printf("steps shared their last batch with %.2f steps on average\n", batchSum / count);
+    if (options.verify) printf("%d of %d state hashes match local runs\n", verified, count);
+
+    if (options.shutdown) {
+        DaemonClient control;
+        if (!control.Connect(socketPath) || !control.Shutdown()) fprintf(stderr, "Shutdown request failed\n");
+    }
+    bool ok = failedClients == 0 && (!options.verify || verified == count);
+    return ok ? 0 : 1;
+}
+
+void PrintStats(const SimulationDaemon& daemon) {
+    const SimulationDaemon::Stats& stats = daemon.GetStats();
+    printf("%llu requests, %llu batches of %.2f steps on average (largest %d), %d templates built, "
+           "%d instances opened, %d parked\n",
+           (unsigned long long)stats.requests, (unsigned long long)stats.batches,
+           stats.batches ? (double)stats.batchedSteps / stats.batches : 0.0, stats.largestBatch,
+           stats.templatesBuilt, stats.instancesOpened, stats.instancesParked);
+    if (stats.templatesBuilt && stats.instancesOpened) {
+        printf("building a template took %.3f ms, opening an instance from one %.3f ms\n",
+               stats.buildMs / stats.templatesBuilt, stats.openMs / stats.instancesOpened);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string socketPath = DaemonProtocol::DEFAULT_SOCKET;
+    std::string mode = "serve";
+    ClientOptions options;
+    int window = 0;
+    double park = 5.0;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--client") == 0) {
+            mode = "client";
+        } else if (strcmp(argv[i], "--self-test") == 0) {
+            mode = "self-test";
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            window = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--park") == 0 && i + 1 < argc) {
+            park = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            options.clients = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            options.queries = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            options.resolution = std::max(2, std::min(SimulationDaemon::MAX_RESOLUTION, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = std::max(0.0, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            options.verify = true;
+        } else if (strcmp(argv[i], "--shutdown") == 0) {
+            options.shutdown = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--client | --self-test] [--socket path] [--window ms] [--park seconds] "
+                            "[--threads N] [--clients N] [--queries N] [--resolution N] [--seconds S] [--verify] "
+                            "[--shutdown]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (mode == "client") return RunClients(socketPath, options);
+
+    TaskScheduler* pool = threads > 0 ? new TaskScheduler(threads) : &TaskScheduler::Default();
+    SimulationDaemon daemon;
+    daemon.SetScheduler(pool);
+    daemon.SetBatchWindow(window);
+    daemon.SetParkTimeout(park);
+    if (mode == "self-test" && socketPath == DaemonProtocol::DEFAULT_SOCKET) {
+        socketPath = "/tmp/cloth_daemon_test_" + std::to_string((long long)getpid()) + ".sock";
+    }
+    if (!daemon.Open(socketPath)) {
+        fprintf(stderr, "Could not listen on %s (is a daemon already running?)\n", socketPath.c_str());
+        return 1;
+    }
+
+    int result = 0;
+    if (mode == "self-test") {
+        options.verify = true;
+        options.shutdown = true;
+        std::thread server([&daemon]() { daemon.Serve(); });
+        result = RunClients(socketPath, options);
+        daemon.Stop();  // In case the clients failed before asking
+        server.join();
+    } else {
+        serving = &daemon;
+        signal(SIGINT, HandleSignal);
+        signal(SIGTERM, HandleSignal);
+        printf("Serving on %s\n", socketPath.c_str());
+        if (!daemon.Serve()) result = 1;
+        serving = nullptr;
+    }
+    PrintStats(daemon);
+    daemon.Close();
+    if (pool != &TaskScheduler::Default()) delete pool;
+    return result;
+}
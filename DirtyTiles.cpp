@@ -0,0 +1,89 @@
+#include "DirtyTiles.h"
+#include <algorithm>
+
+DirtyTileMap::DirtyTileMap() : width(0), height(0), tilesX(0), tilesY(0), dirtyCount(0) {}
+
+void DirtyTileMap::Resize(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    tiles.assign(tilesX * tilesY, 0);
+    MarkAll();
+}
+
+void DirtyTileMap::Clear() {
+    std::fill(tiles.begin(), tiles.end(), 0);
+    dirtyCount = 0;
+}
+
+void DirtyTileMap::MarkAll() {
+    std::fill(tiles.begin(), tiles.end(), 1);
+    dirtyCount = (int)tiles.size();
+}
+
+bool DirtyTileMap::ToTileRange(float left, float top, float right, float bottom,
+                               int& x0, int& y0, int& x1, int& y1) const {
+    if (tiles.empty() || !(left <= right) || !(top <= bottom)) return false;
+
+    // Clamp in float first so far off-screen (or non-finite) positions cannot overflow
+    left = std::max(left, 0.0f);
+    top = std::max(top, 0.0f);
+    right = std::min(right, (float)width - 1.0f);
+    bottom = std::min(bottom, (float)height - 1.0f);
+    if (left > right || top > bottom) return false;
+
+    x0 = (int)left / TILE_SIZE;
+    y0 = (int)top / TILE_SIZE;
+    x1 = (int)right / TILE_SIZE;
+    y1 = (int)bottom / TILE_SIZE;
+    return true;
+}
+
+void DirtyTileMap::MarkRect(float left, float top, float right, float bottom) {
+    int x0, y0, x1, y1;
+    if (!ToTileRange(left, top, right, bottom, x0, y0, x1, y1)) return;
+
+    for (int ty = y0; ty <= y1; ty++) {
+        unsigned char* row = &tiles[ty * tilesX];
+        for (int tx = x0; tx <= x1; tx++) {
+            dirtyCount += row[tx] == 0;
+            row[tx] = 1;
+        }
+    }
+}
+
+bool DirtyTileMap::Intersects(float left, float top, float right, float bottom) const {
+    int x0, y0, x1, y1;
+    if (!ToTileRange(left, top, right, bottom, x0, y0, x1, y1)) return false;
+
+    for (int ty = y0; ty <= y1; ty++) {
+        const unsigned char* row = &tiles[ty * tilesX];
+        for (int tx = x0; tx <= x1; tx++) {
+            if (row[tx]) return true;
+        }
+    }
+    return false;
+}
+
+void DirtyTileMap::GetDirtyRects(std::vector<Rect>& rects) const {
+    rects.clear();
+    for (int ty = 0; ty < tilesY; ty++) {
+        int tx = 0;
+        while (tx < tilesX) {
+            if (!tiles[ty * tilesX + tx]) {
+                tx++;
+                continue;
+            }
+            int start = tx;
+            while (tx < tilesX && tiles[ty * tilesX + tx]) tx++;
+
+            Rect rect;
+            rect.left = start * TILE_SIZE;
+            rect.top = ty * TILE_SIZE;
+            rect.right = std::min(tx * TILE_SIZE, width);
+            rect.bottom = std::min((ty + 1) * TILE_SIZE, height);
+            rects.push_back(rect);
+        }
+    }
+}
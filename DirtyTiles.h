@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+
+// Screen split into fixed-size tiles with a dirty bit each. The cloth marks
+// the tiles its geometry covered last frame and covers now, and the paint
+// path only clears, redraws and presents those tiles.
+class DirtyTileMap {
+public:
+    static const int TILE_SIZE = 32;  // Pixels per tile side
+
+    struct Rect {
+        int left, top, right, bottom;  // Pixels, right/bottom exclusive
+    };
+
+    DirtyTileMap();
+
+    void Resize(int width, int height);  // Marks everything dirty
+    void Clear();
+    void MarkAll();
+    void MarkRect(float left, float top, float right, float bottom);
+
+    bool Intersects(float left, float top, float right, float bottom) const;
+    bool IsDirty(int tileX, int tileY) const { return tiles[tileY * tilesX + tileX] != 0; }
+    bool IsEmpty() const { return dirtyCount == 0; }
+    int GetDirtyCount() const { return dirtyCount; }
+    int GetTilesX() const { return tilesX; }
+    int GetTilesY() const { return tilesY; }
+
+    // Dirty tiles merged into horizontal runs, one rectangle per run
+    void GetDirtyRects(std::vector<Rect>& rects) const;
+
+private:
+    int width, height;
+    int tilesX, tilesY;
+    std::vector<unsigned char> tiles;
+    int dirtyCount;
+
+    bool ToTileRange(float left, float top, float right, float bottom,
+                     int& x0, int& y0, int& x1, int& y1) const;
+};
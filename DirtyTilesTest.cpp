@@ -0,0 +1,198 @@
+// Headless checks for the dirty-tile map and the footprints the cloth marks
+// in it: clamping at the screen edges, merging tiles into runs, and the
+// old and new footprint of moved or recoloured geometry. Prints each failed
+// check; the exit code is non-zero if any failed.
+//
+// Usage: ClothDirtyTilesTest
+#include "Cloth.h"
+#include "DirtyTiles.h"
+#include "TestHarness.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const int T = DirtyTileMap::TILE_SIZE;
+
+bool SameTiles(const DirtyTileMap& a, const DirtyTileMap& b) {
+    if (a.GetTilesX() != b.GetTilesX() || a.GetTilesY() != b.GetTilesY()) return false;
+    for (int ty = 0; ty < a.GetTilesY(); ty++) {
+        for (int tx = 0; tx < a.GetTilesX(); tx++) {
+            if (a.IsDirty(tx, ty) != b.IsDirty(tx, ty)) return false;
+        }
+    }
+    return true;
+}
+
+void TestClamping() {
+    DirtyTileMap tiles;
+    tiles.Resize(3 * T + 4, 2 * T + 6);  // Partial tiles on the right and bottom
+    Check(tiles.GetTilesX() == 4 && tiles.GetTilesY() == 3, "partial tiles are counted");
+
+    tiles.Clear();
+    tiles.MarkRect(-500.0f, -500.0f, 10.0f, 10.0f);
+    Check(tiles.GetDirtyCount() == 1 && tiles.IsDirty(0, 0), "rect past the top left clamps to the first tile");
+
+    tiles.Clear();
+    tiles.MarkRect(3 * T + 1.0f, 2 * T + 1.0f, 1e9f, 1e9f);
+    Check(tiles.GetDirtyCount() == 1 && tiles.IsDirty(3, 2), "rect past the bottom right clamps to the last tile");
+
+    std::vector<DirtyTileMap::Rect> rects;
+    tiles.GetDirtyRects(rects);
+    Check(rects.size() == 1 && rects[0].left == 3 * T && rects[0].top == 2 * T && rects[0].right == 3 * T + 4 &&
+              rects[0].bottom == 2 * T + 6,
+          "edge tile rect stops at the screen edge");
+
+    tiles.Clear();
+    tiles.MarkRect(-100.0f, -100.0f, -1.0f, -1.0f);
+    tiles.MarkRect(5000.0f, 10.0f, 6000.0f, 20.0f);
+    tiles.MarkRect(NAN, 0.0f, 10.0f, 10.0f);
+    tiles.MarkRect(20.0f, 20.0f, 10.0f, 10.0f);
+    Check(tiles.IsEmpty(), "off-screen, non-finite and inverted rects mark nothing");
+
+    tiles.MarkRect(T - 1.0f, 0.0f, T + 0.0f, 0.0f);
+    Check(tiles.GetDirtyCount() == 2 && tiles.IsDirty(0, 0) && tiles.IsDirty(1, 0), "rect across a tile edge marks both");
+    tiles.MarkRect(T - 1.0f, 0.0f, T + 0.0f, 0.0f);
+    Check(tiles.GetDirtyCount() == 2, "marking a dirty tile again does not count it twice");
+}
+
+void TestRuns() {
+    DirtyTileMap tiles;
+    tiles.Resize(5 * T, 3 * T);
+    tiles.Clear();
+    tiles.MarkRect(0.0f, T + 1.0f, 2 * T - 1.0f, T + 1.0f);  // Tiles 0 and 1 of row 1
+    tiles.MarkRect(3 * T + 1.0f, T + 1.0f, 3 * T + 1.0f, T + 1.0f);
+    tiles.MarkRect(4 * T + 1.0f, 2 * T + 1.0f, 4 * T + 1.0f, 2 * T + 1.0f);
+
+    std::vector<DirtyTileMap::Rect> rects;
+    tiles.GetDirtyRects(rects);
+    Check(rects.size() == 3, "adjacent tiles merge, gaps and rows split runs");
+    if (rects.size() == 3) {
+        Check(rects[0].left == 0 && rects[0].right == 2 * T && rects[0].top == T && rects[0].bottom == 2 * T,
+              "first run spans two tiles");
+        Check(rects[1].left == 3 * T && rects[1].right == 4 * T && rects[1].top == T, "second run is one tile");
+        Check(rects[2].left == 4 * T && rects[2].top == 2 * T && rects[2].bottom == 3 * T, "third run is on the next row");
+    }
+}
+
+void TestMarkAll() {
+    DirtyTileMap tiles;
+    tiles.Resize(4 * T + 1, 2 * T);
+    Check(tiles.GetDirtyCount() == 5 * 2, "Resize marks everything");
+    tiles.Clear();
+    Check(tiles.IsEmpty(), "Clear empties the map");
+    tiles.MarkAll();
+    Check(tiles.GetDirtyCount() == 5 * 2, "MarkAll marks every tile");
+
+    std::vector<DirtyTileMap::Rect> rects;
+    tiles.GetDirtyRects(rects);
+    Check(rects.size() == 2, "MarkAll gives one run per row");
+    for (const auto& rect : rects) Check(rect.left == 0 && rect.right == 4 * T + 1, "runs span the full width");
+}
+
+// Cloth render positions match the simulation, as after UpdateInterpolation(1)
+Cloth* MakeCloth(bool wires) {
+    Cloth* cloth = new Cloth(10, 10, 20.0f);
+    cloth->SetWireVisibility(wires);
+    PointMass* points = cloth->GetPointData();
+    for (size_t i = 0; i < cloth->GetPoints().size(); i++) {
+        points[i].renderX = points[i].x;
+        points[i].renderY = points[i].y;
+    }
+    return cloth;
+}
+
+void TestClothFootprint() {
+    const float pad = 4.0f;  // Cloth::DRAW_PADDING
+    Cloth* cloth = MakeCloth(false);
+    DirtyTileMap tiles;
+    tiles.Resize(800, 600);
+    tiles.Clear();
+
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.GetDirtyCount() == tiles.GetTilesX() * tiles.GetTilesY(), "first report marks everything");
+    tiles.Clear();
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsEmpty(), "unchanged cloth marks nothing");
+
+    PointMass* points = cloth->GetPointData();
+    points[0].renderX += 0.4f;  // Same pixel
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsEmpty(), "sub-pixel motion marks nothing");
+
+    // Move an interior point far enough to cross tiles; faces around it mark old and new positions
+    int moved = 4 * 10 + 4;
+    float oldX = points[moved].renderX, oldY = points[moved].renderY;
+    points[moved].renderX += 3.0f * T;
+    points[moved].renderY += 2.0f * T;
+    DirtyTileMap expected;
+    expected.Resize(800, 600);
+    expected.Clear();
+    for (const Face& face : cloth->GetFaces()) {
+        if (face.p1 != moved && face.p2 != moved && face.p3 != moved) continue;
+        float left = std::fmin(oldX, points[moved].renderX), right = std::fmax(oldX, points[moved].renderX);
+        float top = std::fmin(oldY, points[moved].renderY), bottom = std::fmax(oldY, points[moved].renderY);
+        for (int i : {face.p1, face.p2, face.p3}) {
+            left = std::fmin(left, points[i].renderX);
+            right = std::fmax(right, points[i].renderX);
+            top = std::fmin(top, points[i].renderY);
+            bottom = std::fmax(bottom, points[i].renderY);
+        }
+        expected.MarkRect(left - pad, top - pad, right + pad, bottom + pad);
+    }
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsDirty((int)oldX / T, (int)oldY / T), "old position is dirty");
+    Check(tiles.IsDirty((int)points[moved].renderX / T, (int)points[moved].renderY / T), "new position is dirty");
+    Check(SameTiles(tiles, expected), "dirty tiles are the old and new footprint of the faces around the point");
+    Check(!tiles.IsDirty(tiles.GetTilesX() - 1, tiles.GetTilesY() - 1), "far tiles stay clean");
+
+    // A face whose shade changes is redrawn even if it did not move on screen
+    tiles.Clear();
+    points[0].x += 15.0f;
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsDirty((int)points[0].renderX / T, (int)points[0].renderY / T), "recoloured face is dirty");
+    Check(!tiles.IsDirty(tiles.GetTilesX() - 1, tiles.GetTilesY() - 1), "recolouring leaves far tiles clean");
+    delete cloth;
+}
+
+void TestClothWires() {
+    Cloth* cloth = MakeCloth(true);
+    DirtyTileMap tiles;
+    tiles.Resize(800, 600);
+    cloth->MarkDirtyTiles(tiles);
+    tiles.Clear();
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsEmpty(), "unchanged cloth with wires marks nothing");
+
+    // Pinning changes the point marker's color only
+    cloth->FixPoint(9, 9);
+    const PointMass& corner = cloth->GetPoints()[9 * 10 + 9];
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsDirty((int)corner.renderX / T, (int)corner.renderY / T), "pinned point is dirty");
+    Check(tiles.GetDirtyCount() <= 4, "pinning marks only the point's marker");
+
+    // Hiding wires uncovers every marker; showing them again has no stamps to compare against
+    tiles.Clear();
+    cloth->SetWireVisibility(false);
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsDirty((int)corner.renderX / T, (int)corner.renderY / T), "hiding wires marks the old markers");
+    Check(!tiles.IsDirty(tiles.GetTilesX() - 1, tiles.GetTilesY() - 1), "hiding wires leaves far tiles clean");
+    tiles.Clear();
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.IsEmpty(), "hidden wires mark nothing once they are gone");
+    cloth->SetWireVisibility(true);
+    cloth->MarkDirtyTiles(tiles);
+    Check(tiles.GetDirtyCount() == tiles.GetTilesX() * tiles.GetTilesY(), "showing wires marks everything");
+    delete cloth;
+}
+
+} // namespace
+
+int main() {
+    TestClamping();
+    TestRuns();
+    TestMarkAll();
+    TestClothFootprint();
+    TestClothWires();
+    return FinishChecks("dirty-tile");
+}
@@ -0,0 +1,300 @@
+#include "DomainDecomposition.h"
+#include "Cloth.h"
+#include "ClothKernels.h"
+#include <algorithm>
+#include <cmath>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+void DecomposedCloth::SpinBarrier::Wait() {
+    int mySense = sense.load(std::memory_order_acquire);
+    if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+        waiting.store(0, std::memory_order_relaxed);
+        sense.store(1 - mySense, std::memory_order_release);
+    } else {
+        while (sense.load(std::memory_order_acquire) == mySense) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+DecomposedCloth::DecomposedCloth(int width, int height, float spacing, int tilesX, int tilesY)
+    : width(width), height(height), spacing(spacing),
+      tilesX(std::max(1, std::min(tilesX, width))), tilesY(std::max(1, std::min(tilesY, height))),
+      gravityForce(ClothKernels::DEFAULT_GRAVITY), springStiffness(ClothKernels::DEFAULT_STIFFNESS),
+      springDamping(ClothKernels::DEFAULT_DAMPING),
+      barrier(this->tilesX * this->tilesY), generation(0), finishedWorkers(0), stopping(false),
+      jobSteps(0), jobDt(0.0f) {
+    // Even split of columns and rows between tiles
+    for (int i = 0; i <= this->tilesX; i++) columnStart.push_back(width * i / this->tilesX);
+    for (int i = 0; i <= this->tilesY; i++) rowStart.push_back(height * i / this->tilesY);
+
+    // Subdomain storage is allocated by the owning thread (first touch)
+    int tileCount = this->tilesX * this->tilesY;
+    domains.resize(tileCount);
+    for (int tile = 0; tile < tileCount; tile++) {
+        workers.emplace_back(&DecomposedCloth::WorkerLoop, this, tile);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return finishedWorkers == tileCount; });
+}
+
+DecomposedCloth::~DecomposedCloth() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int DecomposedCloth::TileOfColumn(int x) const {
+    return (int)(std::upper_bound(columnStart.begin(), columnStart.end(), x) - columnStart.begin()) - 1;
+}
+
+int DecomposedCloth::TileOfRow(int y) const {
+    return (int)(std::upper_bound(rowStart.begin(), rowStart.end(), y) - rowStart.begin()) - 1;
+}
+
+int DecomposedCloth::LocalIndex(const Subdomain& d, int gx, int gy) const {
+    return (gy - d.y0 + 1) * d.stride + (gx - d.x0 + 1);
+}
+
+void DecomposedCloth::BuildSubdomain(int tile) {
+    Subdomain& d = domains[tile];
+    int tx = tile % tilesX;
+    int ty = tile / tilesX;
+    d.x0 = columnStart[tx];
+    d.x1 = columnStart[tx + 1];
+    d.y0 = rowStart[ty];
+    d.y1 = rowStart[ty + 1];
+    d.stride = d.x1 - d.x0 + 2;
+
+    // Owned points plus a one-point halo ring
+    size_t cells = (size_t)d.stride * (d.y1 - d.y0 + 2);
+    d.x.assign(cells, 0.0f);
+    d.y.assign(cells, 0.0f);
+    d.vx.assign(cells, 0.0f);
+    d.vy.assign(cells, 0.0f);
+    d.fx.assign(cells, 0.0f);
+    d.fy.assign(cells, 0.0f);
+    d.fixed.assign(cells, 0);
+
+    auto inGrid = [&](int gx, int gy) { return gx >= 0 && gx < width && gy >= 0 && gy < height; };
+    auto owned = [&](int gx, int gy) { return gx >= d.x0 && gx < d.x1 && gy >= d.y0 && gy < d.y1; };
+
+    for (int gy = d.y0 - 1; gy <= d.y1; gy++) {
+        for (int gx = d.x0 - 1; gx <= d.x1; gx++) {
+            if (!inGrid(gx, gy)) continue;
+            int local = LocalIndex(d, gx, gy);
+            d.x[local] = gx * spacing + 100.0f; // Same layout as the Cloth constructor
+            d.y[local] = gy * spacing + 100.0f;
+
+            if (!owned(gx, gy)) {
+                int owner = TileOfRow(gy) * tilesX + TileOfColumn(gx);
+                int ownerStride = columnStart[owner % tilesX + 1] - columnStart[owner % tilesX] + 2;
+                int ownerLocal = (gy - rowStart[owner / tilesX] + 1) * ownerStride +
+                                 (gx - columnStart[owner % tilesX] + 1);
+                d.halo.push_back({local, owner, ownerLocal});
+            }
+        }
+    }
+
+    // Same spring pattern as Cloth::InitializeSprings, keeping every spring with an owned end
+    auto addSpring = [&](int ax, int ay, int bx, int by, float restLength, float stiffness, float damping, float maxStretch) {
+        if (!inGrid(ax, ay) || !inGrid(bx, by)) return;
+        bool ownsA = owned(ax, ay);
+        bool ownsB = owned(bx, by);
+        if (!ownsA && !ownsB) return;
+
+        SubSpring s = {LocalIndex(d, ax, ay), LocalIndex(d, bx, by), restLength, stiffness, damping,
+                       maxStretch, 0, false, ownsA, ownsB};
+        if (ownsA && ownsB) d.interiorSprings.push_back(s);
+        else d.boundarySprings.push_back(s);
+    };
+
+    float diagonal = spacing * std::sqrt(2.0f);
+    float shearStiffness = springStiffness * ClothKernels::SHEAR_STIFFNESS_RATIO;
+    float shearDamping = springDamping * ClothKernels::SHEAR_DAMPING_RATIO;
+    const float structural = ClothKernels::STRUCTURAL_MAX_STRETCH;  // Horizontal only, as Spring::getBreakThreshold
+    const float other = ClothKernels::OTHER_MAX_STRETCH;
+    for (int gy = d.y0 - 1; gy < d.y1; gy++) {
+        for (int gx = d.x0 - 1; gx < d.x1; gx++) {
+            addSpring(gx, gy, gx + 1, gy, spacing, springStiffness, springDamping, structural);
+            addSpring(gx, gy, gx, gy + 1, spacing, springStiffness, springDamping, other);
+            addSpring(gx, gy, gx + 1, gy + 1, diagonal, shearStiffness, shearDamping, other);
+            addSpring(gx + 1, gy, gx, gy + 1, diagonal, shearStiffness, shearDamping, other);
+        }
+    }
+}
+
+void DecomposedCloth::WorkerLoop(int tile) {
+#ifdef __linux__
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(tile % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+    BuildSubdomain(tile);
+
+    unsigned seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishedWorkers++;
+    }
+    done.notify_all();
+
+    Subdomain& d = domains[tile];
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        for (int step = 0; step < jobSteps; step++) {
+            ComputeForces(d);
+            Integrate(d, jobDt);
+            barrier.Wait();   // Neighbours finished writing their owned points
+            ExchangeHalo(d);
+            barrier.Wait();   // Halo reads finished before anyone integrates again
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finishedWorkers++;
+        }
+        done.notify_all();
+    }
+}
+
+void DecomposedCloth::ComputeForces(Subdomain& d) {
+    for (int gy = d.y0; gy < d.y1; gy++) {
+        int row = LocalIndex(d, d.x0, gy);
+        for (int i = row; i < row + (d.x1 - d.x0); i++) {
+            d.fx[i] = 0.0f;
+            d.fy[i] = d.fixed[i] ? 0.0f : gravityForce; // Unit mass
+        }
+    }
+
+    auto applySpring = [&](SubSpring& s, bool applyA, bool applyB) {
+        float dx = d.x[s.b] - d.x[s.a];
+        float dy = d.y[s.b] - d.y[s.a];
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < ClothKernels::MIN_SPRING_LENGTH) return;
+
+        float stretch = length / s.restLength;
+        float force = s.stiffness * Cloth::GetNonlinearForce(stretch);
+        float fx, fy;
+        ClothKernels::SpringForce(dx, dy, length, d.vx[s.b] - d.vx[s.a], d.vy[s.b] - d.vy[s.a], force, s.damping, fx, fy);
+
+        if (applyA && !d.fixed[s.a]) {
+            d.fx[s.a] += fx;
+            d.fy[s.a] += fy;
+        }
+        if (applyB && !d.fixed[s.b]) {
+            d.fx[s.b] -= fx;
+            d.fy[s.b] -= fy;
+        }
+
+        // Same stress accounting as Cloth::CheckSpringBreaking; both owners of a
+        // boundary spring see identical positions and reach the same decision
+        s.stressFrames = ClothKernels::UpdateStress(s.stressFrames, stretch, s.maxStretch);
+        if (ClothKernels::ShouldBreak(stretch, s.maxStretch, s.stressFrames)) s.broken = true;
+    };
+
+    for (auto& s : d.interiorSprings) {
+        if (!s.broken) applySpring(s, true, true);
+    }
+    for (auto& s : d.boundarySprings) {
+        if (!s.broken) applySpring(s, s.ownsA, s.ownsB);
+    }
+}
+
+void DecomposedCloth::Integrate(Subdomain& d, float dt) {
+    float damping = ClothKernels::StepDamping(ClothKernels::VELOCITY_DAMPING, dt);
+    for (int gy = d.y0; gy < d.y1; gy++) {
+        int row = LocalIndex(d, d.x0, gy);
+        for (int i = row; i < row + (d.x1 - d.x0); i++) {
+            if (d.fixed[i]) continue;
+
+            // Boundary collisions and integration, as in Cloth (unit mass)
+            bool clamped = false;
+            ClothKernels::CollideBounds(ClothKernels::WINDOW_BOUNDS, d.x[i], d.y[i], d.vx[i], d.vy[i]);
+            ClothKernels::IntegratePoint(d.x[i], d.y[i], d.vx[i], d.vy[i], d.fx[i], d.fy[i], dt,
+                                         damping, ClothKernels::MAX_VELOCITY, clamped);
+        }
+    }
+}
+
+void DecomposedCloth::ExchangeHalo(Subdomain& d) {
+    for (const auto& link : d.halo) {
+        const Subdomain& owner = domains[link.owner];
+        d.x[link.local] = owner.x[link.ownerLocal];
+        d.y[link.local] = owner.y[link.ownerLocal];
+        d.vx[link.local] = owner.vx[link.ownerLocal];
+        d.vy[link.local] = owner.vy[link.ownerLocal];
+    }
+}
+
+void DecomposedCloth::Step(int steps, float dt) {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobSteps = steps;
+    jobDt = dt;
+    finishedWorkers = 0;
+    generation++;
+    wake.notify_all();
+    done.wait(lock, [&] { return finishedWorkers == (int)domains.size(); });
+}
+
+void DecomposedCloth::FixPoint(int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    // Mark the owner and every halo copy so boundary springs skip it too
+    for (auto& d : domains) {
+        if (x >= d.x0 - 1 && x <= d.x1 && y >= d.y0 - 1 && y <= d.y1) {
+            d.fixed[LocalIndex(d, x, y)] = 1;
+        }
+    }
+}
+
+void DecomposedCloth::SetGravity(float g) {
+    gravityForce = g * ClothKernels::GRAVITY_SCALE;
+}
+
+void DecomposedCloth::SetStiffness(float s) {
+    springStiffness = s * ClothKernels::STIFFNESS_SCALE;
+    for (auto& d : domains) {
+        for (auto& spring : d.interiorSprings) spring.stiffness = springStiffness;
+        for (auto& spring : d.boundarySprings) spring.stiffness = springStiffness;
+    }
+}
+
+void DecomposedCloth::SetDamping(float damping) {
+    springDamping = damping * ClothKernels::DAMPING_SCALE;
+    for (auto& d : domains) {
+        for (auto& spring : d.interiorSprings) spring.damping = springDamping;
+        for (auto& spring : d.boundarySprings) spring.damping = springDamping;
+    }
+}
+
+void DecomposedCloth::GetPositions(std::vector<float>& xy) const {
+    xy.resize((size_t)width * height * 2);
+    for (const auto& d : domains) {
+        for (int gy = d.y0; gy < d.y1; gy++) {
+            for (int gx = d.x0; gx < d.x1; gx++) {
+                int local = LocalIndex(d, gx, gy);
+                xy[((size_t)gy * width + gx) * 2] = d.x[local];
+                xy[((size_t)gy * width + gx) * 2 + 1] = d.y[local];
+            }
+        }
+    }
+}
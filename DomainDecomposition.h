@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Grid cloth split into rectangular subdomains for very large point counts.
+// Each subdomain is owned by one pinned thread that allocates and first
+// touches its own arrays, so memory stays local to that thread's node.
+// Springs with both ends inside a subdomain are interior; springs that cross
+// into a neighbour read a one-point halo ring that is refreshed from the
+// neighbours after every step. Both sides evaluate a boundary spring and
+// each applies the force to its own end only, so no point is written by two
+// threads. Forces, stress, bounds and integration use the same ClothKernels
+// as Cloth, on the default material curve with unit masses.
+//
+// Only that core model is decomposed. Unlike Cloth there is no vertex
+// splitting when springs break (they just stop pulling), no self-collision,
+// no force fields or AddForce, no per-family materials or hysteresis, no
+// aerodynamics, no stability monitor or substeps, no dragging, and none of
+// the deterministic or projective modes.
+class DecomposedCloth {
+private:
+    struct SubSpring {
+        int a, b;            // Local indices (either may be a halo cell for boundary springs)
+        float restLength;
+        float stiffness;
+        float damping;
+        float maxStretch;
+        int stressFrames;
+        bool broken;
+        bool ownsA, ownsB;   // Which ends this subdomain integrates
+    };
+
+    struct HaloLink {
+        int local;           // Halo cell in this subdomain
+        int owner;           // Subdomain that owns the point
+        int ownerLocal;      // Index of the point in the owner's arrays
+    };
+
+    struct Subdomain {
+        int x0, y0, x1, y1;  // Owned grid rectangle [x0, x1) x [y0, y1)
+        int stride;          // Local row length including the halo ring
+        std::vector<float> x, y, vx, vy, fx, fy;
+        std::vector<unsigned char> fixed;
+        std::vector<SubSpring> interiorSprings;
+        std::vector<SubSpring> boundarySprings;
+        std::vector<HaloLink> halo;
+    };
+
+    // Sense-reversing barrier for the per-step phase boundaries
+    class SpinBarrier {
+    private:
+        std::atomic<int> waiting;
+        std::atomic<int> sense;
+        int count;
+    public:
+        explicit SpinBarrier(int count) : waiting(0), sense(0), count(count) {}
+        void Wait();
+    };
+
+    int width, height;
+    float spacing;
+    int tilesX, tilesY;
+    std::vector<int> columnStart;   // tilesX + 1 grid column boundaries
+    std::vector<int> rowStart;      // tilesY + 1 grid row boundaries
+    std::vector<Subdomain> domains;
+    float gravityForce;
+    float springStiffness;
+    float springDamping;
+
+    // Worker control
+    std::vector<std::thread> workers;
+    SpinBarrier barrier;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned generation;
+    int finishedWorkers;
+    bool stopping;
+    int jobSteps;
+    float jobDt;
+
+    void WorkerLoop(int tile);
+    void BuildSubdomain(int tile);
+    void ComputeForces(Subdomain& d);
+    void Integrate(Subdomain& d, float dt);
+    void ExchangeHalo(Subdomain& d);
+    int TileOfColumn(int x) const;
+    int TileOfRow(int y) const;
+    int LocalIndex(const Subdomain& d, int gx, int gy) const;
+
+public:
+    DecomposedCloth(int width, int height, float spacing, int tilesX, int tilesY);
+    ~DecomposedCloth();
+
+    void Step(int steps, float dt);
+    void FixPoint(int x, int y);
+    void SetGravity(float g);       // Same slider scaling as Cloth
+    void SetStiffness(float s);
+    void SetDamping(float d);
+
+    int GetPointCount() const { return width * height; }
+    int GetSubdomainCount() const { return tilesX * tilesY; }
+    void GetPositions(std::vector<float>& xy) const;  // x,y pairs in grid order
+};
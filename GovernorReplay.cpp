@@ -0,0 +1,104 @@
+// Headless test for QualityGovernor: a real cloth is stepped every frame
+// while a load trace stands in for the machine and the renderer. Each trace
+// line covers a number of frames:
+//   frames  updateScale  drawMs   # '#' starts a comment
+// updateScale multiplies the measured Update time (a slower machine or
+// background load), drawMs is the draw cost at the preferred resolution with
+// wires. Drawing is modelled as scaling with the face count and getting 40%
+// cheaper without wires. One summary line is printed per trace line.
+//
+// Usage: ClothGovernorReplay <trace> [budgetMs] [resolution]
+#include "Cloth.h"
+#include "QualityGovernor.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float FIXED_TIME_STEP = 1.0f / 60.0f;
+
+struct TraceSegment {
+    int frames;
+    float updateScale;
+    float drawMs;
+};
+
+bool LoadTrace(const char* path, std::vector<TraceSegment>& trace) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream in(line);
+        TraceSegment segment;
+        if (in >> segment.frames >> segment.updateScale >> segment.drawMs) {
+            trace.push_back(segment);
+        }
+    }
+    return !trace.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace> [budgetMs] [resolution]\n", argv[0]);
+        return 1;
+    }
+    std::vector<TraceSegment> trace;
+    if (!LoadTrace(argv[1], trace)) {
+        fprintf(stderr, "Could not read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    GovernorSettings settings;
+    if (argc > 2) settings.budgetMs = (float)atof(argv[2]);
+    int resolution = argc > 3 ? atoi(argv[3]) : 30;
+
+    Cloth cloth(resolution, resolution, Cloth::GRID_EXTENT / resolution);
+    cloth.FixPoint(0, 0);
+    cloth.FixPoint(resolution - 1, 0);
+    QualityGovernor governor(settings);
+    cloth.SetWireVisibility(true);
+    governor.SetPreference(cloth);
+    governor.Apply(cloth); // SetResolution keeps the pinned corners
+    float preferredFaces = (float)cloth.GetFaces().size();
+
+    printf("Budget %.2f ms, preferred resolution %d\n", settings.budgetMs, resolution);
+    printf("%8s %6s %8s | %6s %6s %9s %8s %5s %10s\n", "frames", "scale", "drawMs", "level", "res",
+           "substeps", "collide", "wires", "avg ms");
+
+    int frame = 0;
+    for (const auto& segment : trace) {
+        double totalMs = 0.0;
+        for (int i = 0; i < segment.frames; i++, frame++) {
+            auto start = std::chrono::steady_clock::now();
+            cloth.Update(FIXED_TIME_STEP);
+            float updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            float faceShare = cloth.GetFaces().size() / preferredFaces;
+            float drawMs = segment.drawMs * faceShare * (cloth.GetWireVisibility() ? 1.0f : 0.6f);
+            updateMs *= segment.updateScale;
+            totalMs += updateMs + drawMs;
+
+            int previous = governor.GetLevel();
+            governor.Record(updateMs, drawMs);
+            if (governor.Apply(cloth) && governor.GetLevel() != previous) {
+                printf("  frame %d: level %d -> %d\n", frame, previous, governor.GetLevel());
+            }
+        }
+
+        const QualityGovernor::Level& level = governor.GetCurrent();
+        printf("%8d %6.2f %8.2f | %6d %6d %9d %8d %5s %10.2f\n", segment.frames, segment.updateScale,
+               segment.drawMs, governor.GetLevel(), level.resolution, level.substeps,
+               level.selfCollisionInterval, level.showWires ? "on" : "off", totalMs / segment.frames);
+    }
+    return 0;
+}
@@ -9,9 +9,9 @@
 #endif
 
 // Add presets at the top
-const SimulationPreset HIGH_PRESET = {30, 0.7f, 0.8f, 0.6f, true};
-const SimulationPreset MEDIUM_PRESET = {20, 0.5f, 0.5f, 0.5f, true};
-const SimulationPreset LOW_PRESET = {15, 0.3f, 0.3f, 0.4f, false};
+const SimulationPreset HIGH_PRESET = {30, 0.7f, 0.8f, 0.6f, true, 3};
+const SimulationPreset MEDIUM_PRESET = {20, 0.5f, 0.5f, 0.5f, true, 2};
+const SimulationPreset LOW_PRESET = {15, 0.3f, 0.3f, 0.4f, false, 1};
 
 void CreateSimControls(HWND hwnd) {
     // Initialize Common Controls
@@ -84,6 +84,11 @@ void CreateSimControls(HWND hwnd) {
         START_X + 120, START_Y + 105, 120, 30,
         hwnd, (HMENU)ID_WIRE_TOGGLE, GetModuleHandle(NULL), NULL);
 
+    CreateWindowEx(0, "BUTTON", "&Auto Quality",
+        WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX,
+        START_X + 260, START_Y + 105, 120, 30,
+        hwnd, (HMENU)ID_AUTO_QUALITY, GetModuleHandle(NULL), NULL);
+
     // Create resolution controls (Y + 140)
     CreateWindowEx(0, "STATIC", "Resolution:", WS_CHILD | WS_VISIBLE,
         START_X, START_Y + 140, LABEL_WIDTH, CONTROL_HEIGHT,
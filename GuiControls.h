@@ -23,6 +23,7 @@ processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #define ID_PRESET_HIGH 114
 #define ID_PRESET_MEDIUM 115
 #define ID_PRESET_LOW 116
+#define ID_AUTO_QUALITY 117
 
 // Add optimization preset struct
 struct SimulationPreset {
@@ -31,6 +32,7 @@ struct SimulationPreset {
     float stiffness;
     float damping;
     bool showWires;
+    int renderDetail;  // Fine render cells per simulated cell edge
 };
 
 extern const SimulationPreset HIGH_PRESET;
@@ -0,0 +1,116 @@
+#include "MaterialCurves.h"
+
+MaterialModel::MaterialModel()
+    : kind(PIECEWISE), segments(1), minStretch(0.0f), sampleStep(1.0f), hysteretic(false), dissipation(0.0f),
+      retention(1.0f) {
+    const float knee = 1.2f;
+    const float slope = 2.5f;
+    SetPiecewise(1.5f, &knee, &slope, 1);
+}
+
+void MaterialModel::SetPiecewise(float slope, const float* knees, const float* slopes, int count) {
+    kind = PIECEWISE;
+    segments = std::max(0, std::min(count, MAX_SEGMENTS - 1)) + 1;
+    for (int k = 0; k < MAX_SEGMENTS; k++) {
+        if (k < MAX_SEGMENTS - 1) {
+            piecewise.knee[k] = k < segments - 1 ? knees[k] : 0.0f;
+            if (k > 0 && k < segments - 1) piecewise.knee[k] = std::max(piecewise.knee[k - 1], piecewise.knee[k]);
+        }
+        piecewise.slope[k] = k >= segments ? 0.0f : k == 0 ? slope : slopes[k - 1];
+        piecewise.halfSlope[k] = 0.5f * piecewise.slope[k];
+        piecewise.start[k] = 0.0f;
+        piecewise.startForce[k] = 0.0f;
+    }
+
+    // Same clamps as PiecewiseLinearResponse<segments>::Covered
+    auto clampInto = [this](float stretch, int k) {
+        if (k > 0) stretch = std::max(piecewise.knee[k - 1], stretch);
+        if (k < segments - 1) stretch = std::min(piecewise.knee[k], stretch);
+        return stretch;
+    };
+    for (int k = 0; k < segments; k++) piecewise.start[k] = clampInto(1.0f, k);
+    for (int k = 0; k < segments; k++) {
+        float force = 0.0f;
+        for (int j = 0; j < segments; j++) {
+            force += piecewise.slope[j] * (clampInto(piecewise.start[k], j) - piecewise.start[j]);
+        }
+        piecewise.startForce[k] = force;
+    }
+}
+
+MaterialModel MaterialModel::PiecewiseLinear(float slope, const std::vector<float>& knees,
+                                             const std::vector<float>& slopes) {
+    MaterialModel model;
+    model.SetPiecewise(slope, knees.data(), slopes.data(), (int)std::min(knees.size(), slopes.size()));
+    return model;
+}
+
+MaterialModel MaterialModel::Tabulated(float minStretch, float maxStretch, const std::vector<float>& samples) {
+    MaterialModel model;
+    if (samples.size() < 2 || !(maxStretch > minStretch)) return model;
+
+    model.kind = TABULATED;
+    model.minStretch = minStretch;
+    model.sampleStep = (maxStretch - minStretch) / (samples.size() - 1);
+    model.samples = samples;
+
+    // Trapezoid sums from the first sample, then shifted so rest has no energy
+    model.sampleEnergy.assign(samples.size(), 0.0f);
+    for (size_t i = 1; i < samples.size(); i++) {
+        model.sampleEnergy[i] = model.sampleEnergy[i - 1] + 0.5f * model.sampleStep * (samples[i - 1] + samples[i]);
+    }
+    float rest = model.Table().Energy(1.0f);
+    for (auto& energy : model.sampleEnergy) energy -= rest;
+    return model;
+}
+
+MaterialModel MaterialModel::WithHysteresis(float dissipation, float retention) const {
+    MaterialModel model = *this;
+    model.hysteretic = true;
+    model.dissipation = std::max(0.0f, std::min(1.0f, dissipation));
+    model.retention = std::max(0.0f, std::min(1.0f, retention));
+    return model;
+}
+
+bool MaterialModel::SameCurve(const MaterialModel& other) const {
+    if (kind != other.kind || hysteretic != other.hysteretic) return false;
+    if (hysteretic && (dissipation != other.dissipation || retention != other.retention)) return false;
+    if (kind == TABULATED) {
+        return minStretch == other.minStretch && sampleStep == other.sampleStep && samples == other.samples;
+    }
+    if (segments != other.segments) return false;
+    for (int k = 0; k < segments; k++) {
+        if (piecewise.slope[k] != other.piecewise.slope[k]) return false;
+        if (k < segments - 1 && piecewise.knee[k] != other.piecewise.knee[k]) return false;
+    }
+    return true;
+}
+
+float MaterialModel::RestSlope() const {
+    if (kind == TABULATED) {
+        TabulatedResponse table = Table();
+        int i = (int)std::max(0.0f, std::min((float)(table.segments - 1), (1.0f - minStretch) * table.inverseStep));
+        return std::max(0.0f, (samples[i + 1] - samples[i]) * table.inverseStep);
+    }
+    int k = 0;
+    while (k < segments - 1 && piecewise.knee[k] <= 1.0f) k++;
+    return std::max(0.0f, piecewise.slope[k]);
+}
+
+float MaterialModel::Energy(float stretch) const {
+    float energy = 0.0f;
+    // Energy does not depend on the step, so any dt will do
+    Visit(0.0f, [stretch, &energy](const auto& response) { energy = response.Energy(stretch); });
+    return energy;
+}
+
+TabulatedResponse MaterialModel::Table() const {
+    TabulatedResponse table;
+    table.minStretch = minStretch;
+    table.step = sampleStep;
+    table.inverseStep = 1.0f / sampleStep;
+    table.segments = (int)samples.size() - 1;
+    table.force = samples.data();
+    table.energy = sampleEnergy.data();
+    return table;
+}
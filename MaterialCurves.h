@@ -0,0 +1,200 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "ClothKernels.h"
+
+// Spring response curves: force per unit stiffness as a function of stretch
+// (length / rest length), and its integral from rest for the energy monitor.
+// Each curve is a small policy type with inline Force/Energy, so the spring
+// loops are instantiated once per curve and evaluate it with min/max and a
+// table lookup instead of branches. Force takes the spring's hysteresis state;
+// curves without memory ignore it.
+
+// Segments straight segments split at rising knees. Each segment adds its
+// slope times the part of [rest, stretch] that falls inside it, so force and
+// energy are a fixed number of clamps with no branch on where the stretch
+// lies. The segment count is a template parameter, so the open-ended first
+// and last segments need only one clamp each.
+template <int Segments>
+struct PiecewiseLinearResponse {
+    float knee[Segments > 1 ? Segments - 1 : 1];
+    float start[Segments];       // Rest stretch clamped into each segment
+    float slope[Segments];
+    float halfSlope[Segments];
+    float startForce[Segments];  // Force at start
+
+    float Force(float stretch, float&) const {
+        float force = slope[0] * Covered(stretch, 0);
+        for (int k = 1; k < Segments; k++) force += slope[k] * Covered(stretch, k);
+        return force;
+    }
+
+    float Energy(float stretch) const {
+        float covered = Covered(stretch, 0);
+        float energy = startForce[0] * covered + halfSlope[0] * covered * covered;
+        for (int k = 1; k < Segments; k++) {
+            covered = Covered(stretch, k);
+            energy += startForce[k] * covered + halfSlope[k] * covered * covered;
+        }
+        return energy;
+    }
+
+    float Covered(float stretch, int k) const {
+        float clamped = stretch;
+        if (k > 0) clamped = std::max(knee[k - 1], clamped);
+        if (k < Segments - 1) clamped = std::min(knee[k], clamped);
+        return clamped - start[k];
+    }
+};
+
+// The original curve as a constant, for code without a MaterialModel
+inline PiecewiseLinearResponse<2> DefaultResponse() {
+    return {{1.2f}, {1.0f, 1.2f}, {1.5f, 2.5f}, {0.75f, 1.25f}, {0.0f, (1.2f - 1.0f) * 1.5f}};
+}
+
+// Measured stress-strain samples at uniform stretch steps, interpolated
+// linearly and extended past both ends along the end segments. A view of the
+// samples held by a MaterialModel.
+struct TabulatedResponse {
+    float minStretch;
+    float step;
+    float inverseStep;
+    int segments;                 // Samples - 1
+    const float* force;
+    const float* energy;          // Integral of force from rest to each sample
+
+    float Force(float stretch, float&) const {
+        float x = (stretch - minStretch) * inverseStep;
+        int i = (int)std::max(0.0f, std::min((float)(segments - 1), x));  // Clamped before truncating
+        float t = x - i;
+        return force[i] + (force[i + 1] - force[i]) * t;
+    }
+
+    float Energy(float stretch) const {
+        float x = (stretch - minStretch) * inverseStep;
+        int i = (int)std::max(0.0f, std::min((float)(segments - 1), x));
+        float t = x - i;
+        return energy[i] + step * t * (force[i] + 0.5f * (force[i + 1] - force[i]) * t);
+    }
+};
+
+// Loading follows the wrapped curve. Between rest and the peak stretch the
+// spring unloads along a softer path, L(s) - dissipation * (L(peak) - L(s)),
+// clamped at zero so a stretched spring never pushes apart; compression
+// follows the loading curve. Each cycle loses energy. The peak fades back
+// towards the current stretch by retention per evaluation, so the fabric
+// recovers. Energy is that of the loading curve, the most an unloading
+// spring can still return.
+template <typename Loading>
+struct HystereticResponse {
+    Loading loading;
+    float dissipation;  // 0 is elastic
+    float retention;    // Fraction of the peak's excess stretch kept per evaluation
+
+    float Force(float stretch, float& peak) const {
+        float unused = 0.0f;
+        peak = std::max(stretch, 1.0f + (peak - 1.0f) * retention);
+        float current = loading.Force(stretch, unused);
+        float unloading = dissipation * std::max(0.0f, loading.Force(peak, unused) - current);
+        float room = stretch > 1.0f ? std::max(0.0f, current) : 0.0f;  // Never flips the sign
+        return current - std::min(unloading, room);
+    }
+
+    float Energy(float stretch) const {
+        return loading.Energy(stretch);
+    }
+};
+
+// A spring family's curve as configured at run time. The solver switches on
+// it once per pass and runs the loop instantiated for that policy. Policies
+// are small values, so the loop keeps them in registers instead of reloading
+// them past every force it writes.
+struct MaterialModel {
+    static constexpr int MAX_SEGMENTS = 4;
+    enum Kind { PIECEWISE, TABULATED };
+    Kind kind;
+    int segments;                                     // Piecewise curves
+    PiecewiseLinearResponse<MAX_SEGMENTS> piecewise;  // First segments entries used
+    float minStretch, sampleStep;                     // Tabulated curves
+    std::vector<float> samples, sampleEnergy;
+    bool hysteretic;
+    float dissipation;
+    float retention;  // Per frame at ClothKernels::DAMPING_FRAME_RATE; Visit scales it to the step
+
+    // The original curve: slope 1.5 up to stretch 1.2, then 2.5. Evaluated
+    // with the same arithmetic as the original branchy code, so forces match
+    // it bit for bit.
+    MaterialModel();
+    // slope below the first knee, then the slope after each knee; knees rise
+    // and at most MAX_SEGMENTS - 1 are used
+    static MaterialModel PiecewiseLinear(float slope, const std::vector<float>& knees,
+                                         const std::vector<float>& slopes);
+    // Force samples (per unit stiffness) at uniform steps from minStretch to
+    // maxStretch; at least two samples, otherwise the default curve is kept
+    static MaterialModel Tabulated(float minStretch, float maxStretch, const std::vector<float>& samples);
+    MaterialModel WithHysteresis(float dissipation, float retention = 0.995f) const;
+    bool SameCurve(const MaterialModel& other) const;
+    // Slope of the loading curve just above rest, the linearised stiffness
+    float RestSlope() const;
+    // Energy of the loading curve; switches per call, so not for spring loops
+    float Energy(float stretch) const;
+
+    template <int Segments>
+    PiecewiseLinearResponse<Segments> Piecewise() const;
+    TabulatedResponse Table() const;
+
+    // Calls visitor with the response for a step of dt, whose retention is
+    // scaled so the peak fades at the same rate whatever the substeps
+    template <typename Visitor>
+    void Visit(float dt, const Visitor& visitor) const;
+
+private:
+    void SetPiecewise(float slope, const float* knees, const float* slopes, int count);
+    template <typename Loading, typename Visitor>
+    void VisitLoading(const Loading& loading, float dt, const Visitor& visitor) const;
+};
+
+template <int Segments>
+PiecewiseLinearResponse<Segments> MaterialModel::Piecewise() const {
+    PiecewiseLinearResponse<Segments> response;
+    for (int k = 0; k < Segments; k++) {
+        if (k < Segments - 1) response.knee[k] = piecewise.knee[k];
+        response.start[k] = piecewise.start[k];
+        response.slope[k] = piecewise.slope[k];
+        response.halfSlope[k] = piecewise.halfSlope[k];
+        response.startForce[k] = piecewise.startForce[k];
+    }
+    return response;
+}
+
+template <typename Loading, typename Visitor>
+void MaterialModel::VisitLoading(const Loading& loading, float dt, const Visitor& visitor) const {
+    if (hysteretic) {
+        visitor(HystereticResponse<Loading>{loading, dissipation, ClothKernels::StepDamping(retention, dt)});
+    } else {
+        visitor(loading);
+    }
+}
+
+template <typename Visitor>
+void MaterialModel::Visit(float dt, const Visitor& visitor) const {
+    if (kind == TABULATED) {
+        VisitLoading(Table(), dt, visitor);
+        return;
+    }
+    switch (segments) {
+        case 1:
+            VisitLoading(Piecewise<1>(), dt, visitor);
+            break;
+        case 2:
+            VisitLoading(Piecewise<2>(), dt, visitor);
+            break;
+        case 3:
+            VisitLoading(Piecewise<3>(), dt, visitor);
+            break;
+        default:
+            VisitLoading(Piecewise<MAX_SEGMENTS>(), dt, visitor);
+            break;
+    }
+}
@@ -0,0 +1,96 @@
+// Headless checks for the hysteretic material response: a stretch cycle
+// loses energy, unloading never pushes a stretched spring apart,
+// compression follows the loading curve whatever the peak, and the peak
+// fades at the same rate whatever the substeps. Prints each failed check;
+// the exit code is non-zero if any failed.
+//
+// Usage: ClothMaterialCurvesTest
+#include "MaterialCurves.h"
+#include "TestHarness.h"
+
+namespace {
+
+const int CYCLE_STEPS = 400;
+
+// Work done on the spring stretching from rest to maxStretch and back,
+// midpoint rule; the peak is kept, so the way back unloads
+template <typename Response>
+float CycleWork(const Response& response, float maxStretch) {
+    float peak = 1.0f;
+    float step = (maxStretch - 1.0f) / CYCLE_STEPS;
+    float work = 0.0f;
+    for (int i = 0; i < CYCLE_STEPS; i++) work += response.Force(1.0f + (i + 0.5f) * step, peak) * step;
+    for (int i = CYCLE_STEPS - 1; i >= 0; i--) work -= response.Force(1.0f + (i + 0.5f) * step, peak) * step;
+    return work;
+}
+
+template <typename Response>
+void CheckCycle(const Response& response, const char* what) {
+    Check(CycleWork(response, 1.4f) > 0.0f, what);
+}
+
+template <typename Loading>
+void CheckHysteresis(const Loading& loading) {
+    HystereticResponse<Loading> response = {loading, 1.0f, 1.0f};
+    float unused = 0.0f;
+
+    float elastic = CycleWork(loading, 1.4f);
+    float lost = CycleWork(response, 1.4f);
+    Check(elastic > -1e-4f && elastic < 1e-4f, "elastic cycle returns its work");
+    Check(lost > 1e-3f, "hysteretic cycle dissipates energy");
+    Check(lost < response.Energy(1.4f) + 1e-4f, "a cycle loses at most the stored energy");
+
+    float peak = 1.4f;
+    float force = response.Force(1.01f, peak);
+    Check(force >= 0.0f && force <= loading.Force(1.01f, unused), "unloading never pushes a stretched spring apart");
+
+    peak = 1.4f;
+    force = response.Force(0.9f, peak);
+    Check(force == loading.Force(0.9f, unused), "compression follows the loading curve after a peak");
+
+    peak = 1.0f;
+    force = response.Force(1.3f, peak);
+    Check(force == loading.Force(1.3f, unused) && peak == 1.3f, "loading past the peak follows the loading curve");
+}
+
+void TestPiecewise() {
+    CheckHysteresis(DefaultResponse());
+    CheckCycle(HystereticResponse<PiecewiseLinearResponse<2>>{DefaultResponse(), 0.3f, 1.0f},
+               "partial dissipation still loses energy");
+}
+
+void TestTabulated() {
+    MaterialModel model = MaterialModel::Tabulated(0.8f, 1.6f, {-0.5f, -0.2f, 0.0f, 0.3f, 0.8f, 1.5f, 2.4f, 3.5f, 5.0f});
+    CheckHysteresis(model.Table());
+}
+
+void TestModelVisit() {
+    MaterialModel model = MaterialModel().WithHysteresis(0.5f, 1.0f);
+    model.Visit(1.0f / 60.0f, [](const auto& response) {
+        CheckCycle(response, "a hysteretic model's response loses energy");
+    });
+}
+
+// The peak fades by the same amount over a frame whatever the substeps
+void TestRetentionRate() {
+    MaterialModel model = MaterialModel().WithHysteresis(0.5f, 0.9f);
+    float once = 1.5f;
+    float twice = 1.5f;
+    model.Visit(1.0f / 60.0f, [&once](const auto& response) { response.Force(1.0f, once); });
+    model.Visit(1.0f / 120.0f, [&twice](const auto& response) {
+        response.Force(1.0f, twice);
+        response.Force(1.0f, twice);
+    });
+    Check(std::fabs(once - 1.45f) < 1e-5f, "retention is the share kept per 1/60 s");
+    Check(std::fabs(once - twice) < 1e-5f, "two half steps fade the peak as much as one full step");
+}
+
+} // namespace
+
+int main() {
+    TestPiecewise();
+    TestTabulated();
+    TestModelVisit();
+    TestRetentionRate();
+    return FinishChecks("material curve");
+}
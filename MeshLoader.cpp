@@ -0,0 +1,244 @@
+#include "MeshLoader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const int MAX_POLYGON_VERTICES = 256;  // Larger PLY face counts are taken as corrupt
+
+struct PlyElement {
+    std::string name;
+    int count;
+};
+
+// Split a polygon into a triangle fan, skipping degenerate triangles
+void AddPolygon(TriangleMesh& mesh, const std::vector<int>& polygon) {
+    for (size_t i = 1; i + 1 < polygon.size(); i++) {
+        int a = polygon[0];
+        int b = polygon[i];
+        int c = polygon[i + 1];
+        if (a == b || b == c || a == c) continue;
+        mesh.triangles.push_back(a);
+        mesh.triangles.push_back(b);
+        mesh.triangles.push_back(c);
+    }
+}
+
+bool ValidateMesh(const TriangleMesh& mesh) {
+    int vertexCount = (int)mesh.x.size();
+    if (vertexCount == 0 || mesh.triangles.empty()) return false;
+    for (int index : mesh.triangles) {
+        if (index < 0 || index >= vertexCount) return false;
+    }
+    return true;
+}
+
+std::string GetExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return "";
+    std::string ext = path.substr(dot + 1);
+    for (auto& c : ext) c = (char)std::tolower((unsigned char)c);
+    return ext;
+}
+
+} // namespace
+
+bool LoadOBJ(const std::string& path, TriangleMesh& mesh) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    mesh = TriangleMesh();
+    std::string line;
+    std::vector<int> polygon;
+
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        std::string tag;
+        in >> tag;
+
+        if (tag == "v") {
+            float x, y;
+            if (!(in >> x >> y)) return false;
+            mesh.x.push_back(x);
+            mesh.y.push_back(y);
+        } else if (tag == "f") {
+            polygon.clear();
+            std::string token;
+            while (in >> token) {
+                // Accept "v", "v/vt", "v//vn" and "v/vt/vn"; negative indices are relative
+                int index = std::atoi(token.c_str());
+                if (index < 0) index += (int)mesh.x.size();
+                else index -= 1;
+                polygon.push_back(index);
+            }
+            AddPolygon(mesh, polygon);
+        }
+    }
+
+    return ValidateMesh(mesh);
+}
+
+bool LoadPLY(const std::string& path, TriangleMesh& mesh) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line.compare(0, 3, "ply") != 0) return false;
+
+    mesh = TriangleMesh();
+    std::vector<PlyElement> elements;
+    int vertexProperties = 0;
+    int xProperty = -1;
+    int yProperty = -1;
+    bool ended = false;
+
+    // Parse header
+    while (!ended && std::getline(file, line)) {
+        std::istringstream in(line);
+        std::string keyword;
+        in >> keyword;
+
+        if (keyword == "format") {
+            std::string format;
+            in >> format;
+            if (format != "ascii") return false;  // Binary PLY is not supported
+        } else if (keyword == "element") {
+            PlyElement element = {"", -1};
+            if (!(in >> element.name >> element.count) || element.count < 0) return false;
+            elements.push_back(element);
+        } else if (keyword == "property" && !elements.empty() && elements.back().name == "vertex") {
+            std::string type, name;
+            in >> type >> name;
+            if (name == "x") xProperty = vertexProperties;
+            if (name == "y") yProperty = vertexProperties;
+            vertexProperties++;
+        } else if (keyword == "end_header") {
+            ended = true;
+        }
+    }
+
+    if (!ended || xProperty < 0 || yProperty < 0) return false;
+
+    // Element bodies follow in header order, one line per record; elements
+    // other than vertex and face (materials, edges, ...) are skipped
+    std::vector<float> values(vertexProperties);
+    std::vector<int> polygon;
+    for (const PlyElement& element : elements) {
+        for (int i = 0; i < element.count; i++) {
+            if (!std::getline(file, line)) return false;
+            std::istringstream in(line);
+            if (element.name == "vertex") {
+                for (auto& value : values) {
+                    if (!(in >> value)) return false;
+                }
+                mesh.x.push_back(values[xProperty]);
+                mesh.y.push_back(values[yProperty]);
+            } else if (element.name == "face") {
+                int count = 0;
+                if (!(in >> count) || count < 3 || count > MAX_POLYGON_VERTICES) return false;
+                polygon.resize(count);
+                for (auto& index : polygon) {
+                    if (!(in >> index)) return false;
+                }
+                AddPolygon(mesh, polygon);
+            }
+        }
+    }
+
+    return ValidateMesh(mesh);
+}
+
+bool LoadMesh(const std::string& path, TriangleMesh& mesh) {
+    std::string ext = GetExtension(path);
+    if (ext == "obj") return LoadOBJ(path, mesh);
+    if (ext == "ply") return LoadPLY(path, mesh);
+    return false;
+}
+
+std::vector<int> ReorderForLocality(TriangleMesh& mesh) {
+    int vertexCount = (int)mesh.x.size();
+    int triangleCount = (int)mesh.triangles.size() / 3;
+
+    // Build vertex adjacency (CSR) from triangle edges
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(triangleCount * 6);
+    for (int t = 0; t < triangleCount; t++) {
+        for (int e = 0; e < 3; e++) {
+            int a = mesh.triangles[t * 3 + e];
+            int b = mesh.triangles[t * 3 + (e + 1) % 3];
+            edges.push_back({a, b});
+            edges.push_back({b, a});
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<int> offsets(vertexCount + 1, 0);
+    for (const auto& edge : edges) offsets[edge.first + 1]++;
+    for (int v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+    auto degree = [&](int v) { return offsets[v + 1] - offsets[v]; };
+
+    // Cuthill-McKee: BFS from a low-degree vertex, visiting neighbours by increasing degree
+    std::vector<int> order;
+    order.reserve(vertexCount);
+    std::vector<bool> visited(vertexCount, false);
+    std::vector<int> byDegree(vertexCount);
+    for (int v = 0; v < vertexCount; v++) byDegree[v] = v;
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+                     [&](int a, int b) { return degree(a) < degree(b); });
+
+    std::vector<int> neighbours;
+    for (int start : byDegree) {
+        if (visited[start]) continue;
+
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = true;
+
+        while (head < order.size()) {
+            int v = order[head++];
+            neighbours.clear();
+            for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+                int n = edges[i].second;
+                if (!visited[n]) neighbours.push_back(n);
+            }
+            std::sort(neighbours.begin(), neighbours.end(),
+                      [&](int a, int b) { return degree(a) < degree(b); });
+            for (int n : neighbours) {
+                visited[n] = true;
+                order.push_back(n);
+            }
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    // Apply permutation to vertices
+    std::vector<int> newIndex(vertexCount);
+    for (int i = 0; i < vertexCount; i++) newIndex[order[i]] = i;
+
+    std::vector<float> x(vertexCount), y(vertexCount);
+    for (int v = 0; v < vertexCount; v++) {
+        x[newIndex[v]] = mesh.x[v];
+        y[newIndex[v]] = mesh.y[v];
+    }
+    mesh.x.swap(x);
+    mesh.y.swap(y);
+
+    // Remap triangles and sort them by lowest vertex
+    struct Tri { int v[3]; int key; };
+    std::vector<Tri> tris(triangleCount);
+    for (int t = 0; t < triangleCount; t++) {
+        for (int e = 0; e < 3; e++) tris[t].v[e] = newIndex[mesh.triangles[t * 3 + e]];
+        tris[t].key = std::min(tris[t].v[0], std::min(tris[t].v[1], tris[t].v[2]));
+    }
+    std::stable_sort(tris.begin(), tris.end(),
+                     [](const Tri& a, const Tri& b) { return a.key < b.key; });
+    for (int t = 0; t < triangleCount; t++) {
+        for (int e = 0; e < 3; e++) mesh.triangles[t * 3 + e] = tris[t].v[e];
+    }
+
+    return newIndex;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Planar triangle mesh as read from disk (z coordinates are ignored)
+struct TriangleMesh {
+    std::vector<float> x, y;       // Vertex positions
+    std::vector<int> triangles;    // Three vertex indices per triangle
+};
+
+// Wavefront OBJ: "v" and "f" records, polygons are fan-triangulated
+bool LoadOBJ(const std::string& path, TriangleMesh& mesh);
+// ASCII PLY with "vertex" and "face" elements, in any order among others;
+// faces list their vertex indices first
+bool LoadPLY(const std::string& path, TriangleMesh& mesh);
+// Picks the loader from the file extension
+bool LoadMesh(const std::string& path, TriangleMesh& mesh);
+
+// Renumber vertices in Reverse Cuthill-McKee order and sort triangles by their
+// lowest vertex, so elements that touch each other sit close in memory.
+// Returns the permutation old index -> new index.
+std::vector<int> ReorderForLocality(TriangleMesh& mesh);
@@ -0,0 +1,190 @@
+// Headless checks for the OBJ and PLY loaders and the mesh cloths built from
+// them: index forms and fan triangulation, PLY elements in any order,
+// malformed files rejected, the locality renumbering, and mesh cloths told
+// apart from single-row grids. Prints each failed check; the exit code is
+// non-zero if any failed.
+//
+// Usage: ClothMeshLoaderTest
+#include "Cloth.h"
+#include "MeshLoader.h"
+#include "SceneFile.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace {
+
+const char* OBJ_PATH = "mesh_loader_test.obj";
+const char* PLY_PATH = "mesh_loader_test.ply";
+const char* SCENE_PATH = "mesh_loader_test.scene";
+
+void WriteFile(const char* path, const char* text) {
+    std::ofstream file(path);
+    file << text;
+}
+
+bool LoadOBJText(const char* text, TriangleMesh& mesh) {
+    WriteFile(OBJ_PATH, text);
+    return LoadOBJ(OBJ_PATH, mesh);
+}
+
+bool LoadPLYText(const char* text, TriangleMesh& mesh) {
+    WriteFile(PLY_PATH, text);
+    return LoadPLY(PLY_PATH, mesh);
+}
+
+// A unit square as two triangles, with a vertex no face uses
+const char* SQUARE_PLY =
+    "ply\n"
+    "format ascii 1.0\n"
+    "element vertex 5\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "element face 1\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n"
+    "0 0 0\n"
+    "1 0 0\n"
+    "1 1 0\n"
+    "0 1 0\n"
+    "5 5 0\n"
+    "4 0 1 2 3\n";
+
+void TestOBJ() {
+    TriangleMesh mesh;
+    Check(LoadOBJText("# square\n"
+                      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                      "vt 0 0\nvn 0 0 1\n"
+                      "f 1/1/1 2//1 3/1 4\n", mesh),
+          "OBJ with v, v/vt, v//vn and v/vt/vn indices loads");
+    Check(mesh.x.size() == 4 && mesh.triangles.size() == 6, "an OBJ quad becomes a fan of two triangles");
+    Check(mesh.triangles == std::vector<int>({0, 1, 2, 0, 2, 3}), "OBJ indices are made zero-based");
+
+    Check(LoadOBJText("v 0 0\nv 1 0\nv 0 1\nf -3 -2 -1\n", mesh) && mesh.triangles == std::vector<int>({0, 1, 2}),
+          "negative OBJ indices count back from the last vertex");
+    Check(LoadOBJText("v 0 0\nv 1 0\nv 0 1\nv 1 1\nf 1 2 2 3\n", mesh) && mesh.triangles.size() == 3,
+          "degenerate fan triangles are skipped");
+    Check(!LoadOBJText("v 0 0\nv 1 0\nv 0 1\nf 1 2 4\n", mesh), "an OBJ index past the vertices is rejected");
+    Check(!LoadOBJText("v 0 0\nv 1 0\nv 0 1\n", mesh), "an OBJ without faces is rejected");
+    Check(!LoadOBJText("v 0\nf 1 1 1\n", mesh), "an OBJ vertex without y is rejected");
+}
+
+void TestPLY() {
+    TriangleMesh mesh;
+    Check(LoadPLYText(SQUARE_PLY, mesh), "PLY square loads");
+    Check(mesh.x.size() == 5 && mesh.triangles.size() == 6 && mesh.x[2] == 1.0f && mesh.y[2] == 1.0f,
+          "PLY vertices and fan triangles are read");
+
+    // Faces first, then an unknown element between them and the vertices
+    Check(LoadPLYText("ply\n"
+                      "format ascii 1.0\n"
+                      "comment faces before vertices\n"
+                      "element face 1\n"
+                      "property list uchar int vertex_indices\n"
+                      "element material 2\n"
+                      "property uchar red\n"
+                      "element vertex 3\n"
+                      "property float y\n"
+                      "property float x\n"
+                      "end_header\n"
+                      "3 0 1 2\n"
+                      "255\n"
+                      "0\n"
+                      "0 0\n"
+                      "0 1\n"
+                      "1 0\n", mesh),
+          "PLY elements load in header order and unknown ones are skipped");
+    Check(mesh.x == std::vector<float>({0.0f, 1.0f, 0.0f}) && mesh.y == std::vector<float>({0.0f, 0.0f, 1.0f}),
+          "PLY x and y are taken by property name");
+
+    Check(!LoadPLYText("ply\nformat binary_little_endian 1.0\nelement vertex 0\nend_header\n", mesh),
+          "binary PLY is rejected");
+    Check(!LoadPLYText("ply\nformat ascii 1.0\nelement vertex -1\nproperty float x\nproperty float y\nend_header\n",
+                       mesh),
+          "a negative PLY element count is rejected");
+    Check(!LoadPLYText("ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\n"
+                       "element face 1\nproperty list uchar int vertex_indices\nend_header\n"
+                       "0 0\n1 0\n0 1\n-3 0 1 2\n", mesh),
+          "a negative PLY polygon size is rejected");
+    Check(!LoadPLYText("ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\n"
+                       "element face 1\nproperty list uchar int vertex_indices\nend_header\n"
+                       "0 0\n1 0\n0 1\n", mesh),
+          "a PLY shorter than its header is rejected");
+    Check(!LoadPLYText("ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\n", mesh),
+          "a PLY without end_header is rejected");
+}
+
+void TestReorder() {
+    TriangleMesh mesh;
+    Check(LoadPLYText(SQUARE_PLY, mesh), "PLY square loads for reordering");
+    TriangleMesh ordered = mesh;
+    std::vector<int> newIndex = ReorderForLocality(ordered);
+    std::vector<int> sorted = newIndex;
+    std::sort(sorted.begin(), sorted.end());
+    bool permutation = true;
+    for (int i = 0; i < (int)sorted.size(); i++) permutation = permutation && sorted[i] == i;
+    Check(permutation && newIndex.size() == mesh.x.size(), "renumbering is a permutation");
+
+    bool moved = true;
+    for (size_t v = 0; v < mesh.x.size(); v++) {
+        moved = moved && ordered.x[newIndex[v]] == mesh.x[v] && ordered.y[newIndex[v]] == mesh.y[v];
+    }
+    Check(moved, "vertices move with their new index");
+    bool remapped = ordered.triangles.size() == mesh.triangles.size();
+    for (size_t t = 0; remapped && t < mesh.triangles.size(); t += 3) {
+        // Triangles may be reordered but each keeps its corners in order
+        bool found = false;
+        for (size_t u = 0; u < ordered.triangles.size(); u += 3) {
+            found = found || (ordered.triangles[u] == newIndex[mesh.triangles[t]] &&
+                              ordered.triangles[u + 1] == newIndex[mesh.triangles[t + 1]] &&
+                              ordered.triangles[u + 2] == newIndex[mesh.triangles[t + 2]]);
+        }
+        remapped = found;
+    }
+    Check(remapped, "triangles follow the renumbering");
+}
+
+void TestMeshCloth() {
+    WriteFile(PLY_PATH, SQUARE_PLY);
+    std::unique_ptr<Cloth> mesh(Cloth::CreateFromMesh(PLY_PATH, 100.0f));
+    Check(mesh != nullptr, "a mesh cloth is created from a PLY file");
+    if (!mesh) return;
+    Check(mesh->IsMesh() && mesh->GetHeight() == 1 && mesh->GetWidth() == 5, "a mesh cloth is flagged as a mesh");
+    // Two triangles can split into six corners; the unused vertex never splits
+    Check(mesh->GetPointCapacity() >= 7, "a mesh cloth reserves room for its unreferenced points");
+
+    std::unique_ptr<Cloth> row(new Cloth(5, 1, 20.0f));
+    Check(!row->IsMesh(), "a single-row grid is not a mesh");
+    std::unique_ptr<Cloth> copy(new Cloth(row->GetData()));
+    Check(!copy->IsMesh(), "a copied single-row grid is not a mesh");
+
+    // The flag survives a scene file round trip, for both kinds
+    std::vector<const Cloth*> cloths = {mesh.get(), row.get()};
+    Check(SceneFile::Write(SCENE_PATH, cloths), "a scene with a mesh and a row is written");
+    SceneFile file;
+    Check(file.Open(SCENE_PATH) && file.GetClothCount() == 2, "the scene opens again");
+    if (file.GetClothCount() == 2) {
+        std::unique_ptr<Cloth> loadedMesh(new Cloth(file.GetCloth(0)));
+        std::unique_ptr<Cloth> loadedRow(new Cloth(file.GetCloth(1)));
+        Check(loadedMesh->IsMesh() && !loadedRow->IsMesh(), "scene files keep the mesh flag");
+        Check(loadedMesh->GetPointCapacity() >= 7, "a loaded mesh reserves room for its unreferenced points");
+    }
+    file.Close();
+}
+
+} // namespace
+
+int main() {
+    TestOBJ();
+    TestPLY();
+    TestReorder();
+    TestMeshCloth();
+    std::remove(OBJ_PATH);
+    std::remove(PLY_PATH);
+    std::remove(SCENE_PATH);
+    return FinishChecks("mesh loader");
+}
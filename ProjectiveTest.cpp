@@ -0,0 +1,118 @@
+// Headless checks for the projective solver: a hanging cloth stays finite and
+// settles without rollbacks, the factor is built once and reused while nothing
+// changes, and it is rebuilt after a new pin and after a tear. Prints each
+// failed check; the exit code is non-zero if any failed.
+//
+// Usage: ClothProjectiveTest
+#include "Cloth.h"
+#include "TestHarness.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int RESOLUTION = 16;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+std::unique_ptr<Cloth> Hanging() {
+    std::unique_ptr<Cloth> cloth(Cloth::CreateWithResolution(RESOLUTION));
+    cloth->SetScheduler(nullptr);
+    cloth->SetProjective(true);
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(RESOLUTION - 1, 0);
+    return cloth;
+}
+
+bool Finite(const Cloth& cloth) {
+    for (const auto& point : cloth.GetPoints()) {
+        if (!std::isfinite(point.x) || !std::isfinite(point.y) ||
+            !std::isfinite(point.vx) || !std::isfinite(point.vy)) return false;
+    }
+    return true;
+}
+
+// Largest distance a point moves over one more frame
+float Movement(Cloth& cloth) {
+    std::vector<PointMass> before = cloth.GetPoints();
+    cloth.Update(FRAME_TIME);
+    float furthest = 0.0f;
+    for (size_t i = 0; i < before.size(); i++) {
+        const PointMass& point = cloth.GetPoints()[i];
+        furthest = std::fmax(furthest, std::hypot(point.x - before[i].x, point.y - before[i].y));
+    }
+    return furthest;
+}
+
+void TestStable() {
+    std::unique_ptr<Cloth> cloth = Hanging();
+    cloth->Step(600, FRAME_TIME);
+    Check(Finite(*cloth), "a projective cloth stays finite");
+    Check(cloth->GetRollbackCount() == 0, "a projective cloth never rolls back");
+    Check(cloth->GetBrokenSpringCount() == 0, "a projective cloth hangs without tearing");
+    Check(Movement(*cloth) < 0.01f, "a projective cloth settles");
+    const auto& points = cloth->GetPoints();
+    Check(points.back().y > points.front().y, "a projective cloth hangs below its pins");
+}
+
+void TestReuse() {
+    std::unique_ptr<Cloth> cloth = Hanging();
+    cloth->Update(FRAME_TIME);
+    int built = cloth->GetFactorizationCount();
+    Check(built == 1, "the first step factors once");
+    cloth->Step(120, FRAME_TIME);
+    Check(cloth->GetFactorizationCount() == built, "the factor is reused while nothing changes");
+
+    // Stiffness changes the system; gravity does not
+    cloth->SetGravity(0.8f);
+    cloth->Update(FRAME_TIME);
+    Check(cloth->GetFactorizationCount() == built, "gravity keeps the factor");
+    cloth->SetStiffness(0.8f);
+    cloth->Update(FRAME_TIME);
+    Check(cloth->GetFactorizationCount() == built + 1, "stiffness refactors");
+}
+
+void TestFixPoint() {
+    std::unique_ptr<Cloth> cloth = Hanging();
+    cloth->Step(60, FRAME_TIME);
+    int built = cloth->GetFactorizationCount();
+    cloth->FixPoint(RESOLUTION / 2, RESOLUTION - 1);
+    cloth->Update(FRAME_TIME);
+    Check(cloth->GetFactorizationCount() == built + 1, "a new pin refactors once");
+    const PointMass& pinned = cloth->GetPoints()[(RESOLUTION - 1) * RESOLUTION + RESOLUTION / 2];
+    float x = pinned.x, y = pinned.y;
+    cloth->Step(60, FRAME_TIME);
+    Check(pinned.x == x && pinned.y == y, "the new pin holds its point");
+    Check(cloth->GetFactorizationCount() == built + 1 && Finite(*cloth), "the new factor is reused");
+}
+
+void TestTear() {
+    std::unique_ptr<Cloth> cloth = Hanging();
+    cloth->SetMaxStretch(1.3f);  // Tears under its own weight
+    int broken = 0;
+    int tornFrom = -1;  // Factor count before the frame that tore, until a new factor is seen
+    bool refactored = true;
+    for (int frame = 0; frame < 300; frame++) {
+        int before = cloth->GetFactorizationCount();
+        cloth->Update(FRAME_TIME);
+        // A tear in the last substep is only refactored on the next frame
+        if (tornFrom >= 0 && cloth->GetFactorizationCount() == tornFrom) refactored = false;
+        tornFrom = -1;
+        int now = cloth->GetBrokenSpringCount();
+        if (now > broken && cloth->GetFactorizationCount() == before) tornFrom = before;
+        broken = now;
+    }
+    Check(broken > 0, "a weak projective cloth tears");
+    Check(refactored, "every tear is followed by a new factor");
+    Check(Finite(*cloth), "a torn projective cloth stays finite");
+}
+
+} // namespace
+
+int main() {
+    TestStable();
+    TestReuse();
+    TestFixPoint();
+    TestTear();
+    return FinishChecks("projective dynamics");
+}
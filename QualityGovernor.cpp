@@ -0,0 +1,116 @@
+#include "QualityGovernor.h"
+#include "Cloth.h"
+#include <algorithm>
+
+QualityGovernor::QualityGovernor(const GovernorSettings& settings)
+    : settings(settings), preference({1, 1, true, 20}), resizable(false), preferenceLevel(0), level(0),
+      pending(true), averageMs(-1.0f), overFrames(0), headroomFrames(0) {
+    BuildLevels();
+}
+
+void QualityGovernor::BuildLevels() {
+    levels.clear();
+    if (settings.extraSubstep) {
+        Level boost = preference;
+        boost.substeps++;
+        levels.push_back(boost);
+    }
+    preferenceLevel = (int)levels.size();
+    levels.push_back(preference);
+
+    // Each step only ever lowers what the user picked; no-op steps are skipped
+    auto add = [this](Level next) {
+        const Level& last = levels.back();
+        if (next.substeps != last.substeps || next.selfCollisionInterval != last.selfCollisionInterval ||
+            next.showWires != last.showWires) {
+            levels.push_back(next);
+        }
+    };
+    Level next = preference;
+    next.substeps = 1;
+    add(next);
+    next.selfCollisionInterval = std::max(next.selfCollisionInterval, 2);
+    add(next);
+    next.selfCollisionInterval = std::max(next.selfCollisionInterval, 4);
+    next.showWires = false;
+    add(next);
+    if (!resizable) return;
+    for (int r = preference.resolution - settings.resolutionStep; r >= settings.minResolution;
+         r -= settings.resolutionStep) {
+        next.resolution = r;
+        levels.push_back(next);
+    }
+}
+
+void QualityGovernor::SetPreference(const Cloth& cloth) {
+    preference.substeps = cloth.GetMinSubsteps();
+    preference.selfCollisionInterval = cloth.GetSelfCollisionInterval();
+    preference.showWires = cloth.GetWireVisibility();
+    preference.resolution = cloth.GetWidth();
+    // Meshes and scene cloths keep their topology; SetResolution would replace them with a grid
+    resizable = cloth.IsDefaultGrid();
+    BuildLevels();
+    Restart(preferenceLevel);
+}
+
+void QualityGovernor::SetPreferredWires(bool showWires) {
+    preference.showWires = showWires;
+    BuildLevels();
+    Restart(preferenceLevel);
+}
+
+void QualityGovernor::Restart(int startLevel) {
+    level = startLevel;
+    pending = true;
+    averageMs = -1.0f;
+    overFrames = 0;
+    headroomFrames = 0;
+}
+
+void QualityGovernor::Record(float updateMs, float drawMs) {
+    float frameMs = updateMs + drawMs;
+    averageMs = averageMs < 0.0f ? frameMs : averageMs + (frameMs - averageMs) * settings.smoothing;
+
+    if (averageMs > settings.budgetMs) {
+        overFrames++;
+        headroomFrames = 0;
+    } else if (averageMs < settings.budgetMs * settings.headroomFraction) {
+        headroomFrames++;
+        overFrames = 0;
+    } else {
+        overFrames = 0;
+        headroomFrames = 0;
+    }
+
+    int next = level;
+    if (overFrames >= settings.degradeFrames && level + 1 < (int)levels.size()) {
+        next = level + 1;
+    } else if (headroomFrames >= settings.upgradeFrames && level > 0) {
+        next = level - 1;
+    }
+    if (next != level) {
+        Restart(next);  // Measure the new level from scratch
+    }
+}
+
+bool QualityGovernor::Apply(Cloth& cloth) {
+    if (!pending) return false;
+    ApplyLevel(cloth);
+    return true;
+}
+
+void QualityGovernor::Restore(Cloth& cloth) {
+    Restart(preferenceLevel);
+    ApplyLevel(cloth);
+}
+
+void QualityGovernor::ApplyLevel(Cloth& cloth) {
+    const Level& current = levels[level];
+    if (resizable && cloth.GetWidth() != current.resolution) {
+        cloth.SetResolution(current.resolution, current.resolution);
+    }
+    cloth.SetMinSubsteps(current.substeps);
+    cloth.SetSelfCollisionInterval(current.selfCollisionInterval);
+    cloth.SetWireVisibility(current.showWires);
+    pending = false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+
+class Cloth;
+
+struct GovernorSettings {
+    float budgetMs = 1000.0f / 60.0f;  // Update plus draw time per frame
+    float headroomFraction = 0.6f;     // Below this share of the budget there is room to step up
+    float smoothing = 0.1f;            // Weight of the newest frame in the running average
+    int degradeFrames = 20;            // Consecutive frames over budget before stepping down
+    int upgradeFrames = 120;           // Consecutive frames with headroom before stepping up
+    int resolutionStep = 5;            // Points per side dropped per resolution level
+    int minResolution = 10;
+    bool extraSubstep = false;         // Opt in to a level above the preference with one more substep
+};
+
+// Holds a frame-time budget by walking a ladder of quality levels below what
+// the user picked. Each level down first drops extra substeps, then runs
+// self-collisions less often, then hides the wires and finally lowers the
+// resolution; cloths that are not square grids keep theirs. Stepping down is
+// quick and stepping up slow, and the average restarts after every change,
+// so the governor does not flip between two neighbouring levels.
+class QualityGovernor {
+public:
+    struct Level {
+        int substeps;               // Minimum substeps per frame
+        int selfCollisionInterval;  // Substeps per self-collision pass
+        bool showWires;             // Only ever hides wires the user asked for
+        int resolution;
+    };
+
+    explicit QualityGovernor(const GovernorSettings& settings = GovernorSettings());
+
+    // Reads what the user picked from the cloth, which must not be running a
+    // governed level; it becomes the starting level and restarts the governor
+    void SetPreference(const Cloth& cloth);
+    void SetPreferredWires(bool showWires);  // Keeps the rest of the preference
+    void Record(float updateMs, float drawMs);
+    // Moves at most one level and applies it; true if the cloth was changed
+    bool Apply(Cloth& cloth);
+    void Restore(Cloth& cloth);  // Back to the preference
+
+    int GetLevel() const { return level; }
+    int GetLevelCount() const { return (int)levels.size(); }
+    const Level& GetCurrent() const { return levels[level]; }
+    int GetPreferenceLevel() const { return preferenceLevel; }  // 1 with extraSubstep, else 0
+    int GetPreferredResolution() const { return preference.resolution; }
+    bool GetPreferredWires() const { return preference.showWires; }
+    float GetAverageMs() const { return averageMs; }
+    const GovernorSettings& GetSettings() const { return settings; }
+
+private:
+    GovernorSettings settings;
+    std::vector<Level> levels;
+    Level preference;
+    bool resizable;         // Square grid cloth that SetResolution rebuilds as it was
+    int preferenceLevel;
+    int level;
+    bool pending;           // Level changed or preference reset but not yet applied
+    float averageMs;        // Negative until the first frame after a change
+    int overFrames;
+    int headroomFrames;
+
+    void BuildLevels();
+    void Restart(int startLevel);
+    void ApplyLevel(Cloth& cloth);
+};
@@ -0,0 +1,56 @@
+// Strong-scaling benchmark for DecomposedCloth: a fixed-size grid is stepped
+// with 1, 2, 4, ... subdomains and the speedup over one subdomain is reported.
+//
+// Usage: ClothScalingBench [gridSize] [steps] [maxThreads]
+#include "DomainDecomposition.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// Factor threads into a tile grid that is as close to square as possible
+void ChooseTiles(int threads, int& tilesX, int& tilesY) {
+    tilesY = (int)std::sqrt((double)threads);
+    while (threads % tilesY != 0) tilesY--;
+    tilesX = threads / tilesY;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int gridSize = argc > 1 ? atoi(argv[1]) : 1024;
+    int steps = argc > 2 ? atoi(argv[2]) : 50;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    const float dt = 1.0f / 60.0f;
+
+    printf("Grid %dx%d (%d points), %d steps\n", gridSize, gridSize, gridSize * gridSize, steps);
+    printf("%8s %8s %12s %12s %10s %10s\n", "threads", "tiles", "seconds", "steps/sec", "speedup", "efficiency");
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        int tilesX, tilesY;
+        ChooseTiles(threads, tilesX, tilesY);
+
+        // Spacing chosen so the cloth fits the same 400 px span as the GUI presets
+        DecomposedCloth cloth(gridSize, gridSize, 400.0f / gridSize, tilesX, tilesY);
+        cloth.FixPoint(0, 0);
+        cloth.FixPoint(gridSize - 1, 0);
+        cloth.Step(1, dt); // Warm up caches and page mappings
+
+        auto start = std::chrono::steady_clock::now();
+        cloth.Step(steps, dt);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (threads == 1) baseline = seconds;
+        double speedup = baseline / seconds;
+        printf("%8d %5dx%-2d %12.3f %12.1f %10.2f %9.0f%%\n", threads, tilesX, tilesY, seconds,
+               steps / seconds, speedup, 100.0 * speedup / threads);
+
+        if (threads < maxThreads && threads * 2 > maxThreads) threads = maxThreads / 2; // Always end on maxThreads
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Converts a text scene description into the binary scene format and
+// compares building the scene procedurally with mapping the result.
+//
+// Text format, one command per line, '#' starts a comment. Every command
+// after "grid" or "mesh" applies to that cloth:
+//   grid <width> <height> <spacing>   new grid cloth
+//   mesh <path> [scale]               new cloth from an OBJ or PLY mesh
+//   origin <x> <y>                    top-left of the cloth
+//   gravity|stiffness|damping <0-1>   same scale as the GUI sliders
+//   maxstretch <ratio>                break threshold of every spring
+//   pin <x> <y>                       pin a grid point
+//   pinrow <y> [step]                 pin every step-th point of a grid row
+//   pinvertex <index>                 pin a mesh vertex by its file index
+//   wind <x> <y> [density] [turbulence]
+//   detail <factor>                   render level of detail
+//   wires on|off
+//
+// Usage: ClothSceneConvert <scene.txt> <scene.clsc>
+#include "Cloth.h"
+#include "ClothScene.h"
+#include "SceneFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool BuildScene(const char* path, std::vector<Cloth*>& cloths) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Could not read %s\n", path);
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream in(line);
+        std::string command;
+        if (!(in >> command)) continue;
+
+        Cloth* cloth = cloths.empty() ? nullptr : cloths.back();
+        bool ok = true;
+        if (command == "grid") {
+            int width = 0, height = 0;
+            float spacing = 0.0f;
+            ok = (in >> width >> height >> spacing) && width > 1 && height > 1 && spacing > 0.0f;
+            if (ok) cloths.push_back(new Cloth(width, height, spacing));
+        } else if (command == "mesh") {
+            std::string meshPath;
+            float scale = 1.0f;
+            ok = (bool)(in >> meshPath);
+            in >> scale;
+            Cloth* mesh = ok ? Cloth::CreateFromMesh(meshPath, scale) : nullptr;
+            ok = mesh != nullptr;
+            if (ok) cloths.push_back(mesh);
+        } else if (!cloth) {
+            ok = false;
+        } else if (command == "origin") {
+            float x, y;
+            ok = (bool)(in >> x >> y);
+            if (ok) cloth->SetOrigin(x, y);
+        } else if (command == "gravity" || command == "stiffness" || command == "damping") {
+            float value;
+            ok = (bool)(in >> value);
+            if (ok && command == "gravity") cloth->SetGravity(value);
+            if (ok && command == "stiffness") cloth->SetStiffness(value);
+            if (ok && command == "damping") cloth->SetDamping(value);
+        } else if (command == "maxstretch") {
+            float ratio;
+            ok = (bool)(in >> ratio);
+            if (ok) cloth->SetMaxStretch(ratio);
+        } else if (command == "pin") {
+            int x, y;
+            ok = (bool)(in >> x >> y);
+            if (ok) cloth->FixPoint(x, y);
+        } else if (command == "pinrow") {
+            int y, step = 1;
+            ok = (bool)(in >> y);
+            in >> step;
+            for (int x = 0; ok && x < cloth->GetWidth(); x += std::max(1, step)) cloth->FixPoint(x, y);
+            if (ok && step > 1) cloth->FixPoint(cloth->GetWidth() - 1, y);  // Always hold both corners
+        } else if (command == "pinvertex") {
+            int vertex;
+            ok = (bool)(in >> vertex);
+            if (ok) cloth->FixMeshVertex(vertex);
+        } else if (command == "wind") {
+            AeroSettings air;
+            air.enabled = true;
+            ok = (bool)(in >> air.windX >> air.windY);
+            in >> air.density >> air.turbulence;
+            if (ok) cloth->SetAerodynamics(air);
+        } else if (command == "detail") {
+            int factor;
+            ok = (bool)(in >> factor);
+            if (ok) cloth->SetRenderDetail(factor);
+        } else if (command == "wires") {
+            std::string state;
+            ok = (in >> state) && (state == "on" || state == "off");
+            if (ok) cloth->SetWireVisibility(state == "on");
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s:%d: cannot use '%s'\n", path, lineNumber, line.c_str());
+            return false;
+        }
+    }
+    if (cloths.empty()) fprintf(stderr, "%s: no cloths\n", path);
+    return !cloths.empty();
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <scene.txt> <scene.clsc>\n", argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Cloth*> cloths;
+    bool built = BuildScene(argv[1], cloths);
+    double buildMs = Milliseconds(start);
+    if (!built) {
+        for (Cloth* cloth : cloths) delete cloth;
+        return 1;
+    }
+
+    std::vector<const Cloth*> views(cloths.begin(), cloths.end());
+    long long points = 0, springs = 0;
+    for (const Cloth* cloth : cloths) {
+        points += cloth->GetPoints().size();
+        springs += cloth->GetSprings().size();
+    }
+    bool written = SceneFile::Write(argv[2], views);
+    for (Cloth* cloth : cloths) delete cloth;
+    if (!written) {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    ClothScene scene;
+    if (!scene.Load(argv[2])) {
+        fprintf(stderr, "Could not load %s back\n", argv[2]);
+        return 1;
+    }
+    double loadMs = Milliseconds(start);
+
+    printf("%d cloths, %lld points, %lld springs -> %s\n", scene.GetCount(), points, springs, argv[2]);
+    printf("  built from text: %10.2f ms\n", buildMs);
+    printf("  mapped binary:   %10.2f ms\n", loadMs);
+    return 0;
+}
@@ -0,0 +1,292 @@
+#include "SceneFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::is_trivially_copyable<PointMass>::value, "points are stored as raw records");
+static_assert(std::is_trivially_copyable<Spring>::value, "springs are stored as raw records");
+static_assert(std::is_trivially_copyable<Face>::value, "faces are stored as raw records");
+static_assert(std::is_trivially_copyable<AeroSettings>::value, "aero settings are stored as a raw record");
+
+namespace {
+
+// A stored bool has to be a 0 or 1 byte; anything else is undefined once read as bool
+bool IsBoolByte(const unsigned char* record, size_t offset) {
+    return record[offset] <= 1;
+}
+
+size_t AlignUp(size_t offset) {
+    return (offset + SceneFormat::ALIGNMENT - 1) & ~(SceneFormat::ALIGNMENT - 1);
+}
+
+// The arrays in the file are copied verbatim on load, so scratch state and
+// struct padding are zeroed here to keep files reproducible
+std::vector<PointMass> CleanPoints(const ClothData& cloth) {
+    std::vector<PointMass> points(cloth.pointCount);
+    std::memset(points.data(), 0, points.size() * sizeof(PointMass));
+    for (int i = 0; i < cloth.pointCount; i++) {
+        const PointMass& source = cloth.points[i];
+        PointMass& point = points[i];
+        point.x = point.prevX = point.renderX = source.x;
+        point.y = point.prevY = point.renderY = source.y;
+        point.mass = source.mass;
+        point.isFixed = source.isFixed;
+    }
+    return points;
+}
+
+std::vector<Spring> CleanSprings(const ClothData& cloth) {
+    std::vector<Spring> springs(cloth.springCount);
+    std::memset(springs.data(), 0, springs.size() * sizeof(Spring));
+    for (int s = 0; s < cloth.springCount; s++) {
+        const Spring& source = cloth.springs[s];
+        Spring& spring = springs[s];
+        spring.point1 = source.point1;
+        spring.point2 = source.point2;
+        spring.restLength = source.restLength;
+        spring.stiffness = source.stiffness;
+        spring.damping = source.damping;
+        spring.maxStretch = source.maxStretch;
+        spring.family = source.family;
+    }
+    return springs;
+}
+
+} // namespace
+
+SceneFile::SceneFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+#endif
+}
+
+SceneFile::~SceneFile() {
+    Close();
+}
+
+bool SceneFile::Open(const std::string& path) {
+    Close();
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(SceneFormat::Header)) {
+        Close();
+        return false;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        Close();
+        return false;
+    }
+    data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    size = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SceneFormat::Header)) {
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file referenced
+    if (memory == MAP_FAILED) return false;
+    data = static_cast<const unsigned char*>(memory);
+    size = (size_t)info.st_size;
+#endif
+    if (!data || !Validate()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::Close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool SceneFile::Validate() const {
+    const SceneFormat::Header* header = GetHeader();
+    if (header->magic != SceneFormat::MAGIC || header->version != SceneFormat::VERSION) return false;
+    if (header->pointSize != sizeof(PointMass) || header->springSize != sizeof(Spring) ||
+        header->faceSize != sizeof(Face) || header->recordSize != sizeof(SceneFormat::ClothRecord)) return false;
+    if (header->fileSize != size) return false;
+
+    // Every array has to lie inside the file at its natural alignment
+    auto inside = [this](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % SceneFormat::ALIGNMENT == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (!inside(header->recordsOffset, header->clothCount, sizeof(SceneFormat::ClothRecord))) return false;
+    for (uint32_t i = 0; i < header->clothCount; i++) {
+        const SceneFormat::ClothRecord& record = *GetRecord(i);
+        if (record.pointCount < 1 || record.springCount < 0 || record.faceCount < 0) return false;
+        if (record.flags & ~SceneFormat::RECORD_MESH) return false;
+        if (record.width < 1 || record.height < 1 || (long long)record.width * record.height > record.pointCount) return false;
+        if (!inside(record.pointsOffset, record.pointCount, sizeof(PointMass)) ||
+            !inside(record.springsOffset, record.springCount, sizeof(Spring)) ||
+            !inside(record.facesOffset, record.faceCount, sizeof(Face)) ||
+            !inside(record.edgeSpringsOffset, (uint64_t)record.faceCount * 3, sizeof(int32_t))) return false;
+
+        // Indices, flags and divisors are used without further checks once loaded.
+        // Bool bytes are checked raw before anything reads them as bool.
+        const unsigned char* pointBytes = data + record.pointsOffset;
+        const PointMass* points = reinterpret_cast<const PointMass*>(pointBytes);
+        for (int p = 0; p < record.pointCount; p++) {
+            const unsigned char* bytes = pointBytes + (size_t)p * sizeof(PointMass);
+            if (!IsBoolByte(bytes, offsetof(PointMass, isFixed)) || !IsBoolByte(bytes, offsetof(PointMass, isDragged))) return false;
+            if (!(points[p].mass > 0.0f)) return false;
+        }
+        const unsigned char* springBytes = data + record.springsOffset;
+        const Spring* springs = reinterpret_cast<const Spring*>(springBytes);
+        for (int s = 0; s < record.springCount; s++) {
+            if (!IsBoolByte(springBytes + (size_t)s * sizeof(Spring), offsetof(Spring, broken))) return false;
+            if ((unsigned)springs[s].point1 >= (unsigned)record.pointCount ||
+                (unsigned)springs[s].point2 >= (unsigned)record.pointCount) return false;
+            if (!(springs[s].restLength > 0.0f) || springs[s].family >= FAMILY_COUNT) return false;
+        }
+        const Face* faces = reinterpret_cast<const Face*>(data + record.facesOffset);
+        const int32_t* edgeSprings = reinterpret_cast<const int32_t*>(data + record.edgeSpringsOffset);
+        for (int f = 0; f < record.faceCount; f++) {
+            if ((unsigned)faces[f].p1 >= (unsigned)record.pointCount ||
+                (unsigned)faces[f].p2 >= (unsigned)record.pointCount ||
+                (unsigned)faces[f].p3 >= (unsigned)record.pointCount) return false;
+            for (int e = 0; e < 3; e++) {
+                if (edgeSprings[f * 3 + e] < -1 || edgeSprings[f * 3 + e] >= record.springCount) return false;
+            }
+        }
+    }
+    return true;
+}
+
+int SceneFile::GetClothCount() const {
+    return data ? (int)GetHeader()->clothCount : 0;
+}
+
+const SceneFormat::ClothRecord* SceneFile::GetRecord(int index) const {
+    return reinterpret_cast<const SceneFormat::ClothRecord*>(data + GetHeader()->recordsOffset) + index;
+}
+
+ClothData SceneFile::GetCloth(int index) const {
+    const SceneFormat::ClothRecord& record = *GetRecord(index);
+    ClothData cloth;
+    cloth.width = record.width;
+    cloth.height = record.height;
+    cloth.isMesh = (record.flags & SceneFormat::RECORD_MESH) != 0;
+    cloth.spacing = record.spacing;
+    cloth.originX = record.originX;
+    cloth.originY = record.originY;
+    cloth.gravityForce = record.gravityForce;
+    cloth.springStiffness = record.springStiffness;
+    cloth.springDamping = record.springDamping;
+    cloth.renderDetail = record.renderDetail;
+    cloth.showWires = record.showWires != 0;
+    cloth.aero = record.aero;
+    cloth.pointCount = record.pointCount;
+    cloth.springCount = record.springCount;
+    cloth.faceCount = record.faceCount;
+    cloth.points = reinterpret_cast<const PointMass*>(data + record.pointsOffset);
+    cloth.springs = reinterpret_cast<const Spring*>(data + record.springsOffset);
+    cloth.faces = reinterpret_cast<const Face*>(data + record.facesOffset);
+    cloth.faceEdgeSprings = reinterpret_cast<const int*>(data + record.edgeSpringsOffset);
+    return cloth;
+}
+
+bool SceneFile::Write(const std::string& path, const std::vector<const Cloth*>& cloths) {
+    for (const Cloth* cloth : cloths) {
+        if (cloth->IsCompact()) return false;
+    }
+    SceneFormat::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SceneFormat::MAGIC;
+    header.version = SceneFormat::VERSION;
+    header.pointSize = sizeof(PointMass);
+    header.springSize = sizeof(Spring);
+    header.faceSize = sizeof(Face);
+    header.recordSize = sizeof(SceneFormat::ClothRecord);
+    header.clothCount = (uint32_t)cloths.size();
+    header.recordsOffset = AlignUp(sizeof(header));
+
+    // Lay out every array first so the records can be written before the data
+    std::vector<SceneFormat::ClothRecord> records(cloths.size(), SceneFormat::ClothRecord());
+    size_t offset = AlignUp(header.recordsOffset + records.size() * sizeof(SceneFormat::ClothRecord));
+    for (size_t i = 0; i < cloths.size(); i++) {
+        ClothData cloth = cloths[i]->GetData();
+        SceneFormat::ClothRecord& record = records[i];
+        record.width = cloth.width;
+        record.height = cloth.height;
+        record.flags = cloth.isMesh ? SceneFormat::RECORD_MESH : 0;
+        record.spacing = cloth.spacing;
+        record.originX = cloth.originX;
+        record.originY = cloth.originY;
+        record.gravityForce = cloth.gravityForce;
+        record.springStiffness = cloth.springStiffness;
+        record.springDamping = cloth.springDamping;
+        record.renderDetail = cloth.renderDetail;
+        record.showWires = cloth.showWires ? 1 : 0;
+        record.aero = cloth.aero;
+        record.pointCount = cloth.pointCount;
+        record.springCount = cloth.springCount;
+        record.faceCount = cloth.faceCount;
+        record.pointsOffset = offset;
+        offset = AlignUp(offset + cloth.pointCount * sizeof(PointMass));
+        record.springsOffset = offset;
+        offset = AlignUp(offset + cloth.springCount * sizeof(Spring));
+        record.facesOffset = offset;
+        offset = AlignUp(offset + cloth.faceCount * sizeof(Face));
+        record.edgeSpringsOffset = offset;
+        offset = AlignUp(offset + cloth.faceCount * 3 * sizeof(int32_t));
+    }
+    header.fileSize = offset;
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    size_t written = 0;
+    auto put = [out, &written](const void* bytes, size_t count, size_t at) {
+        static const unsigned char zeros[SceneFormat::ALIGNMENT] = {};
+        while (written < at) {
+            size_t pad = std::min(at - written, sizeof(zeros));
+            fwrite(zeros, 1, pad, out);
+            written += pad;
+        }
+        if (count) fwrite(bytes, 1, count, out);
+        written += count;
+    };
+
+    put(&header, sizeof(header), 0);
+    put(records.data(), records.size() * sizeof(SceneFormat::ClothRecord), header.recordsOffset);
+    for (size_t i = 0; i < cloths.size(); i++) {
+        ClothData cloth = cloths[i]->GetData();
+        const SceneFormat::ClothRecord& record = records[i];
+        std::vector<PointMass> points = CleanPoints(cloth);
+        std::vector<Spring> springs = CleanSprings(cloth);
+        put(points.data(), points.size() * sizeof(PointMass), record.pointsOffset);
+        put(springs.data(), springs.size() * sizeof(Spring), record.springsOffset);
+        put(cloth.faces, cloth.faceCount * sizeof(Face), record.facesOffset);
+        put(cloth.faceEdgeSprings, cloth.faceCount * 3 * sizeof(int32_t), record.edgeSpringsOffset);
+    }
+    put(nullptr, 0, header.fileSize);
+
+    bool ok = !ferror(out);
+    return fclose(out) == 0 && ok;
+}
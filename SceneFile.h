@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Cloth.h"
+
+// Binary scene file. A header and a table of cloth records are followed by
+// the cloths' arrays, each 64-byte aligned and stored exactly as Cloth keeps
+// them in memory (PointMass, Spring and Face records plus the face edge to
+// spring table), so loading is a mapping and one block copy per array. The
+// header records the record sizes; a file written by a build with a different
+// struct layout is rejected rather than misread.
+namespace SceneFormat {
+
+const uint32_t MAGIC = 0x43534C43;  // "CLSC"
+const uint32_t VERSION = 3;  // 2: springs carry their family, 3: mesh cloths are flagged
+const size_t ALIGNMENT = 64;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pointSize;   // sizeof(PointMass) and friends in the writing build
+    uint32_t springSize;
+    uint32_t faceSize;
+    uint32_t recordSize;
+    uint32_t clothCount;
+    uint32_t reserved;
+    uint64_t recordsOffset;
+    uint64_t fileSize;
+};
+
+// Every member starts at zero, so records written for the same cloths are byte-identical
+const int32_t RECORD_MESH = 1;  // Points are a triangle mesh, not a width x height grid
+
+struct ClothRecord {
+    int32_t width = 0, height = 0;
+    float spacing = 0.0f;
+    float originX = 0.0f, originY = 0.0f;
+    float gravityForce = 0.0f, springStiffness = 0.0f, springDamping = 0.0f;
+    int32_t renderDetail = 0;
+    int32_t showWires = 0;
+    AeroSettings aero;
+    int32_t pointCount = 0, springCount = 0, faceCount = 0;
+    int32_t flags = 0;             // RECORD_MESH
+    uint64_t pointsOffset = 0;     // From the start of the file
+    uint64_t springsOffset = 0;
+    uint64_t facesOffset = 0;
+    uint64_t edgeSpringsOffset = 0;
+};
+
+} // namespace SceneFormat
+
+// Read-only mapping of a scene file. The ClothData views point straight into
+// the mapping and stay valid until Close.
+class SceneFile {
+public:
+    SceneFile();
+    ~SceneFile();
+
+    bool Open(const std::string& path);  // Maps and validates; false if unreadable or malformed
+    void Close();
+    int GetClothCount() const;
+    ClothData GetCloth(int index) const;
+
+    // Writes the cloths as they are now; call before stepping them. Fails for
+    // parked cloths, whose arrays are only held in compact form
+    static bool Write(const std::string& path, const std::vector<const Cloth*>& cloths);
+
+private:
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    const SceneFormat::Header* GetHeader() const {
+        return reinterpret_cast<const SceneFormat::Header*>(data);
+    }
+    const SceneFormat::ClothRecord* GetRecord(int index) const;
+    bool Validate() const;
+};
@@ -0,0 +1,597 @@
+#include "SimulationDaemon.h"
+#include "Cloth.h"
+#include "SceneFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;  // A vanished peer is an error, not SIGPIPE
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+namespace DaemonProtocol {
+
+Preset GridPreset(int resolution) {
+    Preset preset;
+    memset(&preset, 0, sizeof(preset));  // Presets are compared bytewise
+    preset.resolution = resolution;
+    preset.gravity = 0.5f;
+    preset.stiffness = 0.5f;
+    preset.damping = 0.5f;
+    preset.maxStretch = 2.0f;
+    preset.flags = FLAG_PIN_CORNERS;
+    return preset;
+}
+
+Request MakeRequest(Command command, int instance) {
+    Request request;
+    memset(&request, 0, sizeof(request));
+    request.magic = MAGIC;
+    request.version = VERSION;
+    request.command = command;
+    request.instance = instance;
+    return request;
+}
+
+} // namespace DaemonProtocol
+
+using namespace DaemonProtocol;
+
+namespace {
+
+const int IDLE_POLL_MS = 100;  // Bounds how long Stop takes to be noticed
+
+bool FillAddress(const std::string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+bool SetNonBlocking(int socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Flags that change the template; the rest are applied to each instance
+const uint32_t TEMPLATE_FLAGS = FLAG_PIN_CORNERS;
+
+// Whether two presets build the same template. Field by field, so padding and
+// the bytes after the scene path's terminator do not matter, and a scene
+// preset ignores the grid fields as documented.
+bool SameTemplate(const Preset& a, const Preset& b) {
+    if (strncmp(a.scene, b.scene, sizeof(a.scene)) != 0) return false;
+    if (a.scene[0]) return a.sceneCloth == b.sceneCloth;
+    return a.resolution == b.resolution && a.gravity == b.gravity && a.stiffness == b.stiffness &&
+           a.damping == b.damping && a.maxStretch == b.maxStretch &&
+           (a.flags & TEMPLATE_FLAGS) == (b.flags & TEMPLATE_FLAGS);
+}
+
+} // namespace
+
+SimulationDaemon::SimulationDaemon()
+    : listenSocket(-1), stopping(false), scheduler(&TaskScheduler::Default()), batchWindow(0), parkTimeout(5.0),
+      nextInstance(1), templateClock(0), stats() {}
+
+SimulationDaemon::~SimulationDaemon() {
+    Close();
+}
+
+bool SimulationDaemon::Open(const std::string& path) {
+    Close();
+
+    sockaddr_un address;
+    if (!FillAddress(path, address)) return false;
+
+    // A socket file nobody answers on is left over from a daemon that died
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) return false;
+    bool live = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    close(probe);
+    if (live) return false;
+    unlink(path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0 ||
+        !SetNonBlocking(listener)) {
+        close(listener);
+        return false;
+    }
+
+    listenSocket = listener;
+    socketPath = path;
+    segmentPrefix = "/cloth_daemon_" + std::to_string((long long)getpid()) + "_";
+    stats = Stats();
+    stopping.store(false);
+    return true;
+}
+
+void SimulationDaemon::Close() {
+    jobs.clear();
+    instances.clear();  // Unlinks their segments
+    templates.clear();
+    for (auto& connection : connections) close(connection->socket);
+    connections.clear();
+    if (listenSocket < 0) return;
+    close(listenSocket);
+    unlink(socketPath.c_str());
+    listenSocket = -1;
+}
+
+bool SimulationDaemon::Serve() {
+    if (listenSocket < 0) return false;
+
+    std::vector<pollfd> polled;
+    while (!stopping.load()) {
+        // Sleep until input arrives, the batch window closes, or Stop is checked
+        int timeout = IDLE_POLL_MS;
+        if (!jobs.empty()) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(batchDeadline - Clock::now()).count();
+            timeout = (int)std::max<long long>(0, std::min<long long>(timeout, left));
+        }
+        for (auto& connection : connections) {
+            if (HasPendingRequest(*connection)) timeout = 0;
+        }
+
+        polled.clear();
+        polled.push_back({listenSocket, POLLIN, 0});
+        for (auto& connection : connections) {
+            short events = connection->hungUp ? 0 : POLLIN;
+            if (!connection->output.empty()) events |= POLLOUT;
+            // Hung up sockets report POLLHUP forever; leave them out until they are dropped
+            polled.push_back({events ? connection->socket : -1, events, 0});
+        }
+        if (poll(polled.data(), polled.size(), timeout) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        // Connections accepted now are polled from the next round on
+        size_t polledConnections = connections.size();
+        if (polled[0].revents & POLLIN) Accept();
+        for (size_t i = 0; i < polledConnections; i++) {
+            short events = polled[i + 1].revents;
+            if (events & (POLLIN | POLLHUP | POLLERR)) Receive(*connections[i]);
+            if (events & POLLOUT) Flush(*connections[i]);
+        }
+
+        for (auto& connection : connections) HandleRequests(*connection);
+        if (!jobs.empty() && Clock::now() >= batchDeadline) RunBatch();
+        for (auto& connection : connections) Flush(*connection);
+
+        DropClosedConnections();
+        ParkIdleInstances();
+    }
+    return true;
+}
+
+void SimulationDaemon::Accept() {
+    while (true) {
+        int client = accept(listenSocket, nullptr, nullptr);
+        if (client < 0) return;  // EAGAIN once the backlog is empty
+        if (!SetNonBlocking(client)) {
+            close(client);
+            continue;
+        }
+        std::unique_ptr<Connection> connection(new Connection());
+        connection->socket = client;
+        connection->stepping = false;
+        connection->hungUp = false;
+        connections.push_back(std::move(connection));
+    }
+}
+
+void SimulationDaemon::Receive(Connection& connection) {
+    unsigned char buffer[4096];
+    while (!connection.hungUp) {
+        ssize_t received = recv(connection.socket, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection.input.insert(connection.input.end(), buffer, buffer + received);
+        } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        } else if (received < 0 && errno == EINTR) {
+            continue;
+        } else {
+            connection.hungUp = true;  // Requests already buffered are still answered
+        }
+    }
+}
+
+void SimulationDaemon::Flush(Connection& connection) {
+    size_t written = 0;
+    while (written < connection.output.size()) {
+        ssize_t sent = send(connection.socket, connection.output.data() + written, connection.output.size() - written,
+                            SEND_FLAGS);
+        if (sent > 0) {
+            written += (size_t)sent;
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            // Nobody is left to read the rest
+            connection.hungUp = true;
+            connection.input.clear();
+            written = connection.output.size();
+        }
+    }
+    connection.output.erase(connection.output.begin(), connection.output.begin() + written);
+}
+
+bool SimulationDaemon::HasPendingRequest(const Connection& connection) const {
+    return !connection.stepping && connection.input.size() >= sizeof(Request);
+}
+
+void SimulationDaemon::HandleRequests(Connection& connection) {
+    // In order, stopping at a STEP so later requests see its result
+    size_t consumed = 0;
+    while (!connection.stepping && connection.input.size() - consumed >= sizeof(Request)) {
+        Request request;
+        memcpy(&request, connection.input.data() + consumed, sizeof(request));
+        consumed += sizeof(request);
+        stats.requests++;
+        Execute(connection, request);
+        if (connection.input.empty()) return;  // Execute gave up on the stream
+    }
+    connection.input.erase(connection.input.begin(), connection.input.begin() + consumed);
+}
+
+void SimulationDaemon::Reply(Connection& connection, const Response& response) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&response);
+    connection.output.insert(connection.output.end(), bytes, bytes + sizeof(response));
+}
+
+SimulationDaemon::Instance* SimulationDaemon::FindInstance(const Connection& connection, int id) {
+    auto found = instances.find(id);
+    if (found == instances.end() || found->second->owner != &connection) return nullptr;
+    return found->second.get();
+}
+
+void SimulationDaemon::Execute(Connection& connection, const Request& request) {
+    Response response;
+    memset(&response, 0, sizeof(response));
+    response.magic = MAGIC;
+    response.id = request.id;
+    response.instance = request.instance;
+    response.status = OK;
+
+    if (request.magic != MAGIC || request.version != VERSION) {
+        // Record boundaries can no longer be trusted; answer once and stop reading
+        response.status = BAD_REQUEST;
+        Reply(connection, response);
+        connection.input.clear();
+        connection.hungUp = true;
+        return;
+    }
+
+    Instance* instance = nullptr;
+    if (request.command == STEP || request.command == SNAPSHOT || request.command == QUERY ||
+        request.command == RELEASE) {
+        instance = FindInstance(connection, request.instance);
+        if (!instance) {
+            response.status = NO_INSTANCE;
+            Reply(connection, response);
+            return;
+        }
+        instance->lastUse = Clock::now();
+    }
+
+    switch (request.command) {
+        case OPEN: {
+            Cloth* cloth = CreateCloth(request.preset);
+            if (!cloth) {
+                response.status = FAILED;
+                break;
+            }
+            std::unique_ptr<Instance> created(new Instance());
+            created->owner = &connection;
+            created->cloth.reset(cloth);
+            created->lastUse = Clock::now();
+            response.instance = nextInstance++;
+            response.pointCount = (int32_t)cloth->GetPoints().size();
+            response.springCount = (int32_t)cloth->GetSprings().size();
+            instances[response.instance] = std::move(created);
+            stats.instancesOpened++;
+            break;
+        }
+        case STEP: {
+            if (request.steps < 0 || !(request.dt > 0.0f)) {
+                response.status = BAD_REQUEST;
+                break;
+            }
+            if (request.steps == 0) {
+                response.time = instance->cloth->GetTime();
+                break;
+            }
+            // Answered by RunBatch; the window opens with the first queued step
+            if (jobs.empty()) batchDeadline = Clock::now() + std::chrono::milliseconds(batchWindow);
+            jobs.push_back({&connection, instance, request.id, request.instance, request.steps, request.dt});
+            connection.stepping = true;
+            return;
+        }
+        case SNAPSHOT:
+            Snapshot(request.instance, *instance, response);
+            break;
+        case QUERY: {
+            Cloth& cloth = *instance->cloth;
+            if (cloth.IsCompact()) cloth.Expand();
+            response.pointCount = (int32_t)cloth.GetPoints().size();
+            response.springCount = (int32_t)cloth.GetSprings().size();
+            response.brokenSprings = cloth.GetBrokenSpringCount();
+            response.substeps = cloth.GetSubsteps();
+            response.rollbacks = cloth.GetRollbackCount();
+            response.time = cloth.GetTime();
+            response.energy = cloth.GetEnergy();
+            response.springEnergy = cloth.GetSpringEnergy();
+            response.maxStrain = cloth.GetMaxStrain();
+            response.stateHash = cloth.GetStateHash();
+            break;
+        }
+        case RELEASE:
+            instances.erase(request.instance);
+            break;
+        case SHUTDOWN:
+            stopping.store(true);
+            break;
+        default:
+            response.status = BAD_REQUEST;
+            break;
+    }
+    Reply(connection, response);
+}
+
+void SimulationDaemon::Snapshot(int id, Instance& instance, Response& response) {
+    Cloth& cloth = *instance.cloth;
+    if (cloth.IsCompact()) cloth.Expand();
+
+    // Sized for the point capacity, which tearing never exceeds
+    std::string segment = segmentPrefix + std::to_string(id);
+    if (segment.size() >= sizeof(response.segment) ||
+        (!instance.publisher.IsOpen() && !instance.publisher.Open(cloth, segment)) || !instance.publisher.Publish(cloth)) {
+        response.status = FAILED;
+        return;
+    }
+    response.frame = instance.publisher.GetFrameCount() - 1;
+    memcpy(response.segment, segment.c_str(), segment.size() + 1);
+}
+
+void SimulationDaemon::RunBatch() {
+    int count = (int)jobs.size();
+
+    // A batch spreads whole cloths over the pool, so their own phases run
+    // inline; a lone step keeps the pool for its parallel phases
+    TaskScheduler* clothPool = count > 1 ? nullptr : scheduler;
+    for (StepJob& job : jobs) {
+        job.instance->cloth->SetScheduler(clothPool);
+    }
+    scheduler->ParallelFor(count, 1, batchTuning, [this](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            StepJob& job = jobs[j];
+            int frames = std::min(job.remaining, ROUND_FRAMES);
+            job.instance->cloth->Step(frames, job.dt);
+            job.remaining -= frames;
+        }
+    });
+    for (StepJob& job : jobs) {
+        job.instance->cloth->SetScheduler(scheduler);
+    }
+    stats.batches++;
+    stats.batchedSteps += count;
+    stats.largestBatch = std::max(stats.largestBatch, count);
+
+    // Answer finished steps in queue order; the rest go straight into the next round
+    size_t kept = 0;
+    for (StepJob& job : jobs) {
+        job.instance->lastUse = Clock::now();
+        if (job.remaining > 0) {
+            jobs[kept++] = job;
+            continue;
+        }
+        Response response;
+        memset(&response, 0, sizeof(response));
+        response.magic = MAGIC;
+        response.id = job.requestId;
+        response.status = OK;
+        response.instance = job.instanceId;
+        response.batchSize = count;
+        response.substeps = job.instance->cloth->GetSubsteps();
+        response.time = job.instance->cloth->GetTime();
+        Reply(*job.connection, response);
+        job.connection->stepping = false;
+    }
+    jobs.resize(kept);
+    batchDeadline = Clock::now();
+}
+
+void SimulationDaemon::DropClosedConnections() {
+    for (size_t i = 0; i < connections.size();) {
+        Connection& connection = *connections[i];
+        // Kept until its queued step and every buffered request are answered
+        bool done = connection.hungUp && !connection.stepping && !HasPendingRequest(connection) &&
+                    connection.output.empty();
+        if (!done) {
+            i++;
+            continue;
+        }
+        for (auto it = instances.begin(); it != instances.end();) {
+            it = it->second->owner == &connection ? instances.erase(it) : std::next(it);
+        }
+        close(connection.socket);
+        connections.erase(connections.begin() + i);
+    }
+}
+
+void SimulationDaemon::ParkIdleInstances() {
+    if (parkTimeout <= 0.0) return;
+    auto cutoff = Clock::now() - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(parkTimeout));
+    for (auto& entry : instances) {
+        Instance& instance = *entry.second;
+        if (instance.owner->stepping || instance.cloth->IsCompact() || instance.lastUse > cutoff) continue;
+        // Cloths with too many materials stay expanded; either way they are not retried until used again
+        if (instance.cloth->Compact()) stats.instancesParked++;
+        instance.lastUse = Clock::time_point::max();
+    }
+}
+
+Cloth* SimulationDaemon::CreateCloth(const Preset& requested) {
+    Preset preset = requested;
+    preset.scene[sizeof(preset.scene) - 1] = '\0';
+
+    auto found = std::find_if(templates.begin(), templates.end(), [&preset](const Template& entry) {
+        return SameTemplate(entry.preset, preset);
+    });
+    auto start = Clock::now();
+    if (found == templates.end()) {
+        std::unique_ptr<Cloth> built;
+        if (preset.scene[0]) {
+            SceneFile file;
+            if (!file.Open(preset.scene) || preset.sceneCloth < 0 || preset.sceneCloth >= file.GetClothCount()) {
+                return nullptr;
+            }
+            built.reset(new Cloth(file.GetCloth(preset.sceneCloth)));
+        } else {
+            if (preset.resolution < 2 || preset.resolution > MAX_RESOLUTION) return nullptr;
+            built.reset(Cloth::CreateWithResolution(preset.resolution));
+            built->SetGravity(preset.gravity);
+            built->SetStiffness(preset.stiffness);
+            built->SetDamping(preset.damping);
+            built->SetMaxStretch(preset.maxStretch);
+            if (preset.flags & FLAG_PIN_CORNERS) {
+                built->FixPoint(0, 0);
+                built->FixPoint(preset.resolution - 1, 0);
+            }
+        }
+
+        if (templates.size() >= (size_t)MAX_TEMPLATES) {
+            templates.erase(std::min_element(templates.begin(), templates.end(),
+                                             [](const Template& a, const Template& b) { return a.lastUse < b.lastUse; }));
+        }
+        templates.push_back(Template());
+        templates.back().preset = preset;
+        templates.back().cloth = std::move(built);
+        found = templates.end() - 1;
+        stats.templatesBuilt++;
+        stats.buildMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        start = Clock::now();
+    }
+    found->lastUse = ++templateClock;
+
+    // Settings outside ClothData are applied per instance
+    Cloth* cloth = new Cloth(found->cloth->GetData());
+    cloth->SetDeterministic((preset.flags & FLAG_DETERMINISTIC) != 0);
+    cloth->SetScheduler(scheduler);
+    stats.openMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return cloth;
+}
+
+DaemonClient::DaemonClient() : socket(-1), nextId(1) {}
+
+DaemonClient::~DaemonClient() {
+    Close();
+}
+
+bool DaemonClient::Connect(const std::string& path) {
+    Close();
+    sockaddr_un address;
+    if (!FillAddress(path, address)) return false;
+    int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client < 0) return false;
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(client);
+        return false;
+    }
+    socket = client;
+    return true;
+}
+
+void DaemonClient::Close() {
+    reader.Close();
+    readerSegment.clear();
+    if (socket < 0) return;
+    close(socket);
+    socket = -1;
+}
+
+bool DaemonClient::Send(Request& request) {
+    if (socket < 0) return false;
+    request.id = nextId++;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&request);
+    size_t written = 0;
+    while (written < sizeof(request)) {
+        ssize_t sent = send(socket, bytes + written, sizeof(request) - written, SEND_FLAGS);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        written += (size_t)sent;
+    }
+    return true;
+}
+
+bool DaemonClient::Receive(Response& response) {
+    if (socket < 0) return false;
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&response);
+    size_t received = 0;
+    while (received < sizeof(response)) {
+        ssize_t got = recv(socket, bytes + received, sizeof(response) - received, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        received += (size_t)got;
+    }
+    return response.magic == MAGIC;
+}
+
+bool DaemonClient::Call(Request& request, Response& response) {
+    return Send(request) && Receive(response) && response.id == request.id;
+}
+
+int DaemonClient::Open(const Preset& preset) {
+    Request request = MakeRequest(OPEN);
+    request.preset = preset;
+    Response response;
+    if (!Call(request, response) || response.status != OK) return -1;
+    return response.instance;
+}
+
+bool DaemonClient::Step(int instance, int steps, float dt, Response* result) {
+    Request request = MakeRequest(STEP, instance);
+    request.steps = steps;
+    request.dt = dt;
+    Response response;
+    if (!Call(request, response)) return false;
+    if (result) *result = response;
+    return response.status == OK;
+}
+
+bool DaemonClient::Query(int instance, Response& response) {
+    Request request = MakeRequest(QUERY, instance);
+    return Call(request, response) && response.status == OK;
+}
+
+bool DaemonClient::Release(int instance) {
+    Request request = MakeRequest(RELEASE, instance);
+    Response response;
+    return Call(request, response) && response.status == OK;
+}
+
+bool DaemonClient::Shutdown() {
+    Request request = MakeRequest(SHUTDOWN);
+    Response response;
+    return Call(request, response) && response.status == OK;
+}
+
+bool DaemonClient::MapSegment(const std::string& segment) {
+    if (reader.IsOpen() && segment == readerSegment) return true;
+    readerSegment.clear();
+    if (!reader.Open(segment)) return false;
+    readerSegment = segment;
+    return true;
+}
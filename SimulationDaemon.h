@@ -0,0 +1,227 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "StatePublisher.h"
+#include "TaskScheduler.h"
+
+class Cloth;
+
+// Wire format between the simulation daemon and its clients: fixed-size
+// little records over a Unix stream socket, one response per request, in
+// request order per connection. Snapshots do not travel over the socket; the
+// daemon publishes them to a per-instance shared-memory segment in the
+// StatePublisher layout and the response names the segment.
+namespace DaemonProtocol {
+
+const uint32_t MAGIC = 0x434C4451;  // "CLDQ"
+const uint32_t VERSION = 1;
+const char* const DEFAULT_SOCKET = "/tmp/cloth_daemon.sock";
+
+enum Command : uint32_t {
+    OPEN,      // Warm instance of preset; the response carries its id
+    STEP,      // steps frames of dt, batched with other connections' steps
+    SNAPSHOT,  // Publish the state to the instance's segment
+    QUERY,     // Metrics in the response
+    RELEASE,   // Drop the instance
+    SHUTDOWN   // Stop the daemon once this response is sent
+};
+
+enum Status : int32_t { OK, BAD_REQUEST, NO_INSTANCE, FAILED };
+
+const uint32_t FLAG_DETERMINISTIC = 1;  // Same state for any thread count
+const uint32_t FLAG_PIN_CORNERS = 2;    // Grid presets: fix the top corners
+
+// Cloths with equal presets share one template built on first use. Grid
+// presets use the same normalized values as the GUI sliders; scene presets
+// load cloth sceneCloth of a binary scene file as stored and ignore the
+// grid fields. FLAG_DETERMINISTIC is applied per instance, so presets that
+// differ only in it share a template.
+struct Preset {
+    int32_t resolution;
+    float gravity, stiffness, damping, maxStretch;
+    uint32_t flags;
+    int32_t sceneCloth;
+    char scene[100];  // Binary scene path, empty for a grid
+};
+
+struct Request {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t command;
+    uint32_t id;        // Echoed in the response
+    int32_t instance;
+    int32_t steps;
+    float dt;
+    Preset preset;      // OPEN only
+};
+
+struct Response {
+    uint32_t magic;
+    uint32_t id;
+    int32_t status;
+    int32_t instance;
+    int32_t batchSize;  // STEP: steps that ran alongside this one in its last round
+    int32_t pointCount, springCount, brokenSprings;
+    int32_t substeps, rollbacks;
+    float time, energy, springEnergy, maxStrain;  // Metrics are filled by QUERY
+    uint64_t stateHash;
+    uint64_t frame;     // SNAPSHOT: frame number in the segment
+    char segment[64];   // SNAPSHOT: shared-memory segment name
+};
+
+Preset GridPreset(int resolution);  // Defaults of the GUI, top corners pinned
+Request MakeRequest(Command command, int instance = -1);
+
+} // namespace DaemonProtocol
+
+// Long-lived local simulation server. Templates keep each preset's topology
+// warm, so opening an instance is a block copy instead of a rebuild. Step
+// requests from all connections that arrive together, or within the batch
+// window, run as one parallel batch on the task pool; long requests advance
+// ROUND_FRAMES per round so later arrivals join the next round instead of
+// queueing behind them. One thread owns all state and talks to the sockets.
+class SimulationDaemon {
+public:
+    static constexpr int ROUND_FRAMES = 30;     // Most frames a request advances per batch
+    static constexpr int MAX_TEMPLATES = 16;    // Least recently used beyond this are dropped
+    static constexpr int MAX_RESOLUTION = 400;
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t batches;
+        uint64_t batchedSteps;  // Sum of batch sizes
+        int largestBatch;
+        int templatesBuilt;
+        int instancesOpened;
+        int instancesParked;
+        double buildMs;  // Building templates
+        double openMs;   // Copying instances from templates
+    };
+
+    SimulationDaemon();
+    ~SimulationDaemon();
+
+    // Fails if the path is held by a daemon that still answers
+    bool Open(const std::string& socketPath = DaemonProtocol::DEFAULT_SOCKET);
+    void Close();  // Drops every connection and instance
+    bool IsOpen() const { return listenSocket >= 0; }
+
+    // Serves until Stop or a SHUTDOWN request; false if polling failed
+    bool Serve();
+    void Stop() { stopping.store(true); }  // Safe from signal handlers and other threads
+
+    void SetScheduler(TaskScheduler* pool) { scheduler = pool; }
+    void SetBatchWindow(int milliseconds) { batchWindow = std::max(0, milliseconds); }  // 0 batches what is already queued
+    void SetParkTimeout(double seconds) { parkTimeout = seconds; }  // Idle instances go to compact storage
+    const Stats& GetStats() const { return stats; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Connection {
+        int socket;
+        std::vector<unsigned char> input, output;
+        bool stepping;  // A STEP is queued; later requests wait behind it
+        bool hungUp;    // Peer closed or the stream is unusable
+    };
+
+    struct Template {
+        DaemonProtocol::Preset preset;
+        std::unique_ptr<Cloth> cloth;
+        uint64_t lastUse;
+    };
+
+    struct Instance {
+        Connection* owner;
+        std::unique_ptr<Cloth> cloth;
+        StatePublisher publisher;  // Opened on the first SNAPSHOT
+        Clock::time_point lastUse;
+    };
+
+    struct StepJob {
+        Connection* connection;
+        Instance* instance;
+        uint32_t requestId;
+        int instanceId;
+        int remaining;
+        float dt;
+    };
+
+    int listenSocket;
+    std::string socketPath;
+    std::string segmentPrefix;
+    std::atomic<bool> stopping;
+    TaskScheduler* scheduler;
+    PhaseTuning batchTuning;
+    int batchWindow;
+    double parkTimeout;
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<Template> templates;
+    std::map<int, std::unique_ptr<Instance>> instances;
+    std::vector<StepJob> jobs;
+    Clock::time_point batchDeadline;
+    int nextInstance;
+    uint64_t templateClock;
+    Stats stats;
+
+    void Accept();
+    void Receive(Connection& connection);
+    void Flush(Connection& connection);
+    void HandleRequests(Connection& connection);
+    void Execute(Connection& connection, const DaemonProtocol::Request& request);
+    void Reply(Connection& connection, const DaemonProtocol::Response& response);
+    bool HasPendingRequest(const Connection& connection) const;
+    void RunBatch();
+    void DropClosedConnections();
+    void ParkIdleInstances();
+    Cloth* CreateCloth(const DaemonProtocol::Preset& preset);
+    Instance* FindInstance(const Connection& connection, int id);
+    void Snapshot(int id, Instance& instance, DaemonProtocol::Response& response);
+};
+
+// Blocking client for one connection. Requests may be pipelined with Send
+// and Receive; the helpers send one request and wait for its response.
+class DaemonClient {
+public:
+    DaemonClient();
+    ~DaemonClient();
+
+    bool Connect(const std::string& socketPath = DaemonProtocol::DEFAULT_SOCKET);
+    void Close();
+    bool IsConnected() const { return socket >= 0; }
+
+    bool Send(DaemonProtocol::Request& request);  // Assigns the request id
+    bool Receive(DaemonProtocol::Response& response);
+    // False on a transport error; the daemon's verdict is response.status
+    bool Call(DaemonProtocol::Request& request, DaemonProtocol::Response& response);
+
+    int Open(const DaemonProtocol::Preset& preset);  // Instance id, -1 on failure
+    bool Step(int instance, int steps, float dt, DaemonProtocol::Response* response = nullptr);
+    bool Query(int instance, DaemonProtocol::Response& response);
+    bool Release(int instance);
+    bool Shutdown();
+
+    // Publishes the instance's state and runs visit(view) on it in place, as
+    // StateReader::ReadLatest does; the segment stays mapped between calls
+    template <typename Visit>
+    bool Snapshot(int instance, const Visit& visit) {
+        DaemonProtocol::Request request = DaemonProtocol::MakeRequest(DaemonProtocol::SNAPSHOT, instance);
+        DaemonProtocol::Response response;
+        if (!Call(request, response) || response.status != DaemonProtocol::OK) return false;
+        if (!MapSegment(response.segment)) return false;
+        return reader.ReadLatest(visit);
+    }
+
+private:
+    int socket;
+    uint32_t nextId;
+    StateReader reader;
+    std::string readerSegment;
+
+    bool MapSegment(const std::string& segment);
+};
@@ -0,0 +1,381 @@
+#include "SoftRenderer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+const uint32_t OUTLINE = 0x000000;  // GDI's default pen
+const int DOT_RADIUS = 3;
+
+struct Span {
+    int left, top, right, bottom;  // Pixels, inclusive
+};
+
+// Whole-pixel corners, truncated like the LONG casts of the GDI path
+inline int Snap(float value) {
+    return (int)value;
+}
+
+// Pixels whose centres lie within halfWidth of the segment between the
+// centres of pixels (ax, ay) and (bx, by). That capsule is convex, so each row
+// covers one span: the union of the strip along the segment and the two end
+// discs, solved per row instead of testing every pixel of the bounds.
+void FillSegment(uint32_t* pixels, int stride, const Span& clip, int ax, int ay, int bx, int by,
+                 float halfWidth, uint32_t color) {
+    int reach = (int)std::ceil(halfWidth);
+    int top = std::max(clip.top, std::min(ay, by) - reach);
+    int bottom = std::min(clip.bottom, std::max(ay, by) + reach);
+    if (std::max(ax, bx) + reach < clip.left || std::min(ax, bx) - reach > clip.right) return;
+
+    float dx = (float)(bx - ax);
+    float dy = (float)(by - ay);
+    float lengthSq = dx * dx + dy * dy;
+    float reachAlong = halfWidth * std::sqrt(lengthSq);  // |cross| bound of the strip
+    float limit = halfWidth * halfWidth;
+    for (int y = top; y <= bottom; y++) {
+        float py = (float)(y - ay);
+        float low = 1e30f, high = -1e30f;
+
+        // End discs around A (x = 0) and B (x = dx)
+        float discA = limit - py * py;
+        if (discA >= 0.0f) {
+            float half = std::sqrt(discA);
+            low = std::min(low, -half);
+            high = std::max(high, half);
+        }
+        float qy = py - dy;
+        float discB = limit - qy * qy;
+        if (discB >= 0.0f) {
+            float half = std::sqrt(discB);
+            low = std::min(low, dx - half);
+            high = std::max(high, dx + half);
+        }
+
+        // Strip: |px * dy - py * dx| <= reachAlong and 0 <= px * dx + py * dy <= lengthSq
+        if (lengthSq > 0.0f) {
+            float stripLow = -1e30f, stripHigh = 1e30f;
+            bool empty = false;
+            if (dy != 0.0f) {
+                float e0 = (py * dx - reachAlong) / dy;
+                float e1 = (py * dx + reachAlong) / dy;
+                stripLow = std::max(stripLow, std::min(e0, e1));
+                stripHigh = std::min(stripHigh, std::max(e0, e1));
+            } else if (std::abs(py * dx) > reachAlong) {
+                empty = true;
+            }
+            if (dx != 0.0f) {
+                float t0 = (-py * dy) / dx;
+                float t1 = (lengthSq - py * dy) / dx;
+                stripLow = std::max(stripLow, std::min(t0, t1));
+                stripHigh = std::min(stripHigh, std::max(t0, t1));
+            } else if (py * dy < 0.0f || py * dy > lengthSq) {
+                empty = true;
+            }
+            if (!empty && stripLow <= stripHigh) {
+                low = std::min(low, stripLow);
+                high = std::max(high, stripHigh);
+            }
+        }
+        if (low > high) continue;
+
+        int left = std::max(clip.left, ax + (int)std::ceil(low));
+        int right = std::min(clip.right, ax + (int)std::floor(high));
+        uint32_t* row = pixels + (size_t)y * stride;
+        for (int x = left; x <= right; x++) row[x] = color;
+    }
+}
+
+// Edge functions at pixel centres; ties on the shared edge of two faces go to
+// both, which only matters where their shades differ by one step
+void FillTriangle(uint32_t* pixels, int stride, const Span& clip, const int* x, const int* y, uint32_t color) {
+    int left = std::max(clip.left, std::min(x[0], std::min(x[1], x[2])));
+    int right = std::min(clip.right, std::max(x[0], std::max(x[1], x[2])) - 1);
+    int top = std::max(clip.top, std::min(y[0], std::min(y[1], y[2])));
+    int bottom = std::min(clip.bottom, std::max(y[0], std::max(y[1], y[2])) - 1);
+    if (left > right || top > bottom) return;
+
+    long long area = (long long)(x[1] - x[0]) * (y[2] - y[0]) - (long long)(x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0) return;
+    int order[3] = {0, 1, 2};
+    if (area < 0) std::swap(order[1], order[2]);
+
+    // e_i(p) = a_i * px + b_i * py + c_i, positive inside
+    float a[3], b[3], c[3];
+    for (int e = 0; e < 3; e++) {
+        int i = order[e];
+        int j = order[(e + 1) % 3];
+        a[e] = (float)(y[i] - y[j]);
+        b[e] = (float)(x[j] - x[i]);
+        c[e] = (float)x[i] * y[j] - (float)x[j] * y[i];
+    }
+    float cx = left + 0.5f;
+    for (int py = top; py <= bottom; py++) {
+        uint32_t* row = pixels + (size_t)py * stride;
+        float cy = py + 0.5f;
+        float w0 = a[0] * cx + b[0] * cy + c[0];
+        float w1 = a[1] * cx + b[1] * cy + c[1];
+        float w2 = a[2] * cx + b[2] * cy + c[2];
+        for (int px = left; px <= right; px++) {
+            if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) row[px] = color;
+            w0 += a[0];
+            w1 += a[1];
+            w2 += a[2];
+        }
+    }
+}
+
+void FillDot(uint32_t* pixels, int stride, const Span& clip, int cx, int cy, uint32_t color) {
+    // Ellipse(cx - 3, cy - 3, cx + 3, cy + 3): pixels cx - 3 .. cx + 2, centred on the corner (cx, cy)
+    int left = std::max(clip.left, cx - DOT_RADIUS);
+    int right = std::min(clip.right, cx + DOT_RADIUS - 1);
+    int top = std::max(clip.top, cy - DOT_RADIUS);
+    int bottom = std::min(clip.bottom, cy + DOT_RADIUS - 1);
+    const float outer = (float)(DOT_RADIUS * DOT_RADIUS);
+    const float inner = (float)((DOT_RADIUS - 1) * (DOT_RADIUS - 1));
+    for (int y = top; y <= bottom; y++) {
+        uint32_t* row = pixels + (size_t)y * stride;
+        float dy = y + 0.5f - cy;
+        for (int x = left; x <= right; x++) {
+            float dx = x + 0.5f - cx;
+            float distance = dx * dx + dy * dy;
+            if (distance <= inner) {
+                row[x] = color;
+            } else if (distance <= outer) {
+                row[x] = OUTLINE;
+            }
+        }
+    }
+}
+
+// PNG checksums
+uint32_t Crc32(const unsigned char* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[n] = c;
+        }
+        return entries;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void PutBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+void PutChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+    PutBigEndian(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBigEndian(out, Crc32(&out[start], out.size() - start));
+}
+
+} // namespace
+
+void DrawList::AddTriangle(float ax, float ay, float bx, float by, float cx, float cy, uint32_t color) {
+    DrawPrimitive primitive = {DrawPrimitive::TRIANGLE, color, {ax, bx, cx}, {ay, by, cy}};
+    primitives.push_back(primitive);
+}
+
+void DrawList::AddLine(float ax, float ay, float bx, float by, uint32_t color) {
+    DrawPrimitive primitive = {DrawPrimitive::LINE, color, {ax, bx, 0.0f}, {ay, by, 0.0f}};
+    primitives.push_back(primitive);
+}
+
+void DrawList::AddDot(float x, float y, uint32_t color) {
+    DrawPrimitive primitive = {DrawPrimitive::DOT, color, {x, 0.0f, 0.0f}, {y, 0.0f, 0.0f}};
+    primitives.push_back(primitive);
+}
+
+SoftRenderer::SoftRenderer(int width, int height)
+    : width(std::max(1, width)), height(std::max(1, height)), scheduler(&TaskScheduler::Default()) {
+    tilesX = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+    pixels.assign((size_t)this->width * this->height, BACKGROUND);
+    binStart.resize(tilesX * tilesY + 1);
+    binCursor.resize(tilesX * tilesY);
+}
+
+void SoftRenderer::Bin(const DrawList& list) {
+    int count = (int)list.primitives.size();
+    bounds.resize(count * 4);
+    std::fill(binCursor.begin(), binCursor.end(), 0);
+
+    // Pixel bounds including pens and outlines, then the tiles they touch
+    for (int p = 0; p < count; p++) {
+        const DrawPrimitive& primitive = list.primitives[p];
+        int corners = primitive.type == DrawPrimitive::TRIANGLE ? 3 : (primitive.type == DrawPrimitive::LINE ? 2 : 1);
+        int reach = primitive.type == DrawPrimitive::DOT ? DOT_RADIUS : 1;
+        int left = Snap(primitive.x[0]), right = left;
+        int top = Snap(primitive.y[0]), bottom = top;
+        for (int k = 1; k < corners; k++) {
+            left = std::min(left, Snap(primitive.x[k]));
+            right = std::max(right, Snap(primitive.x[k]));
+            top = std::min(top, Snap(primitive.y[k]));
+            bottom = std::max(bottom, Snap(primitive.y[k]));
+        }
+        int* range = &bounds[p * 4];
+        left -= reach;
+        top -= reach;
+        right += reach;
+        bottom += reach;
+        if (right < 0 || bottom < 0 || left >= width || top >= height) {
+            range[0] = 1;
+            range[2] = 0;
+            continue;
+        }
+        range[0] = std::max(0, left) / TILE_SIZE;
+        range[1] = std::max(0, top) / TILE_SIZE;
+        range[2] = std::min(width - 1, right) / TILE_SIZE;
+        range[3] = std::min(height - 1, bottom) / TILE_SIZE;
+        for (int ty = range[1]; ty <= range[3]; ty++) {
+            for (int tx = range[0]; tx <= range[2]; tx++) binCursor[ty * tilesX + tx]++;
+        }
+    }
+
+    int tiles = tilesX * tilesY;
+    binStart[0] = 0;
+    for (int t = 0; t < tiles; t++) {
+        binStart[t + 1] = binStart[t] + binCursor[t];
+        binCursor[t] = binStart[t];
+    }
+    binItems.resize(binStart[tiles]);
+    for (int p = 0; p < count; p++) {
+        const int* range = &bounds[p * 4];
+        for (int ty = range[1]; range[0] <= range[2] && ty <= range[3]; ty++) {
+            for (int tx = range[0]; tx <= range[2]; tx++) binItems[binCursor[ty * tilesX + tx]++] = p;
+        }
+    }
+}
+
+void SoftRenderer::RasterizeTile(const DrawList& list, int tile) {
+    Span clip;
+    clip.left = (tile % tilesX) * TILE_SIZE;
+    clip.top = (tile / tilesX) * TILE_SIZE;
+    clip.right = std::min(width, clip.left + TILE_SIZE) - 1;
+    clip.bottom = std::min(height, clip.top + TILE_SIZE) - 1;
+    uint32_t* target = pixels.data();
+
+    for (int y = clip.top; y <= clip.bottom; y++) {
+        std::fill(target + (size_t)y * width + clip.left, target + (size_t)y * width + clip.right + 1, BACKGROUND);
+    }
+
+    for (int i = binStart[tile]; i < binStart[tile + 1]; i++) {
+        const DrawPrimitive& primitive = list.primitives[binItems[i]];
+        switch (primitive.type) {
+            case DrawPrimitive::TRIANGLE: {
+                int x[3] = {Snap(primitive.x[0]), Snap(primitive.x[1]), Snap(primitive.x[2])};
+                int y[3] = {Snap(primitive.y[0]), Snap(primitive.y[1]), Snap(primitive.y[2])};
+                FillTriangle(target, width, clip, x, y, primitive.color);
+                for (int e = 0; e < 3; e++) {
+                    int n = (e + 1) % 3;
+                    FillSegment(target, width, clip, x[e], y[e], x[n], y[n], 0.5f, OUTLINE);
+                }
+                break;
+            }
+            case DrawPrimitive::LINE:
+                FillSegment(target, width, clip, Snap(primitive.x[0]), Snap(primitive.y[0]),
+                            Snap(primitive.x[1]), Snap(primitive.y[1]), 1.0f, primitive.color);
+                break;
+            case DrawPrimitive::DOT:
+                FillDot(target, width, clip, Snap(primitive.x[0]), Snap(primitive.y[0]), primitive.color);
+                break;
+        }
+    }
+}
+
+void SoftRenderer::Render(const DrawList& list) {
+    Bin(list);
+    auto body = [this, &list](int begin, int end) {
+        for (int tile = begin; tile < end; tile++) RasterizeTile(list, tile);
+    };
+    if (scheduler) {
+        scheduler->ParallelFor(tilesX * tilesY, 1, tuning, body);
+    } else {
+        body(0, tilesX * tilesY);
+    }
+}
+
+void SoftRenderer::PackRGB(std::vector<unsigned char>& rgb) const {
+    rgb.resize(pixels.size() * 3);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        rgb[i * 3] = (unsigned char)(pixels[i] >> 16);
+        rgb[i * 3 + 1] = (unsigned char)(pixels[i] >> 8);
+        rgb[i * 3 + 2] = (unsigned char)pixels[i];
+    }
+}
+
+bool SoftRenderer::WriteRaw(FILE* out) const {
+    std::vector<unsigned char> rgb;
+    PackRGB(rgb);
+    return fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+}
+
+bool SoftRenderer::WritePPM(const std::string& path) const {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    bool ok = WriteRaw(out);
+    return fclose(out) == 0 && ok;
+}
+
+bool SoftRenderer::WritePNG(const std::string& path) const {
+    // Scanlines with filter type 0, wrapped in stored deflate blocks
+    std::vector<unsigned char> rgb;
+    PackRGB(rgb);
+    size_t stride = (size_t)width * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * stride, rgb.begin() + (y + 1) * stride);
+    }
+
+    std::vector<unsigned char> zlib = {0x78, 0x01};
+    uint32_t adlerA = 1, adlerB = 0;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; ) {
+        size_t block = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + block == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((unsigned char)block);
+        zlib.push_back((unsigned char)(block >> 8));
+        zlib.push_back((unsigned char)~block);
+        zlib.push_back((unsigned char)(~block >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+        for (size_t i = offset; i < offset + block; i++) {
+            adlerA = (adlerA + raw[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        offset += block;
+        if (last) break;
+    }
+    PutBigEndian(zlib, (adlerB << 16) | adlerA);
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)width);
+    PutBigEndian(header, (uint32_t)height);
+    header.push_back(8);  // Bit depth
+    header.push_back(2);  // Truecolor
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+
+    std::vector<unsigned char> file = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    PutChunk(file, "IHDR", header);
+    PutChunk(file, "IDAT", zlib);
+    PutChunk(file, "IEND", std::vector<unsigned char>());
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    bool ok = fwrite(file.data(), 1, file.size(), out) == file.size();
+    return fclose(out) == 0 && ok;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TaskScheduler.h"
+
+// Screen-space geometry of a frame, in the order the GDI path paints it.
+// Colors are 0x00RRGGBB. Coordinates stay as floats and are truncated to
+// whole pixels by the rasterizer, like the LONG casts in Cloth::Draw.
+struct DrawPrimitive {
+    enum Type : uint8_t { TRIANGLE, LINE, DOT };
+    Type type;
+    uint32_t color;
+    float x[3], y[3];  // Lines use two corners, dots one
+};
+
+struct DrawList {
+    std::vector<DrawPrimitive> primitives;
+
+    void Clear() { primitives.clear(); }
+    // Filled with color and outlined by the 1 px black default pen, like Polygon
+    void AddTriangle(float ax, float ay, float bx, float by, float cx, float cy, uint32_t color);
+    void AddLine(float ax, float ay, float bx, float by, uint32_t color);  // 2 px pen
+    void AddDot(float x, float y, uint32_t color);  // Ellipse of radius 3 with a black outline
+};
+
+// CPU rasterizer for headless rendering. Primitives are binned into screen
+// tiles by their bounds; each tile then clears and paints its own pixels in
+// list order, so tiles run in parallel without locks and overlaps resolve
+// exactly as the painter's order of Cloth::Draw.
+class SoftRenderer {
+public:
+    static const int TILE_SIZE = 32;  // Pixels per tile side, as in DirtyTileMap
+    static constexpr uint32_t BACKGROUND = 0xFFFFFF;  // COLOR_WINDOW
+
+    SoftRenderer(int width, int height);
+
+    void SetScheduler(TaskScheduler* pool) { scheduler = pool; }  // Null renders inline
+    void Render(const DrawList& list);
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    const std::vector<uint32_t>& GetPixels() const { return pixels; }  // Row-major 0x00RRGGBB
+
+    bool WritePPM(const std::string& path) const;
+    bool WritePNG(const std::string& path) const;  // Stored (uncompressed) deflate, no dependencies
+    bool WriteRaw(FILE* out) const;  // One rgb24 frame of a raw video stream
+
+private:
+    int width, height;
+    int tilesX, tilesY;
+    std::vector<uint32_t> pixels;
+    std::vector<int> binStart;    // Per tile: first entry in binItems, plus one past the end
+    std::vector<int> binItems;    // Primitive indices grouped by tile, in list order
+    std::vector<int> binCursor;
+    std::vector<int> bounds;      // Per primitive: tile range x0, y0, x1, y1 (inclusive), x0 > x1 if off screen
+    TaskScheduler* scheduler;
+    PhaseTuning tuning;
+
+    void Bin(const DrawList& list);
+    void RasterizeTile(const DrawList& list, int tile);
+    void PackRGB(std::vector<unsigned char>& rgb) const;
+};
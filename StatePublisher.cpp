@@ -0,0 +1,220 @@
+#include "StatePublisher.h"
+#include "Cloth.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SharedState {
+
+namespace {
+
+size_t AlignUp(size_t bytes) {
+    return (bytes + 63) & ~(size_t)63;
+}
+
+} // namespace
+
+Layout ComputeLayout(uint32_t pointCapacity, uint32_t springCapacity, uint32_t faceCapacity) {
+    Layout layout;
+    layout.slotsOffset = AlignUp(sizeof(Header));
+    layout.positionsOffset = AlignUp(sizeof(SlotHeader));
+    layout.brokenOffset = layout.positionsOffset + AlignUp(sizeof(float) * 2 * pointCapacity);
+    layout.stretchOffset = layout.brokenOffset + AlignUp(sizeof(uint32_t) * ((springCapacity + 31) / 32));
+    layout.slotBytes = layout.stretchOffset + AlignUp(sizeof(float) * faceCapacity);
+    layout.totalBytes = layout.slotsOffset + layout.slotBytes * SLOT_COUNT;
+    return layout;
+}
+
+} // namespace SharedState
+
+using namespace SharedState;
+
+StatePublisher::StatePublisher() : header(nullptr), layout(), mappedBytes(0), frameCount(0) {}
+
+StatePublisher::~StatePublisher() {
+    Close();
+}
+
+bool StatePublisher::Open(const Cloth& cloth, const std::string& segmentName) {
+    Close();
+    if (cloth.IsCompact()) return false;
+
+    uint32_t pointCapacity = (uint32_t)cloth.GetPointCapacity();
+    uint32_t springCapacity = (uint32_t)cloth.GetSprings().size();
+    uint32_t faceCapacity = (uint32_t)cloth.GetFaces().size();
+    Layout newLayout = ComputeLayout(pointCapacity, springCapacity, faceCapacity);
+
+    // Start from a fresh segment; readers still mapping a stale one keep it until they reopen
+    shm_unlink(segmentName.c_str());
+    int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)newLayout.totalBytes) != 0) {
+        close(fd);
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, newLayout.totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every slot sequence starts even and empty
+    name = segmentName;
+    layout = newLayout;
+    mappedBytes = newLayout.totalBytes;
+    frameCount = 0;
+    header = new (memory) Header();
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->slotCount = SLOT_COUNT;
+    header->pointCapacity = pointCapacity;
+    header->springCapacity = springCapacity;
+    header->faceCapacity = faceCapacity;
+    header->slotBytes = newLayout.slotBytes;
+    header->latestFrame.store(0, std::memory_order_release);
+    for (int i = 0; i < SLOT_COUNT; i++) new (Slot(i)) SlotHeader();
+    return true;
+}
+
+void StatePublisher::Close() {
+    if (!header) return;
+    munmap(header, mappedBytes);
+    shm_unlink(name.c_str());
+    header = nullptr;
+    mappedBytes = 0;
+}
+
+unsigned char* StatePublisher::Slot(int index) const {
+    return reinterpret_cast<unsigned char*>(header) + layout.slotsOffset + layout.slotBytes * index;
+}
+
+bool StatePublisher::Publish(const Cloth& cloth) {
+    if (!header || cloth.IsCompact()) return false;
+    const std::vector<PointMass>& points = cloth.GetPoints();
+    const std::vector<Spring>& springs = cloth.GetSprings();
+    const std::vector<Face>& faces = cloth.GetFaces();
+    if (points.size() > header->pointCapacity || springs.size() > header->springCapacity ||
+        faces.size() > header->faceCapacity) {
+        return false;
+    }
+
+    unsigned char* slot = Slot((int)(frameCount % SLOT_COUNT));
+    SlotHeader* slotHeader = reinterpret_cast<SlotHeader*>(slot);
+
+    // Odd sequence tells readers the slot is mid-write
+    uint32_t sequence = slotHeader->sequence.load(std::memory_order_relaxed);
+    slotHeader->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slotHeader->pointCount = (uint32_t)points.size();
+    slotHeader->springCount = (uint32_t)springs.size();
+    slotHeader->faceCount = (uint32_t)faces.size();
+    slotHeader->frame = frameCount;
+
+    float* positions = reinterpret_cast<float*>(slot + layout.positionsOffset);
+    for (size_t i = 0; i < points.size(); i++) {
+        positions[i * 2] = points[i].x;
+        positions[i * 2 + 1] = points[i].y;
+    }
+
+    uint32_t* brokenBits = reinterpret_cast<uint32_t*>(slot + layout.brokenOffset);
+    for (size_t word = 0; word * 32 < springs.size(); word++) {
+        uint32_t bits = 0;
+        size_t end = std::min(springs.size(), word * 32 + 32);
+        for (size_t s = word * 32; s < end; s++) {
+            bits |= (uint32_t)springs[s].broken << (s & 31);
+        }
+        brokenBits[word] = bits;
+    }
+
+    float* faceStretch = reinterpret_cast<float*>(slot + layout.stretchOffset);
+    for (size_t f = 0; f < faces.size(); f++) {
+        faceStretch[f] = cloth.GetFaceStretch(faces[f]);
+    }
+
+    slotHeader->sequence.store(sequence + 2, std::memory_order_release);
+    frameCount++;
+    header->latestFrame.store(frameCount, std::memory_order_release);
+    return true;
+}
+
+StateReader::StateReader() : header(nullptr), layout(), mappedBytes(0), retries(0) {}
+
+StateReader::~StateReader() {
+    Close();
+}
+
+bool StateReader::Open(const std::string& segmentName) {
+    Close();
+
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    size_t bytes = (size_t)info.st_size;
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return false;
+
+    // Reject segments from another writer version or with a truncated body
+    const Header* candidate = static_cast<const Header*>(memory);
+    Layout expected = ComputeLayout(candidate->pointCapacity, candidate->springCapacity,
+                                    candidate->faceCapacity);
+    if (candidate->magic != MAGIC || candidate->version != VERSION ||
+        candidate->slotCount != (uint32_t)SLOT_COUNT || candidate->slotBytes != expected.slotBytes ||
+        bytes < expected.totalBytes) {
+        munmap(memory, bytes);
+        return false;
+    }
+
+    header = candidate;
+    layout = expected;
+    mappedBytes = bytes;
+    retries = 0;
+    return true;
+}
+
+void StateReader::Close() {
+    if (!header) return;
+    munmap(const_cast<Header*>(header), mappedBytes);
+    header = nullptr;
+    mappedBytes = 0;
+}
+
+uint64_t StateReader::GetLatestFrame() const {
+    return header ? header->latestFrame.load(std::memory_order_acquire) : 0;
+}
+
+bool StateReader::BeginRead(int slotIndex, FrameView& view, uint32_t& sequence) const {
+    const unsigned char* slot = reinterpret_cast<const unsigned char*>(header) + layout.slotsOffset +
+                                layout.slotBytes * slotIndex;
+    const SlotHeader* slotHeader = reinterpret_cast<const SlotHeader*>(slot);
+    sequence = slotHeader->sequence.load(std::memory_order_acquire);
+    if (sequence & 1u) return false;
+
+    // Counts may be torn too; clamping keeps a bad attempt inside the mapping
+    view.frame = slotHeader->frame;
+    view.pointCount = std::min(slotHeader->pointCount, header->pointCapacity);
+    view.springCount = std::min(slotHeader->springCount, header->springCapacity);
+    view.faceCount = std::min(slotHeader->faceCount, header->faceCapacity);
+    view.positions = reinterpret_cast<const float*>(slot + layout.positionsOffset);
+    view.brokenBits = reinterpret_cast<const uint32_t*>(slot + layout.brokenOffset);
+    view.faceStretch = reinterpret_cast<const float*>(slot + layout.stretchOffset);
+    return true;
+}
+
+bool StateReader::EndRead(int slotIndex, uint32_t sequence) const {
+    const unsigned char* slot = reinterpret_cast<const unsigned char*>(header) + layout.slotsOffset +
+                                layout.slotBytes * slotIndex;
+    const SlotHeader* slotHeader = reinterpret_cast<const SlotHeader*>(slot);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotHeader->sequence.load(std::memory_order_relaxed) == sequence;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Cloth;
+
+// Shared-memory layout of the published simulation state. A small header is
+// followed by SLOT_COUNT frame slots; frame n goes to slot n % SLOT_COUNT so
+// readers of the latest frame are never overwritten by the very next step.
+// Each slot carries a seqlock sequence that is odd while the writer is inside
+// it. Readers look at the arrays in place and re-check the sequence afterwards
+// instead of copying or taking a lock, so any number of them can follow along
+// without slowing the simulation down.
+namespace SharedState {
+
+const uint32_t MAGIC = 0x434C5354;  // "CLST"
+const uint32_t VERSION = 1;
+const int SLOT_COUNT = 4;
+const char* const DEFAULT_NAME = "/cloth_state";
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t pointCapacity;
+    uint32_t springCapacity;
+    uint32_t faceCapacity;
+    uint64_t slotBytes;
+    std::atomic<uint64_t> latestFrame;  // Frames published so far; newest is latestFrame - 1
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint32_t> sequence;  // Odd while being written
+    uint32_t pointCount;
+    uint32_t springCount;
+    uint32_t faceCount;
+    uint64_t frame;
+};
+
+// Slot payload, each array padded to 64 bytes:
+//   float    positions[2 * pointCapacity]      x, y interleaved
+//   uint32_t brokenBits[(springCapacity + 31) / 32]
+//   float    faceStretch[faceCapacity]         area over rest area
+struct Layout {
+    size_t slotsOffset;      // From the start of the segment
+    size_t positionsOffset;  // The rest from the start of a slot
+    size_t brokenOffset;
+    size_t stretchOffset;
+    size_t slotBytes;
+    size_t totalBytes;
+};
+
+Layout ComputeLayout(uint32_t pointCapacity, uint32_t springCapacity, uint32_t faceCapacity);
+
+// Pointers into one slot; counts are clamped to the capacities, contents are
+// only trustworthy once ReadLatest has validated the sequence
+struct FrameView {
+    uint64_t frame;
+    uint32_t pointCount;
+    uint32_t springCount;
+    uint32_t faceCount;
+    const float* positions;
+    const uint32_t* brokenBits;
+    const float* faceStretch;
+    bool IsBroken(uint32_t spring) const { return (brokenBits[spring >> 5] >> (spring & 31)) & 1u; }
+};
+
+} // namespace SharedState
+
+// Writer side, owned by the simulation process. Creates the segment on Open
+// and removes it again on Close.
+class StatePublisher {
+public:
+    StatePublisher();
+    ~StatePublisher();
+
+    // Capacities are taken from the cloth; a later Publish with more elements
+    // fails, and so do both for a parked cloth
+    bool Open(const Cloth& cloth, const std::string& name = SharedState::DEFAULT_NAME);
+    void Close();
+    bool IsOpen() const { return header != nullptr; }
+
+    bool Publish(const Cloth& cloth);
+    uint64_t GetFrameCount() const { return frameCount; }
+
+private:
+    std::string name;
+    SharedState::Header* header;
+    SharedState::Layout layout;
+    size_t mappedBytes;
+    uint64_t frameCount;
+
+    unsigned char* Slot(int index) const;
+};
+
+// Reader side. Maps the segment read-only; never writes to it.
+class StateReader {
+public:
+    StateReader();
+    ~StateReader();
+
+    bool Open(const std::string& name = SharedState::DEFAULT_NAME);
+    void Close();
+    bool IsOpen() const { return header != nullptr; }
+
+    uint64_t GetLatestFrame() const;  // Frames published so far
+    uint32_t GetPointCapacity() const { return header->pointCapacity; }
+
+    // Runs visit(view) on the newest frame and retries while the writer
+    // overwrote it underneath. visit must tolerate garbage values on a torn
+    // attempt and only commit its result once ReadLatest returns true.
+    // Returns false if no frame has been published or every attempt tore.
+    template <typename Visit>
+    bool ReadLatest(const Visit& visit, int maxAttempts = 8) {
+        for (int attempt = 0; attempt < maxAttempts; attempt++) {
+            uint64_t published = header->latestFrame.load(std::memory_order_acquire);
+            if (published == 0) return false;
+            int slot = (int)((published - 1) % header->slotCount);
+
+            SharedState::FrameView view;
+            uint32_t sequence;
+            if (!BeginRead(slot, view, sequence)) {
+                retries++;
+                continue;
+            }
+            visit(view);
+            if (EndRead(slot, sequence)) return true;
+            retries++;
+        }
+        return false;
+    }
+    uint64_t GetRetryCount() const { return retries; }
+
+private:
+    const SharedState::Header* header;
+    SharedState::Layout layout;
+    size_t mappedBytes;
+    uint64_t retries;
+
+    bool BeginRead(int slot, SharedState::FrameView& view, uint32_t& sequence) const;
+    bool EndRead(int slot, uint32_t sequence) const;
+};
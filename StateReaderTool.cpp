@@ -0,0 +1,137 @@
+// Test client for the shared-memory state segment. By default it follows a
+// running publisher and prints a summary of the newest frame a few times a
+// second, read in place without copying. With --publish it instead runs a
+// headless cloth and publishes every step, so the two halves can be tried
+// against each other from two terminals.
+//
+// Usage: ClothStateReader [--name /segment] [--seconds N]
+//        ClothStateReader --publish [--name /segment] [--seconds N] [--resolution N]
+#include "Cloth.h"
+#include "StatePublisher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+const float FIXED_TIME_STEP = 1.0f / 60.0f;
+
+struct FrameSummary {
+    uint64_t frame;
+    uint32_t points;
+    uint32_t broken;
+    float minX, minY, maxX, maxY;
+    float meanStretch;
+};
+
+int RunPublisher(const std::string& name, double seconds, int resolution) {
+    Cloth cloth(resolution, resolution, Cloth::GRID_EXTENT / resolution);
+    cloth.FixPoint(0, 0);
+    cloth.FixPoint(resolution - 1, 0);
+    cloth.SetMaxStretch(1.6f);
+
+    StatePublisher publisher;
+    if (!publisher.Open(cloth, name)) {
+        fprintf(stderr, "Could not create shared memory segment %s\n", name.c_str());
+        return 1;
+    }
+    printf("Publishing %dx%d cloth to %s\n", resolution, resolution, name.c_str());
+
+    // Real-time pacing so a reader sees the cloth fall and tear
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+        cloth.Update(FIXED_TIME_STEP);
+        if (!publisher.Publish(cloth)) {
+            fprintf(stderr, "Cloth outgrew the segment capacity\n");
+            return 1;
+        }
+        next += std::chrono::microseconds(16667);
+        std::this_thread::sleep_until(next);
+    }
+    printf("Published %llu frames\n", (unsigned long long)publisher.GetFrameCount());
+    return 0;
+}
+
+int RunReader(const std::string& name, double seconds) {
+    StateReader reader;
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    while (!reader.Open(name)) {
+        if (elapsed() >= seconds) {
+            fprintf(stderr, "No shared memory segment %s\n", name.c_str());
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    uint64_t lastFrame = 0;
+    int reads = 0;
+    while (elapsed() < seconds) {
+        FrameSummary summary;
+        bool ok = reader.ReadLatest([&summary](const SharedState::FrameView& view) {
+            summary.frame = view.frame;
+            summary.points = view.pointCount;
+            summary.broken = 0;
+            for (uint32_t s = 0; s < view.springCount; s++) summary.broken += view.IsBroken(s);
+
+            summary.minX = summary.minY = 1e30f;
+            summary.maxX = summary.maxY = -1e30f;
+            for (uint32_t i = 0; i < view.pointCount; i++) {
+                float x = view.positions[i * 2];
+                float y = view.positions[i * 2 + 1];
+                summary.minX = x < summary.minX ? x : summary.minX;
+                summary.minY = y < summary.minY ? y : summary.minY;
+                summary.maxX = x > summary.maxX ? x : summary.maxX;
+                summary.maxY = y > summary.maxY ? y : summary.maxY;
+            }
+
+            float total = 0.0f;
+            for (uint32_t f = 0; f < view.faceCount; f++) total += view.faceStretch[f];
+            summary.meanStretch = view.faceCount ? total / view.faceCount : 0.0f;
+        });
+
+        if (ok && summary.frame + 1 != lastFrame) {
+            printf("frame %6llu  points %6u  broken %5u  bounds (%6.1f,%6.1f)-(%6.1f,%6.1f)  stretch %.3f\n",
+                   (unsigned long long)summary.frame, summary.points, summary.broken, summary.minX,
+                   summary.minY, summary.maxX, summary.maxY, summary.meanStretch);
+            lastFrame = summary.frame + 1;
+            reads++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+    printf("%d frames read, %llu torn reads retried\n", reads, (unsigned long long)reader.GetRetryCount());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string name = SharedState::DEFAULT_NAME;
+    double seconds = 10.0;
+    int resolution = 40;
+    bool publish = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--publish") == 0) {
+            publish = true;
+        } else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            resolution = std::max(2, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "Usage: %s [--publish] [--name /segment] [--seconds N] [--resolution N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    return publish ? RunPublisher(name, seconds, resolution) : RunReader(name, seconds);
+}
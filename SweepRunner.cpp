@@ -0,0 +1,236 @@
+// Headless parameter sweep: simulates every combination of a sweep spec
+// across all cores and writes per-run metrics to CSV.
+//
+// Spec file format, one parameter per line ('#' starts a comment):
+//   gravity     0.3 0.7 0.2    # min max step (normalized like the GUI sliders)
+//   stiffness   0.5            # single value
+//   damping     0.4 0.6 0.1
+//   resolution  15 30 5        # points per side
+//   maxStretch  1.5 3.0 0.5    # stretch ratio before a spring may break; when
+//                              # omitted the cloth keeps its own thresholds
+//   steps       600            # fixed steps per run (1/60 s each)
+//
+// Usage: ClothSweep <spec> [output.csv] [--threads N]
+#include "Cloth.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct SweepRange {
+    float min, max, step;
+};
+
+struct RunConfig {
+    float gravity;
+    float stiffness;
+    float damping;
+    int resolution;
+    float maxStretch;  // 0 keeps the cloth's per-spring thresholds
+};
+
+struct RunMetrics {
+    double stepsPerSecond;  // Update calls only, metrics excluded
+    float firstTearTime;   // Simulated seconds, -1 if nothing tore
+    int springsBroken;
+    float maxStrain;
+    float energyDrift;     // Change of total energy over the start's elastic energy plus gravity's work
+};
+
+const float FIXED_TIME_STEP = 1.0f / 60.0f;
+
+std::vector<float> Expand(const SweepRange& range) {
+    std::vector<float> values;
+    if (range.step <= 0.0f) {
+        values.push_back(range.min);
+        return values;
+    }
+    // Small epsilon so "0.3 0.7 0.2" includes 0.7 despite rounding
+    for (float v = range.min; v <= range.max + range.step * 1e-3f; v += range.step) {
+        values.push_back(v);
+    }
+    return values;
+}
+
+bool ParseSpec(const char* path, std::map<std::string, SweepRange>& ranges, int& steps) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string name;
+        if (!(in >> name)) continue;
+
+        if (name == "steps") {
+            if (!(in >> steps) || steps <= 0) {
+                fprintf(stderr, "steps must be a positive count\n");
+                return false;
+            }
+            continue;
+        }
+
+        SweepRange range = {0.0f, 0.0f, 0.0f};
+        if (!(in >> range.min)) return false;
+        if (in >> range.max >> range.step) {
+            if (range.max < range.min) return false;
+        } else {
+            range.max = range.min;
+            range.step = 0.0f;
+        }
+
+        if (!ranges.count(name)) {
+            fprintf(stderr, "Unknown sweep parameter: %s\n", name.c_str());
+            return false;
+        }
+        ranges[name] = range;
+    }
+    return true;
+}
+
+// Gravitational potential of the free points relative to each point's start
+// height, so it does not depend on where the cloth hangs on screen. Points
+// split off by tearing start where they first appear.
+double GravityPotential(const Cloth& cloth, std::vector<float>& startY) {
+    const std::vector<PointMass>& points = cloth.GetPoints();
+    for (size_t i = startY.size(); i < points.size(); i++) startY.push_back(points[i].y);
+
+    double potential = 0.0;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (!points[i].isFixed) potential -= (double)points[i].mass * (points[i].y - startY[i]);
+    }
+    return potential * cloth.GetGravityForce();
+}
+
+RunMetrics Simulate(const RunConfig& config, int steps) {
+    Cloth* cloth = Cloth::CreateWithResolution(config.resolution);
+    cloth->SetScheduler(nullptr); // Runs are already spread across cores
+    cloth->SetGravity(config.gravity);
+    cloth->SetStiffness(config.stiffness);
+    cloth->SetDamping(config.damping);
+    if (config.maxStretch > 0.0f) cloth->SetMaxStretch(config.maxStretch);
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(config.resolution - 1, 0);
+
+    RunMetrics metrics = {0.0, -1.0f, 0, 0.0f, 0.0f};
+    std::vector<float> startY;
+    GravityPotential(*cloth, startY);
+    double startEnergy = cloth->GetElasticEnergy();
+
+    // Only the steps are timed; the metric sweeps below are O(n) each and
+    // would otherwise count against the solver's throughput
+    std::chrono::steady_clock::duration simulated(0);
+    for (int step = 0; step < steps; step++) {
+        auto start = std::chrono::steady_clock::now();
+        cloth->Update(FIXED_TIME_STEP);
+        simulated += std::chrono::steady_clock::now() - start;
+        GravityPotential(*cloth, startY);  // Picks up points split off this step
+
+        metrics.maxStrain = std::max(metrics.maxStrain, cloth->GetMaxStrain());
+        if (metrics.firstTearTime < 0.0f && cloth->GetBrokenSpringCount() > 0) {
+            metrics.firstTearTime = (step + 1) * FIXED_TIME_STEP;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(simulated).count();
+    metrics.stepsPerSecond = seconds > 0.0 ? steps / seconds : 0.0;
+    metrics.springsBroken = cloth->GetBrokenSpringCount();
+    double gravityWork = -GravityPotential(*cloth, startY);
+    double endEnergy = cloth->GetElasticEnergy() - gravityWork;
+    metrics.energyDrift = (float)((endEnergy - startEnergy) / std::max(1.0, std::fabs(startEnergy) + std::fabs(gravityWork)));
+
+    delete cloth;
+    return metrics;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <spec> [output.csv] [--threads N]\n", argv[0]);
+        return 1;
+    }
+
+    const char* specPath = argv[1];
+    const char* outputPath = "sweep.csv";
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::max(1, atoi(argv[++i]));
+        } else {
+            outputPath = argv[i];
+        }
+    }
+
+    // Defaults match MEDIUM_PRESET, which leaves the break thresholds alone
+    std::map<std::string, SweepRange> ranges = {
+        {"gravity", {0.5f, 0.5f, 0.0f}},
+        {"stiffness", {0.5f, 0.5f, 0.0f}},
+        {"damping", {0.5f, 0.5f, 0.0f}},
+        {"resolution", {20.0f, 20.0f, 0.0f}},
+        {"maxStretch", {0.0f, 0.0f, 0.0f}},
+    };
+    int steps = 600;
+    if (!ParseSpec(specPath, ranges, steps)) {
+        fprintf(stderr, "Failed to read sweep spec: %s\n", specPath);
+        return 1;
+    }
+
+    // Cartesian product of all ranges
+    std::vector<RunConfig> runs;
+    for (float g : Expand(ranges["gravity"]))
+        for (float s : Expand(ranges["stiffness"]))
+            for (float d : Expand(ranges["damping"]))
+                for (float r : Expand(ranges["resolution"]))
+                    for (float m : Expand(ranges["maxStretch"]))
+                        runs.push_back({g, s, d, std::max(2, (int)(r + 0.5f)), m});
+
+    std::vector<RunMetrics> results(runs.size());
+    std::atomic<size_t> nextRun(0);
+    std::vector<std::thread> workers;
+    threadCount = std::min<unsigned>(threadCount, (unsigned)runs.size());
+
+    printf("Running %zu configurations on %u threads\n", runs.size(), threadCount);
+    for (unsigned t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            for (size_t i = nextRun++; i < runs.size(); i = nextRun++) {
+                results[i] = Simulate(runs[i], steps);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    FILE* out = fopen(outputPath, "w");
+    if (!out) {
+        fprintf(stderr, "Failed to open %s\n", outputPath);
+        return 1;
+    }
+    fprintf(out, "gravity,stiffness,damping,resolution,maxStretch,steps_per_sec,first_tear_s,springs_broken,max_strain,energy_drift\n");
+    for (size_t i = 0; i < runs.size(); i++) {
+        const RunConfig& c = runs[i];
+        const RunMetrics& m = results[i];
+        // An empty maxStretch column means the cloth's own thresholds
+        char maxStretch[32] = "";
+        if (c.maxStretch > 0.0f) snprintf(maxStretch, sizeof(maxStretch), "%.3f", c.maxStretch);
+        fprintf(out, "%.3f,%.3f,%.3f,%d,%s,%.1f,%.3f,%d,%.4f,%.5f\n",
+                c.gravity, c.stiffness, c.damping, c.resolution, maxStretch,
+                m.stepsPerSecond, m.firstTearTime, m.springsBroken, m.maxStrain, m.energyDrift);
+    }
+    fclose(out);
+
+    printf("Wrote %s\n", outputPath);
+    return 0;
+}
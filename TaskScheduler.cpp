@@ -0,0 +1,153 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+namespace {
+
+const double TUNING_BLEND = 0.2;   // Weight of the newest measurement
+const int PROBE_INTERVAL = 64;     // Re-measure the other mode every N calls
+const int WORKER_SPIN = 256;       // Yields before a worker goes to sleep
+
+double Blend(double current, double sample) {
+    return current == 0.0 ? sample : current + (sample - current) * TUNING_BLEND;
+}
+
+} // namespace
+
+thread_local int TaskScheduler::dispatchDepth = 0;
+
+double ElapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ShouldRunParallel(const PhaseTuning& tuning, int count, int threadCount) {
+    if (threadCount <= 1) return false;
+
+    // Warm up: measure the serial cost first, then the dispatch overhead
+    if (tuning.calls == 0) return false;
+    if (tuning.calls == 1) return true;
+
+    double serialNs = count * tuning.itemNs;
+    double parallelNs = tuning.overheadNs + serialNs / threadCount;
+    bool parallel = parallelNs < serialNs;
+
+    // Occasionally take the other path so both estimates stay current
+    if (tuning.calls % PROBE_INTERVAL == PROBE_INTERVAL - 1) parallel = !parallel;
+    return parallel;
+}
+
+void RecordPhase(PhaseTuning& tuning, int count, int threadCount, bool parallel, double ns) {
+    if (parallel) {
+        double overhead = std::max(0.0, ns - count * tuning.itemNs / threadCount);
+        tuning.overheadNs = Blend(tuning.overheadNs, overhead);
+    } else {
+        tuning.itemNs = Blend(tuning.itemNs, ns / count);
+    }
+    tuning.calls++;
+}
+
+TaskScheduler::TaskScheduler(int threadCount)
+    : generation(0), activeWorkers(0), pendingChunks(0), stopping(false),
+      function(nullptr), body(nullptr), itemCount(0), chunkSize(1) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ranges.reset(new ChunkRange[threadCount]);
+    for (int i = 0; i < threadCount; i++) {
+        ranges[i].next = 0;
+        ranges[i].end = 0;
+    }
+
+    for (int i = 0; i < threadCount - 1; i++) {
+        workers.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::Default() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+void TaskScheduler::WorkerLoop(int index) {
+    unsigned seen = 0;
+    while (true) {
+        // Phases of one step arrive back to back, so spin briefly before sleeping
+        for (int spin = 0; spin < WORKER_SPIN && generation.load(std::memory_order_acquire) == seen; spin++) {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation.load() != seen; });
+            if (stopping) return;
+            seen = generation.load();
+            activeWorkers++;
+        }
+
+        RunChunks(index);
+        activeWorkers--;
+    }
+}
+
+void TaskScheduler::RunChunks(int participant) {
+    int participants = GetThreadCount();
+    dispatchDepth++;
+
+    // Own range first, then steal from the others in turn
+    for (int k = 0; k < participants; k++) {
+        ChunkRange& range = ranges[(participant + k) % participants];
+        while (true) {
+            int chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= range.end) break;
+
+            int begin = chunk * chunkSize;
+            int end = std::min(begin + chunkSize, itemCount);
+            function(body, begin, end);
+            pendingChunks.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    dispatchDepth--;
+}
+
+void TaskScheduler::Dispatch(int count, int chunk, ChunkFunction fn, const void* data) {
+    int chunkCount = (count + chunk - 1) / chunk;
+    int participants = GetThreadCount();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // A worker that woke late for the previous loop may still be scanning its ranges
+        while (activeWorkers.load() != 0) {
+            std::this_thread::yield();
+        }
+
+        function = fn;
+        body = data;
+        itemCount = count;
+        chunkSize = chunk;
+        for (int p = 0; p < participants; p++) {
+            ranges[p].next = (int)((long long)chunkCount * p / participants);
+            ranges[p].end = (int)((long long)chunkCount * (p + 1) / participants);
+        }
+        pendingChunks = chunkCount;
+        generation++;
+    }
+    wake.notify_all();
+
+    // The calling thread takes the last share, then waits at the barrier
+    RunChunks(participants - 1);
+    while (pendingChunks.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Per-phase cost model that decides between inline and parallel execution.
+// Both costs are measured while running, so the crossover adapts to the
+// machine and to how heavy each phase is.
+struct PhaseTuning {
+    double itemNs = 0.0;      // Serial cost per item
+    double overheadNs = 0.0;  // Fixed cost of a parallel dispatch
+    int calls = 0;
+};
+
+// Persistent worker pool running data-parallel loops split into chunks.
+// Each participant starts on its own contiguous run of chunks and steals
+// from the others when it runs dry. ParallelFor returns only once every
+// chunk has finished, so consecutive calls act as phase barriers.
+class TaskScheduler {
+private:
+    typedef void (*ChunkFunction)(const void* body, int begin, int end);
+
+    struct alignas(64) ChunkRange {
+        std::atomic<int> next;
+        int end;
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<ChunkRange[]> ranges; // One per participant, caller last
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::mutex dispatchMutex;          // Held by the thread currently dispatching
+    std::atomic<unsigned> generation;
+    std::atomic<int> activeWorkers;
+    std::atomic<int> pendingChunks;
+    bool stopping;
+
+    // Current job
+    ChunkFunction function;
+    const void* body;
+    int itemCount;
+    int chunkSize;
+
+    // Nonzero while this thread is running chunks of some pool's loop
+    static thread_local int dispatchDepth;
+
+    void WorkerLoop(int index);
+    void RunChunks(int participant);
+    void Dispatch(int count, int chunk, ChunkFunction fn, const void* data);
+
+    template <typename Body>
+    static void Invoke(const void* body, int begin, int end) {
+        (*static_cast<const Body*>(body))(begin, end);
+    }
+
+public:
+    explicit TaskScheduler(int threadCount = 0);  // 0 = one per hardware thread
+    ~TaskScheduler();
+
+    int GetThreadCount() const { return (int)workers.size() + 1; }
+
+    // Run body(begin, end) over [0, count) in chunks of chunkSize items.
+    // Small loops, loops issued while another thread owns the pool, and
+    // loops nested inside a chunk body run inline on the calling thread.
+    template <typename Body>
+    void ParallelFor(int count, int chunk, PhaseTuning& tuning, const Body& body);
+
+    static TaskScheduler& Default();
+};
+
+double ElapsedNs(std::chrono::steady_clock::time_point start);
+bool ShouldRunParallel(const PhaseTuning& tuning, int count, int threadCount);
+void RecordPhase(PhaseTuning& tuning, int count, int threadCount, bool parallel, double ns);
+
+template <typename Body>
+void TaskScheduler::ParallelFor(int count, int chunk, PhaseTuning& tuning, const Body& body) {
+    if (count <= 0) return;
+    if (dispatchDepth > 0) {
+        body(0, count);  // Nested: the pool is already busy with the outer loop
+        return;
+    }
+
+    int threads = GetThreadCount();
+    bool parallel = count > chunk && ShouldRunParallel(tuning, count, threads);
+    std::unique_lock<std::mutex> lock(dispatchMutex, std::defer_lock);
+    if (parallel && !lock.try_lock()) {
+        parallel = false;  // Another cloth owns the pool right now
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (parallel) {
+        Dispatch(count, chunk, &Invoke<Body>, &body);
+    } else {
+        body(0, count);
+    }
+    RecordPhase(tuning, count, threads, parallel, ElapsedNs(start));
+}
@@ -0,0 +1,51 @@
+// Headless checks for tearing: a cloth stretched past its break ratio splits
+// vertices, the copies share the original mass so the cloth weighs the same,
+// and Reset restores the original points and masses. Prints each failed
+// check; the exit code is non-zero if any failed.
+//
+// Usage: ClothTearingTest
+#include "Cloth.h"
+#include "TestHarness.h"
+#include <cmath>
+#include <memory>
+
+namespace {
+
+const int RESOLUTION = 16;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+double TotalMass(const Cloth& cloth) {
+    double mass = 0.0;
+    for (const auto& point : cloth.GetPoints()) mass += point.mass;
+    return mass;
+}
+
+void TestSplitMass() {
+    std::unique_ptr<Cloth> cloth(Cloth::CreateWithResolution(RESOLUTION));
+    cloth->SetScheduler(nullptr);
+    cloth->FixPoint(0, 0);
+    cloth->FixPoint(RESOLUTION - 1, 0);
+    cloth->SetMaxStretch(1.3f);  // Tears under its own weight
+    double startMass = TotalMass(*cloth);
+    for (int frame = 0; frame < 300; frame++) cloth->Update(FRAME_TIME);
+
+    int count = (int)cloth->GetPoints().size();
+    Check(cloth->GetBrokenSpringCount() > 0 && count > RESOLUTION * RESOLUTION, "the cloth tears and splits vertices");
+    Check(std::fabs(TotalMass(*cloth) - startMass) < 1e-3 * startMass, "splitting keeps the total mass");
+    bool positive = true;
+    for (const auto& point : cloth->GetPoints()) positive = positive && point.mass > 0.0f;
+    Check(positive, "every split point keeps some mass");
+
+    cloth->Reset();
+    Check((int)cloth->GetPoints().size() == RESOLUTION * RESOLUTION, "Reset drops the split copies");
+    bool restored = true;
+    for (const auto& point : cloth->GetPoints()) restored = restored && point.mass == 1.0f;
+    Check(restored && cloth->GetBrokenSpringCount() == 0, "Reset restores the original masses");
+}
+
+} // namespace
+
+int main() {
+    TestSplitMass();
+    return FinishChecks("tearing");
+}
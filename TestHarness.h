@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdio>
+
+// Shared by the headless check programs run by ctest: each failed Check
+// prints what it expected, and FinishChecks turns the count into the exit
+// code.
+
+inline int& CheckFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void Check(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAILED: %s\n", what);
+        CheckFailures()++;
+    }
+}
+
+// Returns the exit code for main
+inline int FinishChecks(const char* suite) {
+    if (CheckFailures()) {
+        printf("%d checks failed\n", CheckFailures());
+        return 1;
+    }
+    printf("All %s checks passed\n", suite);
+    return 0;
+}
@@ -2,14 +2,82 @@
 #include <math.h>
 #include "Cloth.h"
 #include "GuiControls.h"
+#include "DirtyTiles.h"
+#include "QualityGovernor.h"
+#include "ClothScene.h"
 #include <cstdio>
+#include <string>
+#include <vector>
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 
-Cloth* cloth = nullptr;
+Cloth* cloth = nullptr;  // The cloth the controls act on, always scene cloth 0
+ClothScene scene;        // Extra layers added with 'L' collide with it and each other
 bool isRunning = true;
 
+// Persistent back buffer; only dirty tiles are redrawn into it each frame
+DirtyTileMap dirtyTiles;
+std::vector<DirtyTileMap::Rect> dirtyRects;
+HDC backBufferDC = NULL;
+HBITMAP backBuffer = NULL;
+HBITMAP backBufferOld = NULL;
+int backBufferWidth = 0;
+int backBufferHeight = 0;
+
+// Frame-time governor, active while Auto Quality is checked
+QualityGovernor governor;
+bool projectiveSolver = false;  // 'P' switches every cloth to the prefactored implicit solver
+bool autoQuality = false;
+
+void ReleaseBackBuffer() {
+    if (backBufferDC) {
+        SelectObject(backBufferDC, backBufferOld);
+        DeleteObject(backBuffer);
+        DeleteDC(backBufferDC);
+        backBufferDC = NULL;
+    }
+}
+
+// Gusty wind along x acting on each face, kept on every cloth the window creates
+void AddWind(Cloth* target) {
+    AeroSettings air;
+    air.enabled = true;
+    air.windX = 120.0f;
+    air.density = 6e-5f;
+    air.turbulence = 80.0f;
+    target->SetAerodynamics(air);
+}
+
+void ReplaceCloth(Cloth* next) {
+    next->SetProjective(projectiveSolver);
+    scene.Replace(0, next);
+    cloth = next;
+    dirtyTiles.MarkAll();
+}
+
+// Another cloth hung a little to the right and below the last one
+void AddLayer() {
+    int resolution = cloth->GetWidth();
+    Cloth* layer = Cloth::CreateWithResolution(resolution);
+    layer->SetGravity(0.5f);
+    layer->FixPoint(0, 0);
+    layer->FixPoint(resolution - 1, 0);
+    layer->SetOrigin(100.0f + 60.0f * scene.GetCount(), 100.0f + 30.0f * scene.GetCount());
+    layer->SetWireVisibility(cloth->GetWireVisibility());
+    AddWind(layer);
+    layer->SetProjective(projectiveSolver);
+    scene.Add(layer);
+}
+
+// Show what the governor picked in the resolution and wire controls
+void SyncQualityControls(HWND hwnd) {
+    SendMessage(GetDlgItem(hwnd, ID_RESOLUTION_SLIDER), TBM_SETPOS, TRUE, cloth->GetWidth());
+    UpdateSliderText(hwnd, ID_RESOLUTION_SLIDER, ID_RESOLUTION_TEXT);
+    CheckDlgButton(hwnd, ID_WIRE_TOGGLE, cloth->GetWireVisibility() ? BST_CHECKED : BST_UNCHECKED);
+    dirtyTiles.MarkAll();
+}
+
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
         case WM_CREATE:
@@ -20,25 +88,28 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             return 0;
 
         case WM_DESTROY:
+            ReleaseBackBuffer();
             isRunning = false;
             PostQuitMessage(0);
             return 0;
 
         case WM_LBUTTONDOWN:
-            if (cloth) {
-                cloth->HandleMouseDown(LOWORD(lParam), HIWORD(lParam));
+            // Topmost cloth under the cursor gets the drag
+            for (int i = scene.GetCount() - 1; i >= 0; i--) {
+                scene.Get(i)->HandleMouseDown(LOWORD(lParam), HIWORD(lParam));
+                if (scene.Get(i)->IsDragging()) break;
             }
             return 0;
 
         case WM_MOUSEMOVE:
-            if (cloth) {
-                cloth->HandleMouseMove(LOWORD(lParam), HIWORD(lParam));
+            for (int i = 0; i < scene.GetCount(); i++) {
+                scene.Get(i)->HandleMouseMove(LOWORD(lParam), HIWORD(lParam));
             }
             return 0;
 
         case WM_LBUTTONUP:
-            if (cloth) {
-                cloth->HandleMouseUp();
+            for (int i = 0; i < scene.GetCount(); i++) {
+                scene.Get(i)->HandleMouseUp();
             }
             return 0;
 
@@ -49,28 +120,44 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             PAINTSTRUCT ps;
             HDC hdc = BeginPaint(hwnd, &ps);
             
-            // Create memory DC for double buffering
-            HDC hdcMem = CreateCompatibleDC(hdc);
+            // (Re)create the back buffer when the client size changes
             RECT rect;
             GetClientRect(hwnd, &rect);
-            HBITMAP hbmMem = CreateCompatibleBitmap(hdc, rect.right, rect.bottom);
-            HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, hbmMem);
-            
-            // Clear the background
-            FillRect(hdcMem, &rect, (HBRUSH)(COLOR_WINDOW + 1));
-            
-            // Draw the cloth
-            if (cloth) {
-                cloth->Draw(hdcMem);
+            if (!backBufferDC || rect.right != backBufferWidth || rect.bottom != backBufferHeight) {
+                ReleaseBackBuffer();
+                backBufferDC = CreateCompatibleDC(hdc);
+                backBuffer = CreateCompatibleBitmap(hdc, rect.right, rect.bottom);
+                backBufferOld = (HBITMAP)SelectObject(backBufferDC, backBuffer);
+                backBufferWidth = rect.right;
+                backBufferHeight = rect.bottom;
+                dirtyTiles.Resize(rect.right, rect.bottom);
             }
             
-            // Copy the memory DC to the screen
-            BitBlt(hdc, 0, 0, rect.right, rect.bottom, hdcMem, 0, 0, SRCCOPY);
+            // Clear and redraw only the dirty tiles, clipped to them
+            if (!dirtyTiles.IsEmpty()) {
+                dirtyTiles.GetDirtyRects(dirtyRects);
+                HRGN clip = CreateRectRgn(0, 0, 0, 0);
+                for (const auto& dirty : dirtyRects) {
+                    RECT tile = {dirty.left, dirty.top, dirty.right, dirty.bottom};
+                    FillRect(backBufferDC, &tile, (HBRUSH)(COLOR_WINDOW + 1));
+                    HRGN tileRegion = CreateRectRgn(tile.left, tile.top, tile.right, tile.bottom);
+                    CombineRgn(clip, clip, tileRegion, RGN_OR);
+                    DeleteObject(tileRegion);
+                }
+                
+                SelectClipRgn(backBufferDC, clip);
+                for (int i = 0; i < scene.GetCount(); i++) {
+                    scene.Get(i)->Draw(backBufferDC, &dirtyTiles);
+                }
+                SelectClipRgn(backBufferDC, NULL);
+                DeleteObject(clip);
+                dirtyTiles.Clear();
+            }
             
-            // Clean up
-            SelectObject(hdcMem, hbmOld);
-            DeleteObject(hbmMem);
-            DeleteDC(hdcMem);
+            // Copy just the invalidated area to the screen
+            BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top,
+                   ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+                   backBufferDC, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY);
             
             EndPaint(hwnd, &ps);
             return 0;
@@ -97,11 +184,12 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                         UpdateSliderText(hwnd, sliderId, ID_DAMPING_TEXT);
                         break;
                     case ID_RESOLUTION_SLIDER: {
-                        delete cloth;
-                        cloth = Cloth::CreateWithResolution(pos);
+                        ReplaceCloth(Cloth::CreateWithResolution(pos));
                         cloth->FixPoint(0, 0);
                         cloth->FixPoint(pos - 1, 0);
+                        AddWind(cloth);
                         UpdateSliderText(hwnd, sliderId, ID_RESOLUTION_TEXT);
+                        governor.SetPreference(*cloth);
                         break;
                     }
                 }
@@ -112,13 +200,21 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             if (cloth) {
                 switch (tolower(wParam)) {
                     case 'r':
-                        cloth->Reset();
+                        for (int i = 0; i < scene.GetCount(); i++) scene.Get(i)->Reset();
+                        break;
+                    case 'l':
+                        AddLayer();
+                        break;
+                    case 'p':
+                        projectiveSolver = !projectiveSolver;
+                        for (int i = 0; i < scene.GetCount(); i++) scene.Get(i)->SetProjective(projectiveSolver);
                         break;
                     case 'w':
                         {
                             bool isChecked = IsDlgButtonChecked(hwnd, ID_WIRE_TOGGLE) == BST_CHECKED;
                             CheckDlgButton(hwnd, ID_WIRE_TOGGLE, isChecked ? BST_UNCHECKED : BST_CHECKED);
                             cloth->SetWireVisibility(!isChecked);
+                            governor.SetPreferredWires(!isChecked);
                         }
                         break;
                 }
@@ -137,22 +233,35 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                         else preset = &LOW_PRESET;
 
                         ApplyPreset(hwnd, *preset);
-                        delete cloth;
-                        cloth = Cloth::CreateWithResolution(preset->resolution);
+                        ReplaceCloth(Cloth::CreateWithResolution(preset->resolution));
                         cloth->SetGravity(preset->gravity);
                         cloth->SetStiffness(preset->stiffness);
                         cloth->SetDamping(preset->damping);
                         cloth->SetWireVisibility(preset->showWires);
+                        cloth->SetRenderDetail(preset->renderDetail);
                         cloth->FixPoint(0, 0);
                         cloth->FixPoint(preset->resolution - 1, 0);
+                        AddWind(cloth);
+                        governor.SetPreference(*cloth);
                         break;
                     }
                     case ID_RESET_BUTTON:
-                        cloth->Reset();
+                        for (int i = 0; i < scene.GetCount(); i++) scene.Get(i)->Reset();
                         break;
-                    case ID_WIRE_TOGGLE:
+                    case ID_WIRE_TOGGLE: {
                         bool checked = (IsDlgButtonChecked(hwnd, ID_WIRE_TOGGLE) == BST_CHECKED);
                         cloth->SetWireVisibility(checked);
+                        governor.SetPreferredWires(checked);
+                        break;
+                    }
+                    case ID_AUTO_QUALITY:
+                        autoQuality = (IsDlgButtonChecked(hwnd, ID_AUTO_QUALITY) == BST_CHECKED);
+                        if (autoQuality) {
+                            governor.SetPreference(*cloth);
+                        } else {
+                            governor.Restore(*cloth);  // Hand back what the user picked
+                            SyncQualityControls(hwnd);
+                        }
                         break;
                 }
             }
@@ -208,12 +317,23 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     ShowWindow(hwnd, nCmdShow);
     UpdateWindow(hwnd);
     
-    // Initialize the cloth
-    cloth = new Cloth(20, 20, 20.0f);
-    
-    // Fix the top corners
-    cloth->FixPoint(0, 0);
-    cloth->FixPoint(19, 0);
+    // A binary scene file on the command line replaces the default cloth
+    std::string scenePath = lpCmdLine ? lpCmdLine : "";
+    if (scenePath.size() >= 2 && scenePath.front() == '"' && scenePath.back() == '"') {
+        scenePath = scenePath.substr(1, scenePath.size() - 2);
+    }
+    if (!scenePath.empty() && scene.Load(scenePath)) {
+        cloth = scene.Get(0);
+        dirtyTiles.MarkAll();
+    } else {
+        // Initialize the cloth
+        ReplaceCloth(new Cloth(20, 20, 20.0f));
+        
+        // Fix the top corners
+        cloth->FixPoint(0, 0);
+        cloth->FixPoint(19, 0);
+        AddWind(cloth);
+    }
     
     // Main loop
     MSG msg = {};
@@ -241,38 +361,51 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         
         accumulatedTime += dt;
         
-        while (accumulatedTime >= fixedTimeStep) {
-            if (cloth) {
-                cloth->Update(fixedTimeStep);
-                
-                // Add gentle wind force
-                static float windTime = 0.0f;
-                windTime += fixedTimeStep;
-                float windForce = 5.0f * sinf(windTime * 2.0f);
-                cloth->AddForce(windForce, 0.0f);
-            }
-            accumulatedTime -= fixedTimeStep;
+        // Run every whole step that accumulated in one batch
+        LARGE_INTEGER workStart, drawStart, workEnd;
+        QueryPerformanceCounter(&workStart);
+        int steps = (int)(accumulatedTime / fixedTimeStep);
+        if (steps > 0) {
+            scene.Step(steps, fixedTimeStep);
+            accumulatedTime -= steps * fixedTimeStep;
         }
         
         // Interpolate with remaining time
         float alpha = accumulatedTime / fixedTimeStep;
         if (cloth) {
-            cloth->Update(0.0f, alpha); // Update interpolated positions without physics
-            InvalidateRect(hwnd, NULL, FALSE);
+            // Invalidate only the tiles the cloths moved through
+            for (int i = 0; i < scene.GetCount(); i++) {
+                scene.Get(i)->Update(0.0f, alpha); // Update interpolated positions without physics
+                scene.Get(i)->MarkDirtyTiles(dirtyTiles);
+            }
+            dirtyTiles.GetDirtyRects(dirtyRects);
+            for (const auto& dirty : dirtyRects) {
+                RECT tile = {dirty.left, dirty.top, dirty.right, dirty.bottom};
+                InvalidateRect(hwnd, &tile, FALSE);
+            }
         }
         
         // Update FPS display
         UpdateFPS(hwnd, dt);
         
         // Redraw only when needed
+        QueryPerformanceCounter(&drawStart);
         if (cloth) {
             UpdateWindow(hwnd); // Force immediate redraw
         }
+        QueryPerformanceCounter(&workEnd);
+
+        // Frames that stepped the simulation tell the governor how close to budget it runs
+        if (cloth && autoQuality && steps > 0) {
+            float updateMs = (float)(drawStart.QuadPart - workStart.QuadPart) * 1000.0f / frequency.QuadPart;
+            float drawMs = (float)(workEnd.QuadPart - drawStart.QuadPart) * 1000.0f / frequency.QuadPart;
+            governor.Record(updateMs, drawMs);
+            if (governor.Apply(*cloth)) SyncQualityControls(hwnd);
+        }
         
         // Sleep to prevent excessive CPU usage
         Sleep(1);
     }
     
-    delete cloth;
     return 0;
 }
\ No newline at end of file